@@ -0,0 +1,171 @@
+/*
+ * Early reflection benchmark: multitap, its FFT path and velvet noise
+ *
+ * Builds the engine into this file to reach its static generators, then
+ * times multitap_process, tap_conv_process (spectra built in place of the
+ * worker) and velvet_process on the same seeded pattern over a range of
+ * tap counts. The FFT path's largest deviation from the multitap shows it
+ * matches to rounding, the velvet's impulse energy that the levels match.
+ * Finishes with whole-engine block times for each early_reflections mode
+ * at the default and the largest tap count.
+ *
+ * Usage: gcc -Ofast scripts/bench_early.c -Isrc/dsp -o bench_early -lm -lpthread && ./bench_early
+ */
+
+#include "cloudseed_engine.c"
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_BLOCKS 20000
+#define BENCH_RING 24000            /* Standard tier's multitap ring */
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t g_rng = 1;
+
+static float noise(void) {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (float)(int32_t)g_rng * (1.0f / 2147483648.0f);
+}
+
+/* Energy of the first 40 blocks after a unit impulse */
+static double impulse_energy(multitap_delay_t *mt, const velvet_taps_t *v) {
+    float in[BUFFER_SIZE], out[BUFFER_SIZE];
+    double energy = 0.0;
+
+    multitap_clear(mt);
+    for (int b = 0; b < 40; b++) {
+        memset(in, 0, sizeof(in));
+        in[0] = b == 0 ? 1.0f : 0.0f;
+        if (v)
+            velvet_process(v, mt, in, out, BUFFER_SIZE);
+        else
+            multitap_process(mt, in, out, BUFFER_SIZE);
+        for (int i = 0; i < BUFFER_SIZE; i++)
+            energy += out[i] * out[i];
+    }
+    return energy;
+}
+
+static void run_block(multitap_delay_t *mt, const velvet_taps_t *v, tap_conv_t *c,
+                      float *in, float *out) {
+    if (v)
+        velvet_process(v, mt, in, out, BUFFER_SIZE);
+    else if (c)
+        tap_conv_process(c, mt, in, out, BUFFER_SIZE);
+    else
+        multitap_process(mt, in, out, BUFFER_SIZE);
+}
+
+/* Nanoseconds per 128-sample block on noise */
+static double time_blocks(multitap_delay_t *mt, const velvet_taps_t *v, tap_conv_t *c) {
+    float in[BUFFER_SIZE], out[BUFFER_SIZE];
+    for (int i = 0; i < BUFFER_SIZE; i++)
+        in[i] = noise() * 0.25f;
+
+    double start = now_s();
+    for (int b = 0; b < BENCH_BLOCKS; b++) {
+        in[b % BUFFER_SIZE] = noise() * 0.25f;
+        run_block(mt, v, c, in, out);
+    }
+    return (now_s() - start) * 1e9 / BENCH_BLOCKS;
+}
+
+/* Largest difference between the FFT path and the multitap on the same noise, once it has taken over */
+static double conv_error(multitap_delay_t *mt, multitap_delay_t *ref, tap_conv_t *c) {
+    float in[BUFFER_SIZE], out[BUFFER_SIZE], expect[BUFFER_SIZE];
+    double error = 0.0;
+
+    multitap_clear(mt);
+    multitap_clear(ref);
+    tap_conv_init(c, NULL);
+    for (int b = 0; b < 400; b++) {
+        for (int i = 0; i < BUFFER_SIZE; i++)
+            in[i] = noise() * 0.25f;
+        multitap_process(ref, in, expect, BUFFER_SIZE);
+        tap_conv_process(c, mt, in, out, BUFFER_SIZE);
+        tap_conv_build(c);
+        for (int i = 0; i < BUFFER_SIZE && b >= 200; i++)
+            error = fmax(error, fabs(out[i] - expect[i]));
+    }
+    return error;
+}
+
+static void bench_generators(void) {
+    static const int tap_counts[] = { 16, 32, 48, 64, 128, 256 };
+    engine_allocator_t alloc;
+    multitap_delay_t mt, ref;
+    velvet_taps_t v;
+    tap_conv_t *c = (tap_conv_t*)malloc(sizeof(tap_conv_t));
+    if (!c)
+        return;
+
+    memset(&alloc, 0, sizeof(alloc));
+    printf("taps  multitap ns/blk  fft ns/blk  fft error  velvet ns/blk  velvet level\n");
+    for (size_t i = 0; i < sizeof(tap_counts) / sizeof(tap_counts[0]); i++) {
+        multitap_delay_t *both[2] = { &mt, &ref };
+        for (int m = 0; m < 2; m++) {
+            multitap_init(both[m], BENCH_RING, &alloc);
+            multitap_set_cross_seed(both[m], 0.25f);
+            multitap_set_tap_count(both[m], tap_counts[i]);
+            multitap_set_tap_length(both[m], EARLY_TAP_LENGTH_MS * SAMPLE_RATE / 1000);
+        }
+        velvet_build(&v, &mt);
+
+        double error = conv_error(&mt, &ref, c);
+        double multitap_energy = impulse_energy(&mt, NULL);
+        double velvet_energy = impulse_energy(&mt, &v);
+        double multitap_ns = time_blocks(&mt, NULL, NULL);
+        double velvet_ns = time_blocks(&mt, &v, NULL);
+        double conv_ns = time_blocks(&mt, NULL, c);
+
+        printf("%4d  %15.0f  %10.0f  %9.1e  %13.0f  %+9.2f dB\n", tap_counts[i], multitap_ns,
+               conv_ns, error, velvet_ns, 10.0 * log10(velvet_energy / multitap_energy));
+        multitap_free(&mt, &alloc);
+        multitap_free(&ref, &alloc);
+    }
+    free(c);
+}
+
+static void bench_engine(void) {
+    static const char *names[] = { "off", "multitap", "velvet" };
+    static const int tap_counts[] = { EARLY_TAP_COUNT, MAX_TAPS };
+    int16_t audio[BUFFER_SIZE * 2];
+
+    printf("\nengine (block layout)  us/blk  %d taps  %d taps\n", tap_counts[0], tap_counts[1]);
+    for (int mode = EARLY_OFF; mode <= EARLY_VELVET; mode++) {
+        printf("%-8s                     ", names[mode]);
+        for (int t = 0; t < 2; t++) {
+            cloudseed_engine_t *e = cloudseed_engine_create(NULL);
+            if (!e) {
+                fprintf(stderr, "engine create failed\n");
+                return;
+            }
+            cloudseed_engine_set_line_layout(e, CLOUDSEED_LAYOUT_BLOCK);
+            cloudseed_engine_set_early_mode(e, mode);
+            cloudseed_engine_set_early_taps(e, tap_counts[t]);
+
+            double start = now_s();
+            for (int b = 0; b < BENCH_BLOCKS / 4; b++) {
+                for (int i = 0; i < BUFFER_SIZE * 2; i++)
+                    audio[i] = (int16_t)(noise() * 8000.0f);
+                cloudseed_engine_process(e, audio, BUFFER_SIZE);
+            }
+            printf("  %7.2f", (now_s() - start) * 1e6 / (BENCH_BLOCKS / 4));
+            cloudseed_engine_destroy(e);
+        }
+        printf("\n");
+    }
+}
+
+int main(void) {
+    cloudseed_engine_global_init();     /* FFT tables */
+    bench_generators();
+    bench_engine();
+    return 0;
+}
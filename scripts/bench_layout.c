@@ -0,0 +1,84 @@
+/*
+ * Line layout benchmark: block vs sample order per block size
+ *
+ * Offline replacement for the plugin's old default AUTO calibration. Times
+ * both line layouts on seeded noise at each block-size bucket and line
+ * count and prints the faster one, so the shipped default can be chosen
+ * from a quiet run on the target rather than from whatever load the
+ * device had while the plugin was timing itself.
+ *
+ * Usage: gcc -Ofast scripts/bench_layout.c src/dsp/cloudseed_engine.c -Isrc/dsp -o bench_layout -lm -lpthread && ./bench_layout
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "cloudseed_engine.h"
+
+#define BENCH_FRAMES 960000         /* 20 s at 48 kHz per measurement */
+#define BENCH_ROUNDS 5              /* Best of, per layout */
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t g_rng = 1;
+
+static int16_t noise(void) {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (int16_t)((int32_t)g_rng >> 19);
+}
+
+/* Best per-block time in microseconds, -1 if the engine could not be created */
+static double time_layout(int layout, int frames, int lines) {
+    int16_t audio[128 * 2];
+    double best = -1.0;
+
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        cloudseed_engine_t *e = cloudseed_engine_create(NULL);
+        if (!e)
+            return -1.0;
+        cloudseed_engine_set_line_layout(e, layout);
+        cloudseed_engine_set_line_count(e, lines);
+
+        g_rng = 1;
+        int blocks = BENCH_FRAMES / frames;
+        double start = now_s();
+        for (int b = 0; b < blocks; b++) {
+            for (int i = 0; i < frames * 2; i++)
+                audio[i] = noise();
+            cloudseed_engine_process(e, audio, frames);
+        }
+        double us = (now_s() - start) * 1e6 / blocks;
+        if (best < 0.0 || us < best)
+            best = us;
+        cloudseed_engine_destroy(e);
+    }
+    return best;
+}
+
+int main(void) {
+    static const int frame_counts[CLOUDSEED_LAYOUT_BUCKETS] = { 32, 64, 128 };
+    static const int line_counts[] = { 4, CLOUDSEED_DEFAULT_LINES, CLOUDSEED_MAX_LINES };
+
+    cloudseed_engine_global_init();
+
+    printf("frames  lines   block us  sample us  faster\n");
+    for (int f = 0; f < CLOUDSEED_LAYOUT_BUCKETS; f++) {
+        for (int l = 0; l < (int)(sizeof(line_counts) / sizeof(line_counts[0])); l++) {
+            double block = time_layout(CLOUDSEED_LAYOUT_BLOCK, frame_counts[f], line_counts[l]);
+            double sample = time_layout(CLOUDSEED_LAYOUT_SAMPLE, frame_counts[f], line_counts[l]);
+            if (block < 0.0 || sample < 0.0) {
+                fprintf(stderr, "engine create failed\n");
+                return 1;
+            }
+            printf("%6d  %5d  %9.2f  %9.2f  %s (%.2fx)\n", frame_counts[f], line_counts[l],
+                   block, sample, sample < block ? "sample" : "block",
+                   sample < block ? block / sample : sample / block);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+# Render benchmark for the software prefetch in channel_process
+#
+# Builds cloudseed.so with and without -DCLOUDSEED_NO_PREFETCH, times both
+# on the scripts/pgo_render.c workload and reports the speedup. When perf
+# is available it also counts cache misses for each build. Run it natively
+# on the target (the Move, or an arm64 host) for numbers that matter; on
+# other hosts it shows whether the hints help that CPU's prefetchers.
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+REPO_ROOT="$(dirname "$SCRIPT_DIR")"
+CC="${CC:-gcc}"
+REPEAT="${REPEAT:-5}"
+
+cd "$REPO_ROOT"
+
+BENCH_DIR="$REPO_ROOT/build/bench_prefetch"
+
+CFLAGS="-Ofast -fPIC -fomit-frame-pointer -fno-stack-protector -DNDEBUG -Isrc/dsp"
+case "$($CC -dumpmachine)" in
+    aarch64*) CFLAGS="$CFLAGS -march=armv8-a -mtune=cortex-a72" ;;
+esac
+
+build_so() {
+    local out="$1"; shift
+    $CC $CFLAGS "$@" -c src/dsp/cloudseed_engine.c -o "$BENCH_DIR/cloudseed_engine.o"
+    $CC $CFLAGS "$@" -c src/dsp/cloudseed.c -o "$BENCH_DIR/cloudseed.o"
+    $CC -shared "$BENCH_DIR/cloudseed.o" "$BENCH_DIR/cloudseed_engine.o" -o "$out" -lm -lpthread
+}
+
+echo "=== CloudSeed Prefetch Benchmark ==="
+echo "Compiler: $CC ($($CC -dumpmachine))"
+
+rm -rf "$BENCH_DIR"
+mkdir -p "$BENCH_DIR"
+
+$CC -O2 scripts/pgo_render.c -Isrc/dsp -o "$BENCH_DIR/pgo_render" -ldl -lm
+build_so "$BENCH_DIR/cloudseed-prefetch.so"
+build_so "$BENCH_DIR/cloudseed-noprefetch.so" -DCLOUDSEED_NO_PREFETCH
+
+echo ""
+echo "--- prefetch off (best of $REPEAT) ---"
+"$BENCH_DIR/pgo_render" "$BENCH_DIR/cloudseed-noprefetch.so" "$REPEAT" | tee "$BENCH_DIR/off.txt"
+echo "--- prefetch on (best of $REPEAT) ---"
+"$BENCH_DIR/pgo_render" "$BENCH_DIR/cloudseed-prefetch.so" "$REPEAT" | tee "$BENCH_DIR/on.txt"
+
+off_ms=$(awk '/^total/ { print $2 }' "$BENCH_DIR/off.txt")
+on_ms=$(awk '/^total/ { print $2 }' "$BENCH_DIR/on.txt")
+echo ""
+awk -v a="$off_ms" -v b="$on_ms" 'BEGIN { printf "Speedup: %.3fx (%.2f ms -> %.2f ms)\n", a / b, a, b }'
+
+if command -v perf > /dev/null 2>&1; then
+    for variant in noprefetch prefetch; do
+        echo ""
+        echo "--- perf: $variant ---"
+        perf stat -e cycles,instructions,cache-references,cache-misses \
+            "$BENCH_DIR/pgo_render" "$BENCH_DIR/cloudseed-$variant.so" 1 2>&1 > /dev/null | \
+            grep -E "cycles|instructions|cache" || echo "(counters unavailable)"
+    done
+fi
@@ -3,6 +3,9 @@
 #
 # Automatically uses Docker for cross-compilation if needed.
 # Set CROSS_PREFIX to skip Docker (e.g., for native ARM builds).
+# Set SKIP_COMPILE=1 to package an existing build/cloudseed.so
+# (e.g. one produced by ./scripts/build_pgo.sh on the device).
+# Set HOST_CC for the native compiler of the fast-math check (default gcc).
 set -e
 
 SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
@@ -10,7 +13,7 @@ REPO_ROOT="$(dirname "$SCRIPT_DIR")"
 IMAGE_NAME="schwung-builder"
 
 # Check if we need Docker
-if [ -z "$CROSS_PREFIX" ] && [ ! -f "/.dockerenv" ]; then
+if [ -z "$CROSS_PREFIX" ] && [ -z "$SKIP_COMPILE" ] && [ ! -f "/.dockerenv" ]; then
     echo "=== CloudSeed Module Build (via Docker) ==="
     echo ""
 
@@ -48,20 +51,41 @@ mkdir -p build
 mkdir -p dist/cloudseed
 
 # Compile DSP plugin (with aggressive optimizations for CM4)
-echo "Compiling DSP plugin..."
-${CROSS_PREFIX}gcc -Ofast -shared -fPIC \
-    -march=armv8-a -mtune=cortex-a72 \
-    -fomit-frame-pointer -fno-stack-protector \
-    -DNDEBUG \
-    src/dsp/cloudseed.c \
-    -o build/cloudseed.so \
-    -Isrc/dsp \
-    -lm
+if [ -n "$SKIP_COMPILE" ]; then
+    if [ ! -f build/cloudseed.so ]; then
+        echo "SKIP_COMPILE set but build/cloudseed.so does not exist"
+        exit 1
+    fi
+    echo "Using existing build/cloudseed.so"
+else
+    CFLAGS="-Ofast -fPIC -march=armv8-a -mtune=cortex-a72 -fomit-frame-pointer -fno-stack-protector -DNDEBUG"
+
+    # Fast-math error bounds, checked natively with the same optimization level
+    echo "Checking fast-math accuracy..."
+    ${HOST_CC:-gcc} -Ofast -DNDEBUG scripts/fast_math_check.c -Isrc/dsp -o build/fast_math_check -lm
+    ./build/fast_math_check
+
+    echo "Compiling engine library..."
+    ${CROSS_PREFIX}gcc $CFLAGS \
+        -c src/dsp/cloudseed_engine.c \
+        -o build/cloudseed_engine.o \
+        -Isrc/dsp
+    ${CROSS_PREFIX}ar rcs build/libcloudseed_engine.a build/cloudseed_engine.o
+
+    echo "Compiling DSP plugin..."
+    ${CROSS_PREFIX}gcc $CFLAGS -shared \
+        src/dsp/cloudseed.c \
+        -o build/cloudseed.so \
+        -Isrc/dsp \
+        -Lbuild -lcloudseed_engine \
+        -lm -lpthread
+fi
 
 # Copy files to dist (use cat to avoid ExtFS deallocation issues with Docker)
 echo "Packaging..."
 cat src/module.json > dist/cloudseed/module.json
 [ -f src/help.json ] && cat src/help.json > dist/cloudseed/help.json
+[ -f src/presets.json ] && cat src/presets.json > dist/cloudseed/presets.json
 cat build/cloudseed.so > dist/cloudseed/cloudseed.so
 chmod +x dist/cloudseed/cloudseed.so
 
@@ -0,0 +1,75 @@
+#!/usr/bin/env bash
+# Profile-guided build of the CloudSeed DSP plugin
+#
+# 1. Builds an instrumented cloudseed.so with the native compiler
+# 2. Trains it with scripts/pgo_render.c (presets, bursts, sweeps, idle)
+# 3. Rebuilds build/cloudseed.so with the collected profile
+# 4. Times the plain -Ofast build against the PGO build on the same workload
+#
+# The profile must come from the CPU the plugin ships on, so run this
+# natively on an aarch64 host (the Move itself, or an arm64 machine with
+# the repo checked out). On other hosts it still works and tunes for the
+# host CPU, which is useful for comparing code layouts but not for release.
+# Package the result with: SKIP_COMPILE=1 ./scripts/build.sh
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+REPO_ROOT="$(dirname "$SCRIPT_DIR")"
+CC="${CC:-gcc}"
+REPEAT="${REPEAT:-3}"
+
+cd "$REPO_ROOT"
+
+PGO_DIR="$REPO_ROOT/build/pgo"
+PROFILE_DIR="$PGO_DIR/profile"
+
+CFLAGS="-Ofast -fPIC -fomit-frame-pointer -fno-stack-protector -DNDEBUG -Isrc/dsp"
+case "$($CC -dumpmachine)" in
+    aarch64*) CFLAGS="$CFLAGS -march=armv8-a -mtune=cortex-a72" ;;
+esac
+
+# Same object paths in every stage so the .gcda names line up
+build_so() {
+    local out="$1"; shift
+    $CC $CFLAGS "$@" -c src/dsp/cloudseed_engine.c -o "$PGO_DIR/cloudseed_engine.o"
+    $CC $CFLAGS "$@" -c src/dsp/cloudseed.c -o "$PGO_DIR/cloudseed.o"
+    $CC -shared "$@" "$PGO_DIR/cloudseed.o" "$PGO_DIR/cloudseed_engine.o" -o "$out" -lm -lpthread
+}
+
+echo "=== CloudSeed PGO Build ==="
+echo "Compiler: $CC ($($CC -dumpmachine))"
+
+rm -rf "$PGO_DIR"
+mkdir -p "$PROFILE_DIR"
+
+echo "Building render workload..."
+$CC -O2 scripts/pgo_render.c -Isrc/dsp -o "$PGO_DIR/pgo_render" -ldl -lm
+
+echo "Building plain -Ofast plugin..."
+build_so "$PGO_DIR/cloudseed-plain.so"
+
+echo "Building instrumented plugin..."
+build_so "$PGO_DIR/cloudseed-instr.so" -fprofile-generate="$PROFILE_DIR" -fprofile-update=single
+
+echo "Training..."
+"$PGO_DIR/pgo_render" "$PGO_DIR/cloudseed-instr.so" > /dev/null
+
+echo "Building PGO plugin..."
+mkdir -p build
+build_so "$PGO_DIR/cloudseed-pgo.so" -fprofile-use="$PROFILE_DIR" -fprofile-partial-training -Wno-missing-profile
+cat "$PGO_DIR/cloudseed-pgo.so" > build/cloudseed.so
+
+echo ""
+echo "--- plain -Ofast (best of $REPEAT) ---"
+"$PGO_DIR/pgo_render" "$PGO_DIR/cloudseed-plain.so" "$REPEAT" | tee "$PGO_DIR/plain.txt"
+echo "--- PGO (best of $REPEAT) ---"
+"$PGO_DIR/pgo_render" "$PGO_DIR/cloudseed-pgo.so" "$REPEAT" | tee "$PGO_DIR/pgo.txt"
+
+plain_ms=$(awk '/^total/ { print $2 }' "$PGO_DIR/plain.txt")
+pgo_ms=$(awk '/^total/ { print $2 }' "$PGO_DIR/pgo.txt")
+echo ""
+awk -v a="$plain_ms" -v b="$pgo_ms" 'BEGIN { printf "Speedup: %.3fx (%.2f ms -> %.2f ms)\n", a / b, a, b }'
+
+echo ""
+echo "=== PGO Build Complete ==="
+echo "Output: build/cloudseed.so"
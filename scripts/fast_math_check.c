@@ -0,0 +1,93 @@
+/*
+ * Accuracy check of src/dsp/fast_math.h against libm
+ *
+ * Sweeps every approximation over the range its header comment documents,
+ * comparing with the double-precision libm result for the same float
+ * input, and fails if the worst error exceeds the documented bound. Build
+ * with the plugin's optimization flags, since -Ofast may contract or
+ * reorder the polynomials. Run by build.sh before compiling the plugin.
+ *
+ * Usage: gcc -Ofast scripts/fast_math_check.c -Isrc/dsp -o fast_math_check -lm && ./fast_math_check
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "fast_math.h"
+
+#define SWEEP_POINTS 4000000
+
+typedef struct {
+    const char *name;
+    float (*fast)(float);
+    double (*exact)(double);
+    double lo, hi;              /* Documented input range */
+    double bound;
+    int relative;               /* Bound is relative to the exact result, else absolute */
+} math_case_t;
+
+static double exact_exp2(double x) { return exp2(x); }
+static double exact_log2(double x) { return log2(x); }
+static double exact_sin2pi(double x) { return sin(2.0 * M_PI * x); }
+static double exact_tan(double x) { return tan(x); }
+static double exact_exp(double x) { return exp(x); }
+static double exact_exp10(double x) { return pow(10.0, x); }
+static double exact_db2gain(double x) { return pow(10.0, x / 20.0); }
+
+static float call_exp2f(float x) { return fast_exp2f(x); }
+static float call_log2f(float x) { return fast_log2f(x); }
+static float call_sin2pi(float x) { return fast_sin2pi(x); }
+static float call_tanf(float x) { return fast_tanf(x); }
+static float call_expf(float x) { return fast_expf(x); }
+static float call_exp10f(float x) { return fast_exp10f(x); }
+static float call_db2gain(float x) { return fast_db2gain(x); }
+
+/* The header's tables */
+static const math_case_t g_cases[] = {
+    { "fast_exp2f",   call_exp2f,   exact_exp2,    -126.0, 127.0,        2e-7, 1 },
+    { "fast_log2f",   call_log2f,   exact_log2,    0.25,   4.0,          2e-7, 0 },
+    { "fast_sin2pi",  call_sin2pi,  exact_sin2pi,  -64.0,  64.0,         3e-7, 0 },
+    { "fast_tanf",    call_tanf,    exact_tan,     0.0,    0.49 * M_PI,  1e-5, 1 },
+    { "fast_expf",    call_expf,    exact_exp,     -16.0,  16.0,         2e-6, 1 },
+    { "fast_exp10f",  call_exp10f,  exact_exp10,   -1.0,   3.0,          1e-6, 1 },
+    { "fast_db2gain", call_db2gain, exact_db2gain, -120.0, 24.0,         1e-6, 1 },
+};
+
+#define CASE_COUNT ((int)(sizeof(g_cases) / sizeof(g_cases[0])))
+
+/* Worst error over an even sweep of the range; worst_x gets the input it was seen at */
+static double sweep(const math_case_t *c, double *worst_x) {
+    double worst = 0.0;
+    *worst_x = c->lo;
+    for (int i = 0; i <= SWEEP_POINTS; i++) {
+        float x = (float)(c->lo + (c->hi - c->lo) * i / SWEEP_POINTS);
+        double exact = c->exact((double)x);
+        double error = fabs((double)c->fast(x) - exact);
+        if (c->relative)
+            error = exact != 0.0 ? error / fabs(exact) : 0.0;
+        if (error > worst) {
+            worst = error;
+            *worst_x = x;
+        }
+    }
+    return worst;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("function      range               worst error  bound     at\n");
+    for (int i = 0; i < CASE_COUNT; i++) {
+        const math_case_t *c = &g_cases[i];
+        double worst_x;
+        double worst = sweep(c, &worst_x);
+        int ok = worst < c->bound;
+
+        printf("%-12s  [%7.2f, %7.2f]  %.2e %s  %.0e %s  %g\n", c->name, c->lo, c->hi,
+               worst, c->relative ? "rel" : "abs", c->bound, ok ? "ok  " : "FAIL", worst_x);
+        failures += !ok;
+    }
+
+    printf("fast-math check: %d function%s over bound\n", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
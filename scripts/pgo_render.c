@@ -0,0 +1,180 @@
+/*
+ * Offline render workload for profile-guided builds
+ *
+ * Loads a built cloudseed.so through the v2 FX ABI and renders a fixed
+ * set of presets and signals (bursts, sustained noise, tones, silence,
+ * knob sweeps, several block sizes). Used by build_pgo.sh both to train
+ * the instrumented build and to time the plain and PGO builds.
+ *
+ * Usage: pgo_render <path/to/cloudseed.so> [repeat]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <dlfcn.h>
+
+#include "plugin_api_v1.h"
+
+#define SAMPLE_RATE 48000
+#define MAX_FRAMES 256
+
+/* Mirrors the v2 table exported by move_audio_fx_init_v2 */
+typedef struct {
+    uint32_t api_version;
+    void* (*create_instance)(const char *module_dir, const char *config_json);
+    void (*destroy_instance)(void *instance);
+    void (*process_block)(void *instance, int16_t *audio_inout, int frames);
+    void (*set_param)(void *instance, const char *key, const char *val);
+    int (*get_param)(void *instance, const char *key, char *buf, int buf_len);
+} fx_api_v2_t;
+
+typedef fx_api_v2_t* (*fx_init_v2_fn)(const host_api_v1_t *host);
+
+typedef enum {
+    SIGNAL_BURST,       /* 100ms noise, then ring-out into silence */
+    SIGNAL_NOISE,       /* Sustained noise, engine never idles */
+    SIGNAL_TONES,       /* Sparse decaying tones, partly silent */
+    SIGNAL_SILENCE      /* Idle input, exercises the bypass paths */
+} signal_t;
+
+typedef struct {
+    const char *name;
+    const char *params;     /* "key=val key=val ..." */
+    signal_t signal;
+    int frames;             /* Block size */
+    float seconds;
+    const char *sweep_key;  /* Knob swept 0..1 across the render, or NULL */
+} workload_t;
+
+static const workload_t g_workloads[] = {
+    { "hall-burst",   "decay=0.70 size=0.70 diffusion=0.80 mix=0.35", SIGNAL_BURST, 128, 6.0f, NULL },
+    { "room-noise",   "decay=0.30 size=0.30 diffusion=0.60 mix=0.50", SIGNAL_NOISE, 128, 3.0f, NULL },
+    { "plate-tones",  "decay=0.55 size=0.45 diffusion=0.95 mod_amount=0.60 mix=0.40", SIGNAL_TONES, 64, 4.0f, NULL },
+    { "send-wet",     "decay=0.85 size=0.90 predelay=0.40 mix=1.00", SIGNAL_BURST, 128, 6.0f, NULL },
+    { "short-blocks", "decay=0.50 size=0.50 mix=0.30", SIGNAL_NOISE, 32, 2.0f, NULL },
+    { "size-sweep",   "decay=0.60 mix=0.50", SIGNAL_NOISE, 128, 3.0f, "size" },
+    { "mod-sweep",    "decay=0.60 mod_rate=0.50 mix=0.50", SIGNAL_TONES, 128, 3.0f, "mod_amount" },
+    { "idle-dry",     "mix=0.00", SIGNAL_SILENCE, 128, 2.0f, NULL },
+    { "idle-wet",     "decay=0.80 mix=0.50", SIGNAL_SILENCE, 128, 2.0f, NULL },
+};
+
+#define WORKLOAD_COUNT ((int)(sizeof(g_workloads) / sizeof(g_workloads[0])))
+
+static uint32_t g_rng = 1;
+
+static float noise(void) {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (float)(int32_t)g_rng / 2147483648.0f;
+}
+
+static void apply_params(fx_api_v2_t *fx, void *inst, const char *params) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", params);
+    for (char *tok = strtok(buf, " "); tok; tok = strtok(NULL, " ")) {
+        char *eq = strchr(tok, '=');
+        if (!eq) continue;
+        *eq = '\0';
+        fx->set_param(inst, tok, eq + 1);
+    }
+}
+
+static float signal_sample(signal_t signal, long n) {
+    float t = (float)n / SAMPLE_RATE;
+    switch (signal) {
+        case SIGNAL_BURST:
+            return n < SAMPLE_RATE / 10 ? 0.3f * noise() : 0.0f;
+        case SIGNAL_NOISE:
+            return 0.2f * noise();
+        case SIGNAL_TONES: {
+            float local = fmodf(t, 0.75f);
+            if (local > 0.4f) return 0.0f;
+            float freq = 220.0f * (1.0f + (float)((n / (SAMPLE_RATE * 3 / 4)) % 4));
+            return 0.4f * expf(-6.0f * local) * sinf(2.0f * (float)M_PI * freq * t);
+        }
+        case SIGNAL_SILENCE:
+        default:
+            return 0.0f;
+    }
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double run_workload(fx_api_v2_t *fx, const workload_t *w) {
+    void *inst = fx->create_instance(".", NULL);
+    if (!inst) return -1.0;
+    apply_params(fx, inst, w->params);
+
+    int16_t audio[MAX_FRAMES * 2];
+    long total = (long)(w->seconds * SAMPLE_RATE);
+    int blocks = (int)(total / w->frames);
+    double busy = 0.0;
+    long n = 0;
+    g_rng = 1;
+
+    for (int b = 0; b < blocks; b++) {
+        if (w->sweep_key && b % 16 == 0) {
+            char val[16];
+            snprintf(val, sizeof(val), "%.3f", (float)b / (float)blocks);
+            fx->set_param(inst, w->sweep_key, val);
+        }
+        for (int i = 0; i < w->frames; i++, n++) {
+            float s = signal_sample(w->signal, n);
+            audio[i * 2] = (int16_t)(s * 32767.0f);
+            audio[i * 2 + 1] = (int16_t)(s * 0.8f * 32767.0f);
+        }
+        double start = now_seconds();
+        fx->process_block(inst, audio, w->frames);
+        busy += now_seconds() - start;
+    }
+
+    fx->destroy_instance(inst);
+    return busy;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <cloudseed.so> [repeat]\n", argv[0]);
+        return 1;
+    }
+    int repeat = argc > 2 ? atoi(argv[2]) : 1;
+    if (repeat < 1) repeat = 1;
+
+    void *lib = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+    if (!lib) {
+        fprintf(stderr, "dlopen failed: %s\n", dlerror());
+        return 1;
+    }
+    fx_init_v2_fn init = (fx_init_v2_fn)dlsym(lib, "move_audio_fx_init_v2");
+    if (!init) {
+        fprintf(stderr, "move_audio_fx_init_v2 not found\n");
+        return 1;
+    }
+
+    host_api_v1_t host;
+    memset(&host, 0, sizeof(host));
+    fx_api_v2_t *fx = init(&host);
+
+    /* Best of N per workload keeps scheduler noise out of the comparison */
+    double total = 0.0;
+    for (int i = 0; i < WORKLOAD_COUNT; i++) {
+        double best = -1.0;
+        for (int r = 0; r < repeat; r++) {
+            double t = run_workload(fx, &g_workloads[i]);
+            if (best < 0.0 || t < best) best = t;
+        }
+        printf("%-14s %8.2f ms\n", g_workloads[i].name, best * 1000.0);
+        total += best;
+    }
+    printf("%-14s %8.2f ms\n", "total", total * 1000.0);
+
+    dlclose(lib);
+    return 0;
+}
@@ -0,0 +1,223 @@
+/*
+ * Real-time safety audit driver
+ *
+ * Loads cloudseed.so through the v2 FX ABI and drives process_block plus
+ * the set_param/get_param calls a host may issue from the audio thread,
+ * all inside an audited region. Run under rt_audit_shim.so (see
+ * rt_audit.sh); any allocation, lock, sleep or I/O in those calls is
+ * reported with a backtrace and the run exits nonzero.
+ *
+ * Usage: LD_PRELOAD=rt_audit_shim.so rt_audit <path/to/cloudseed.so>
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <dlfcn.h>
+#include <unistd.h>
+
+#include "plugin_api_v1.h"
+
+#define SAMPLE_RATE 48000
+#define MAX_FRAMES 256
+
+/* Mirrors the v2 table exported by move_audio_fx_init_v2 */
+typedef struct {
+    uint32_t api_version;
+    void* (*create_instance)(const char *module_dir, const char *config_json);
+    void (*destroy_instance)(void *instance);
+    void (*process_block)(void *instance, int16_t *audio_inout, int frames);
+    void (*set_param)(void *instance, const char *key, const char *val);
+    int (*get_param)(void *instance, const char *key, char *buf, int buf_len);
+} fx_api_v2_t;
+
+typedef fx_api_v2_t* (*fx_init_v2_fn)(const host_api_v1_t *host);
+
+/* Knobs and actions a host may send between blocks on the audio thread */
+static const char *g_knobs[] = {
+    "decay", "mix", "predelay", "size", "diffusion", "low_cut",
+    "high_cut", "cross_seed", "mod_rate", "mod_amount", "early_late",
+};
+
+static const char *g_reads[] = {
+    "decay", "mix", "state", "line_layout", "tail_samples", "is_silent",
+    "clear_tail", "cpu_variant", "memory_profile", "memory_tier", "line_count",
+    "preset", "presets", "morph", "early_reflections", "early_taps",
+};
+
+#define KNOB_COUNT ((int)(sizeof(g_knobs) / sizeof(g_knobs[0])))
+#define READ_COUNT ((int)(sizeof(g_reads) / sizeof(g_reads[0])))
+
+static void (*audit_enter)(void);
+static void (*audit_leave)(void);
+static int (*audit_violations)(void);
+
+static uint32_t g_rng = 1;
+
+static int16_t noise(void) {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (int16_t)((int32_t)g_rng >> 18);
+}
+
+static void render(fx_api_v2_t *fx, void *inst, int frames, int blocks, int with_input) {
+    int16_t audio[MAX_FRAMES * 2];
+    char value[16];
+    char out[1024];
+
+    for (int b = 0; b < blocks; b++) {
+        for (int i = 0; i < frames * 2; i++)
+            audio[i] = with_input ? noise() : 0;
+
+        audit_enter();
+        if (b % 8 == 0) {
+            const char *knob = g_knobs[(b / 8) % KNOB_COUNT];
+            snprintf(value, sizeof(value), "%.2f", (float)(b % 101) / 100.0f);
+            fx->set_param(inst, knob, value);
+        }
+        if (b % 50 == 25)
+            fx->get_param(inst, g_reads[(b / 50) % READ_COUNT], out, sizeof(out));
+        fx->process_block(inst, audio, frames);
+        audit_leave();
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <cloudseed.so>\n", argv[0]);
+        return 2;
+    }
+
+    audit_enter = (void (*)(void))dlsym(RTLD_DEFAULT, "rt_audit_enter");
+    audit_leave = (void (*)(void))dlsym(RTLD_DEFAULT, "rt_audit_leave");
+    audit_violations = (int (*)(void))dlsym(RTLD_DEFAULT, "rt_audit_violations");
+    if (!audit_enter || !audit_leave || !audit_violations) {
+        fprintf(stderr, "rt_audit_shim.so is not preloaded\n");
+        return 2;
+    }
+
+    void *lib = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+    if (!lib) {
+        fprintf(stderr, "dlopen failed: %s\n", dlerror());
+        return 2;
+    }
+    fx_init_v2_fn init = (fx_init_v2_fn)dlsym(lib, "move_audio_fx_init_v2");
+    if (!init) {
+        fprintf(stderr, "move_audio_fx_init_v2 not found\n");
+        return 2;
+    }
+
+    host_api_v1_t host;
+    memset(&host, 0, sizeof(host));
+    fx_api_v2_t *fx = init(&host);
+
+    /* Creation and teardown may allocate; only the audio-thread calls are audited. src holds presets.json */
+    void *inst = fx->create_instance("src", NULL);
+    if (!inst) {
+        fprintf(stderr, "create_instance failed\n");
+        return 2;
+    }
+
+    int block_sizes[] = { 128, 64, 32, 256 };
+    for (int i = 0; i < 4; i++) {
+        render(fx, inst, block_sizes[i], SAMPLE_RATE / block_sizes[i], 1);
+        render(fx, inst, block_sizes[i], SAMPLE_RATE / block_sizes[i], 0);
+    }
+
+    audit_enter();
+    fx->set_param(inst, "state",
+                  "{\"decay\":0.8,\"mix\":0.5,\"size\":0.3,\"early_late\":0.4,\"mod_update_rate\":16}");
+    fx->set_param(inst, "mod_update_rate", "1");
+    fx->set_param(inst, "line_layout", "sample");
+    fx->set_param(inst, "clear_tail", "1");
+    audit_leave();
+    render(fx, inst, 128, 200, 1);
+
+    /*
+     * Early reflection generators share the multitap ring; switching clears it
+     * once. From 64 taps the multitap is an FFT convolution, spectra built on the worker
+     */
+    const char *early[] = { "multitap", "multitap", "velvet", "off" };
+    const char *early_taps[] = { "256", "32", "64", "128" };
+    for (int i = 0; i < 4; i++) {
+        audit_enter();
+        fx->set_param(inst, "early_reflections", early[i]);
+        fx->set_param(inst, "early_taps", early_taps[i]);
+        audit_leave();
+        render(fx, inst, 128, 100, 1);
+    }
+
+    /* Preset recalls copy precomputed coefficients at the next block */
+    const char *presets[] = { "Hall", "Room", "2" };
+    for (int i = 0; i < 3; i++) {
+        audit_enter();
+        fx->set_param(inst, "preset", presets[i]);
+        audit_leave();
+        render(fx, inst, 128, 50, 1);
+    }
+
+    /* Morph steps blend the two sets; the first also installs the from preset's seeds */
+    audit_enter();
+    fx->set_param(inst, "morph_from", "Room");
+    fx->set_param(inst, "morph_to", "Cathedral");
+    audit_leave();
+    for (int i = 0; i <= 10; i++) {
+        char amount[16];
+        snprintf(amount, sizeof(amount), "%.1f", i / 10.0);
+        audit_enter();
+        fx->set_param(inst, "morph", amount);
+        audit_leave();
+        render(fx, inst, 128, 10, 1);
+    }
+
+    /* Topology changes rebuild on the engine's worker; the audio thread only swaps */
+    const char *profiles[] = { "compact", "huge", "standard" };
+    for (int i = 0; i < 3; i++) {
+        audit_enter();
+        fx->set_param(inst, "memory_profile", profiles[i]);
+        audit_leave();
+        render(fx, inst, 128, 200, 1);
+    }
+
+    const char *line_counts[] = { "4", "12", "8" };
+    for (int i = 0; i < 3; i++) {
+        audit_enter();
+        fx->set_param(inst, "rebuild_tail", i == 1 ? "drop" : "keep");
+        fx->set_param(inst, "line_count", line_counts[i]);
+        audit_leave();
+        render(fx, inst, 128, 200, 1);
+    }
+
+    /* Recall into a rebuilt pair, checked against the limits the bank was derived at */
+    audit_enter();
+    fx->set_param(inst, "preset", "Plate");
+    audit_leave();
+    render(fx, inst, 128, 50, 1);
+
+    /* Trace dump marks the ring position; the instance's file worker writes src/trace.bin */
+    audit_enter();
+    fx->set_param(inst, "trace_dump", "1");
+    audit_leave();
+    render(fx, inst, 128, 50, 1);
+
+    /* Snapshot save: the audio thread fills a copy over the next blocks; the file worker writes src/snapshot.bin */
+    audit_enter();
+    fx->set_param(inst, "snapshot_save", "snapshot.bin");
+    audit_leave();
+    for (int i = 0; i < 500 && access("src/snapshot.bin", F_OK) != 0; i++) {
+        render(fx, inst, 128, 4, 1);
+        usleep(2000);
+    }
+    if (access("src/snapshot.bin", F_OK) != 0)
+        fprintf(stderr, "rt-audit: snapshot was not written\n");
+
+    fx->destroy_instance(inst);
+    remove("src/trace.bin");
+    remove("src/snapshot.bin");
+
+    int violations = audit_violations();
+    printf("rt-audit: %d forbidden call%s in the audio path\n",
+           violations, violations == 1 ? "" : "s");
+    return violations ? 1 : 0;
+}
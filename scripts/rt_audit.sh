@@ -0,0 +1,29 @@
+#!/usr/bin/env bash
+# Real-time safety audit of the CloudSeed plugin
+#
+# Builds the plugin natively with symbols, then drives process_block and
+# audio-thread set_param/get_param under an LD_PRELOAD shim that traps
+# malloc/free, mutexes, sleeps and I/O. Each forbidden call is reported
+# with a backtrace and the audit exits nonzero. Needs a native glibc
+# toolchain (run on the device or any Linux host).
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+REPO_ROOT="$(dirname "$SCRIPT_DIR")"
+CC="${CC:-gcc}"
+
+cd "$REPO_ROOT"
+
+AUDIT_DIR="$REPO_ROOT/build/rt_audit"
+mkdir -p "$AUDIT_DIR"
+
+CFLAGS="-Ofast -g -fPIC -fno-omit-frame-pointer -DNDEBUG -Isrc/dsp"
+
+echo "=== CloudSeed RT Safety Audit ==="
+$CC $CFLAGS -c src/dsp/cloudseed_engine.c -o "$AUDIT_DIR/cloudseed_engine.o"
+$CC $CFLAGS -shared src/dsp/cloudseed.c "$AUDIT_DIR/cloudseed_engine.o" -o "$AUDIT_DIR/cloudseed.so" -lm -lpthread
+$CC -O2 -g -fPIC -shared scripts/rt_audit_shim.c -o "$AUDIT_DIR/rt_audit_shim.so" -ldl -lpthread
+$CC -O2 -g -rdynamic scripts/rt_audit.c -Isrc/dsp -o "$AUDIT_DIR/rt_audit" -ldl
+
+# Resolve backtrace addresses with: addr2line -f -e build/rt_audit/cloudseed.so <offset>
+LD_PRELOAD="$AUDIT_DIR/rt_audit_shim.so" "$AUDIT_DIR/rt_audit" "$AUDIT_DIR/cloudseed.so"
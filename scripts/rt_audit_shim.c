@@ -0,0 +1,214 @@
+/*
+ * Real-time safety shim (LD_PRELOAD)
+ *
+ * Interposes heap, lock, sleep and I/O entry points. While the calling
+ * thread is inside an audited region (rt_audit_enter/rt_audit_leave, looked
+ * up by rt_audit.c with dlsym), any such call is reported with a backtrace
+ * and counted. Outside a region everything passes straight through.
+ *
+ * glibc only: the allocator is reached through the __libc_* aliases so the
+ * hooks work before dlsym is usable.
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_FRAMES 32
+#define MAX_REPORTS 16      /* Backtraces printed; later violations are only counted */
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+extern void *__libc_memalign(size_t align, size_t size);
+
+static __thread int t_depth;        /* Nesting of rt_audit_enter */
+static __thread int t_reporting;    /* Set while printing, so the report itself is not audited */
+static volatile int g_violations;
+
+static int (*real_mutex_lock)(pthread_mutex_t *);
+static int (*real_mutex_trylock)(pthread_mutex_t *);
+static int (*real_cond_wait)(pthread_cond_t *, pthread_mutex_t *);
+static int (*real_sem_wait)(sem_t *);
+static int (*real_nanosleep)(const struct timespec *, struct timespec *);
+static int (*real_clock_nanosleep)(clockid_t, int, const struct timespec *, struct timespec *);
+static int (*real_usleep)(useconds_t);
+static ssize_t (*real_read)(int, void *, size_t);
+static ssize_t (*real_write)(int, const void *, size_t);
+static int (*real_open)(const char *, int, ...);
+static int (*real_close)(int);
+static void *(*real_mmap)(void *, size_t, int, int, int, off_t);
+static int (*real_munmap)(void *, size_t);
+
+__attribute__((constructor))
+static void rt_audit_shim_init(void) {
+    real_mutex_lock = dlsym(RTLD_NEXT, "pthread_mutex_lock");
+    real_mutex_trylock = dlsym(RTLD_NEXT, "pthread_mutex_trylock");
+    real_cond_wait = dlsym(RTLD_NEXT, "pthread_cond_wait");
+    real_sem_wait = dlsym(RTLD_NEXT, "sem_wait");
+    real_nanosleep = dlsym(RTLD_NEXT, "nanosleep");
+    real_clock_nanosleep = dlsym(RTLD_NEXT, "clock_nanosleep");
+    real_usleep = dlsym(RTLD_NEXT, "usleep");
+    real_read = dlsym(RTLD_NEXT, "read");
+    real_write = dlsym(RTLD_NEXT, "write");
+    real_open = dlsym(RTLD_NEXT, "open");
+    real_close = dlsym(RTLD_NEXT, "close");
+    real_mmap = dlsym(RTLD_NEXT, "mmap");
+    real_munmap = dlsym(RTLD_NEXT, "munmap");
+
+    /* First backtrace() loads libgcc and allocates; get that out of the way */
+    void *frames[MAX_FRAMES];
+    backtrace(frames, MAX_FRAMES);
+}
+
+void rt_audit_enter(void) {
+    t_depth++;
+}
+
+void rt_audit_leave(void) {
+    if (t_depth > 0) t_depth--;
+}
+
+int rt_audit_violations(void) {
+    return g_violations;
+}
+
+/* Reports a forbidden call if the thread is audited; returns nonzero if it was */
+static int rt_violation(const char *what) {
+    if (t_depth == 0 || t_reporting)
+        return 0;
+
+    int count = __sync_add_and_fetch(&g_violations, 1);
+    if (count > MAX_REPORTS)
+        return 1;
+
+    t_reporting = 1;
+
+    char msg[128];
+    int len = snprintf(msg, sizeof(msg), "\n[rt-audit] forbidden call in audio path: %s\n", what);
+    if (real_write) {
+        real_write(STDERR_FILENO, msg, len);
+        void *frames[MAX_FRAMES];
+        int n = backtrace(frames, MAX_FRAMES);
+        backtrace_symbols_fd(frames + 1, n - 1, STDERR_FILENO);
+    }
+    t_reporting = 0;
+    return 1;
+}
+
+void *malloc(size_t size) {
+    rt_violation("malloc");
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+    rt_violation("calloc");
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    rt_violation("realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+    if (ptr)
+        rt_violation("free");
+    __libc_free(ptr);
+}
+
+int posix_memalign(void **out, size_t align, size_t size) {
+    rt_violation("posix_memalign");
+    void *ptr = __libc_memalign(align, size);
+    if (!ptr) return 12;    /* ENOMEM */
+    *out = ptr;
+    return 0;
+}
+
+void *aligned_alloc(size_t align, size_t size) {
+    rt_violation("aligned_alloc");
+    return __libc_memalign(align, size);
+}
+
+int pthread_mutex_lock(pthread_mutex_t *m) {
+    rt_violation("pthread_mutex_lock");
+    return real_mutex_lock(m);
+}
+
+int pthread_mutex_trylock(pthread_mutex_t *m) {
+    rt_violation("pthread_mutex_trylock");
+    return real_mutex_trylock(m);
+}
+
+int pthread_cond_wait(pthread_cond_t *c, pthread_mutex_t *m) {
+    rt_violation("pthread_cond_wait");
+    return real_cond_wait(c, m);
+}
+
+int sem_wait(sem_t *s) {
+    rt_violation("sem_wait");
+    return real_sem_wait(s);
+}
+
+int nanosleep(const struct timespec *req, struct timespec *rem) {
+    rt_violation("nanosleep");
+    return real_nanosleep(req, rem);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec *req, struct timespec *rem) {
+    rt_violation("clock_nanosleep");
+    return real_clock_nanosleep(clock, flags, req, rem);
+}
+
+int usleep(useconds_t usec) {
+    rt_violation("usleep");
+    return real_usleep(usec);
+}
+
+ssize_t read(int fd, void *buf, size_t count) {
+    rt_violation("read");
+    return real_read(fd, buf, count);
+}
+
+ssize_t write(int fd, const void *buf, size_t count) {
+    rt_violation("write");
+    return real_write(fd, buf, count);
+}
+
+int open(const char *path, int flags, ...) {
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list ap;
+        va_start(ap, flags);
+        mode = va_arg(ap, mode_t);
+        va_end(ap);
+    }
+    rt_violation("open");
+    return real_open(path, flags, mode);
+}
+
+int close(int fd) {
+    rt_violation("close");
+    return real_close(fd);
+}
+
+void *mmap(void *addr, size_t len, int prot, int flags, int fd, off_t off) {
+    rt_violation("mmap");
+    return real_mmap(addr, len, prot, flags, fd, off);
+}
+
+int munmap(void *addr, size_t len) {
+    rt_violation("munmap");
+    return real_munmap(addr, len);
+}
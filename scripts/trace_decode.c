@@ -0,0 +1,122 @@
+/*
+ * Decoder for CloudSeed block trace dumps
+ *
+ * Reads a trace.bin written by set_param("trace_dump") and prints one line
+ * per block plus a summary. Load is the block's processing time as a share
+ * of its real-time budget (frames / sample rate); blocks above 100% and
+ * late host callbacks (start-to-start gap over twice the budget) are marked.
+ *
+ * Usage: trace_decode <trace.bin> [-s]    (-s: summary only)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cloudseed_engine.h"
+
+static void flag_string(uint8_t flags, char *out) {
+    out[0] = (flags & CLOUDSEED_TRACE_PARAM_CHANGE) ? 'P' : '-';
+    out[1] = (flags & CLOUDSEED_TRACE_SILENT) ? 'S' : '-';
+    out[2] = (flags & CLOUDSEED_TRACE_BYPASS) ? 'B' : '-';
+    out[3] = (flags & CLOUDSEED_TRACE_CLEARING) ? 'C' : '-';
+    out[4] = (flags & CLOUDSEED_TRACE_CALIBRATING) ? 'T' : '-';
+    out[5] = (flags & CLOUDSEED_TRACE_SWAP) ? 'R' : '-';
+    out[6] = '\0';
+}
+
+static const char *layout_name(int layout) {
+    if (layout == CLOUDSEED_LAYOUT_SAMPLE) return "sample";
+    if (layout == CLOUDSEED_LAYOUT_AUTO) return "auto";
+    return "block";
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace.bin> [-s]\n", argv[0]);
+        return 2;
+    }
+    int summary_only = argc > 2 && strcmp(argv[2], "-s") == 0;
+
+    FILE *f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    cloudseed_trace_file_header_t header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        memcmp(header.magic, CLOUDSEED_TRACE_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: not a CloudSeed trace\n", argv[1]);
+        return 1;
+    }
+    if (header.version != CLOUDSEED_TRACE_VERSION ||
+        header.record_size != sizeof(cloudseed_trace_record_t)) {
+        fprintf(stderr, "%s: unsupported trace version %u (record size %u)\n",
+                argv[1], header.version, header.record_size);
+        return 1;
+    }
+
+    cloudseed_trace_record_t *records =
+        (cloudseed_trace_record_t*)malloc((header.count ? header.count : 1) * sizeof(*records));
+    uint32_t count = (uint32_t)fread(records, sizeof(*records), header.count, f);
+    fclose(f);
+
+    if (!summary_only)
+        printf("%8s %10s %9s %6s %6s %6s %4s %6s\n",
+               "seq", "t_ms", "dur_us", "frames", "load", "flags", "rate", "layout");
+
+    double max_load = 0.0;
+    double total_load = 0.0;
+    uint32_t max_us = 0;
+    int overruns = 0;
+    int late = 0;
+    int gaps = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const cloudseed_trace_record_t *r = &records[i];
+        double budget_ns = (double)r->frames * 1e9 / (double)header.sample_rate;
+        double load = budget_ns > 0.0 ? (double)r->duration_ns / budget_ns : 0.0;
+        const char *mark = "";
+
+        if (load > 1.0) {
+            overruns++;
+            mark = "  OVERRUN";
+        }
+        if (i > 0) {
+            const cloudseed_trace_record_t *prev = &records[i - 1];
+            if (r->sequence != prev->sequence + 1)
+                gaps++;
+            if ((double)(r->timestamp_ns - prev->timestamp_ns) > 2.0 * budget_ns) {
+                late++;
+                if (!*mark) mark = "  LATE";
+            }
+        }
+
+        if (load > max_load) max_load = load;
+        if (r->duration_ns / 1000 > max_us) max_us = r->duration_ns / 1000;
+        total_load += load;
+
+        if (!summary_only) {
+            char flags[7];
+            flag_string(r->flags, flags);
+            printf("%8u %10.3f %9.1f %6u %5.1f%% %6s %4u %6s%s\n",
+                   r->sequence, (double)(r->timestamp_ns - records[0].timestamp_ns) / 1e6,
+                   (double)r->duration_ns / 1000.0, r->frames, load * 100.0,
+                   flags, r->mod_update_rate, layout_name(r->line_layout), mark);
+        }
+    }
+
+    printf("\n%u blocks", count);
+    if (count > 0) {
+        printf(", span %.1f ms, mean load %.1f%%, max load %.1f%% (%u us)",
+               (double)(records[count - 1].timestamp_ns - records[0].timestamp_ns) / 1e6,
+               total_load * 100.0 / count, max_load * 100.0, max_us);
+    }
+    printf("\n%d overrun, %d late host callbacks, %d sequence gaps\n", overruns, late, gaps);
+    printf("flags: P=param change S=silent B=bypass C=clearing T=layout timing R=rebuild swap\n");
+
+    free(records);
+    return 0;
+}
@@ -1,1356 +1,534 @@
 /*
  * CloudSeed Audio FX Plugin
  *
- * EXACT port from CloudSeedCore by Ghost Note Audio (MIT Licensed)
- * https://github.com/GhostNoteAudio/CloudSeedCore
- *
- * This is a direct C translation of the C++ reference implementation.
- * All algorithms, buffer sizes, and processing logic match the original.
+ * Schwung v2 audio FX adapter over the CloudSeed engine (cloudseed_engine.h).
+ * Maps string keys and patch state onto engine parameters; all DSP lives
+ * in the engine library.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
 #include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
 
 #include "audio_fx_api_v1.h"
-
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
-#define SAMPLE_RATE 48000
-
-/* Buffer sizes - EXACT from reference */
-#define DELAY_BUFFER_SIZE 384000      /* 192000 * 2 - exact from ModulatedDelay.h */
-#define ALLPASS_BUFFER_SIZE 19200     /* 100ms at 192kHz - exact from ModulatedAllpass.h */
-#define BUFFER_SIZE 128               /* Process block size */
-
-/* Configuration - EXACT from reference */
-#define MAX_LINE_COUNT 12             /* TotalLineCount from ReverbChannel.h */
-#define MAX_DIFFUSER_STAGES 12        /* MaxStageCount from AllpassDiffuser.h */
-#define MAX_TAPS 256                  /* MaxTaps from MultitapDelay.h */
-#define MODULATION_UPDATE_RATE 8      /* Exact from reference */
-#define DELAY_SMOOTH_COEFF 0.00008f   /* Smoothing for delay changes (~250ms settle at 44.1kHz) */
-
-/* ============================================================================
- * UTILITY FUNCTIONS - From Utils.h
- * ============================================================================ */
-
-static inline float db2gain(float db) {
-    return powf(10.0f, db * 0.05f);
-}
-
-static inline float resp2dec(float x) {
-    /* (10^(2x) - 1) * (100/99) * 0.01 */
-    return (powf(10.0f, 2.0f * x) - 1.0f) * (100.0f / 99.0f) * 0.01f;
-}
-
-static inline float resp3dec(float x) {
-    /* (10^(3x) - 1) * (1000/999) * 0.001 */
-    return (powf(10.0f, 3.0f * x) - 1.0f) * (1000.0f / 999.0f) * 0.001f;
-}
-
-static inline float resp4oct(float x) {
-    /* (2^(4x) - 1) * (16/15) * 0.0625 */
-    return (powf(2.0f, 4.0f * x) - 1.0f) * (16.0f / 15.0f) * 0.0625f;
-}
-
-/* ============================================================================
- * LCG RANDOM - Exact port from LcgRandom.h
- * ============================================================================ */
-
-typedef struct {
-    uint64_t x;
-} lcg_random_t;
-
-static const uint64_t LCG_A = 22695477;
-static const uint64_t LCG_C = 1;
-
-static void lcg_init(lcg_random_t *rng, uint64_t seed) {
-    rng->x = seed;
-}
-
-static uint32_t lcg_next_uint(lcg_random_t *rng) {
-    uint64_t axc = LCG_A * rng->x + LCG_C;
-    rng->x = axc & 0xFFFFFFFF;
-    return (uint32_t)rng->x;
-}
+#include "cloudseed_engine.h"
 
 /* ============================================================================
- * RANDOM BUFFER - Exact port from RandomBuffer.cpp
+ * V2 API - Instance-based (V1 API removed)
  * ============================================================================ */
 
-static void random_buffer_generate(uint64_t seed, float *output, int count) {
-    lcg_random_t rand;
-    lcg_init(&rand, seed);
-    for (int i = 0; i < count; i++) {
-        uint32_t val = lcg_next_uint(&rand);
-        output[i] = (float)val / (float)UINT32_MAX;
-    }
-}
+static const host_api_v1_t *g_host = NULL;
 
-static void random_buffer_generate_cross(uint64_t seed, float cross_seed,
-                                          float *output, int count) {
-    float *seriesA = (float*)malloc(count * sizeof(float));
-    float *seriesB = (float*)malloc(count * sizeof(float));
+/* module.json's memory budget is read once, by the first instance */
+static int g_memory_budget_loaded = 0;
 
-    uint64_t seedA = seed;
-    uint64_t seedB = ~seed;
+#define AUDIO_FX_API_VERSION_2 2
+#define AUDIO_FX_INIT_V2_SYMBOL "move_audio_fx_init_v2"
 
-    random_buffer_generate(seedA, seriesA, count);
-    random_buffer_generate(seedB, seriesB, count);
+typedef struct audio_fx_api_v2 {
+    uint32_t api_version;
+    void* (*create_instance)(const char *module_dir, const char *config_json);
+    void (*destroy_instance)(void *instance);
+    void (*process_block)(void *instance, int16_t *audio_inout, int frames);
+    void (*set_param)(void *instance, const char *key, const char *val);
+    int (*get_param)(void *instance, const char *key, char *buf, int buf_len);
+} audio_fx_api_v2_t;
 
-    for (int i = 0; i < count; i++) {
-        output[i] = seriesA[i] * (1.0f - cross_seed) + seriesB[i] * cross_seed;
-    }
+typedef audio_fx_api_v2_t* (*audio_fx_init_v2_fn)(const host_api_v1_t *host);
 
-    free(seriesA);
-    free(seriesB);
-}
+#define LOG_PREFIX "[cloudseed-v2] "
+#define LOG_MSG_LEN 360             /* Longest message logged whole, prefix excluded */
 
-/* ============================================================================
- * LP1 - Exact port from Lp1.h
- * ============================================================================ */
+/* File jobs requested from set_param, which may run on the audio thread */
+#define FILE_JOB_TRACE 0x01u
+#define FILE_JOB_SNAPSHOT 0x02u
+#define SNAPSHOT_POLL_NS 2000000    /* File worker's wait between checks for the snapshot copy */
 
+/* Per-instance thread doing the file I/O and allocation those jobs need */
 typedef struct {
-    float fs;
-    float b0, a1;
-    float cutoff_hz;
-    float output;
-} lp1_t;
-
-static void lp1_init(lp1_t *f, int samplerate) {
-    f->fs = (float)samplerate;
-    f->b0 = 1.0f;
-    f->a1 = 0.0f;
-    f->cutoff_hz = 1000.0f;
-    f->output = 0.0f;
-}
-
-static void lp1_set_samplerate(lp1_t *f, int samplerate) {
-    f->fs = (float)samplerate;
-}
+    pthread_t thread;
+    sem_t wake;
+    int started;
+    int stop;
+    uint32_t jobs;              /* FILE_JOB_* bits, set by the requester, taken by the thread */
+    uint32_t trace_end;         /* Trace position when the dump was requested */
+    int snapshot_busy;          /* Set with snapshot_name by the requester, cleared when saved */
+    char snapshot_name[256];
+} file_worker_t;
 
-static void lp1_update(lp1_t *f) {
-    float hz = f->cutoff_hz;
-    if (hz >= f->fs * 0.5f)
-        hz = f->fs * 0.499f;
+/* Instance structure for v2 API */
+typedef struct {
+    /* Module directory */
+    char module_dir[256];
 
-    float x = 2.0f * M_PI * hz / f->fs;
-    float nn = 2.0f - cosf(x);
-    float alpha = nn - sqrtf(nn * nn - 1.0f);
+    cloudseed_engine_t *engine;
 
-    f->a1 = alpha;
-    f->b0 = 1.0f - alpha;
-}
+    /* Preset bank from presets.json; preset is the last recalled, -1 once a knob moves */
+    char preset_names[CLOUDSEED_MAX_PRESETS][32];
+    int preset_count;
+    int preset;
+    int morph_from;             /* Morph ends, -1 until chosen */
+    int morph_to;
 
-static void lp1_set_cutoff(lp1_t *f, float hz) {
-    f->cutoff_hz = hz;
-    lp1_update(f);
-}
+    file_worker_t files;
+} cloudseed_instance_t;
 
-static float lp1_process_sample(lp1_t *f, float input) {
-    if (input == 0.0f && f->output < 0.0000001f) {
-        f->output = 0.0f;
-    } else {
-        f->output = f->b0 * input + f->a1 * f->output;
+/* Normalized knobs, in the order they appear in the state JSON */
+static const struct {
+    const char *key;
+    cloudseed_param_t param;
+} g_param_keys[] = {
+    { "decay",      CLOUDSEED_PARAM_DECAY },
+    { "mix",        CLOUDSEED_PARAM_MIX },
+    { "predelay",   CLOUDSEED_PARAM_PREDELAY },
+    { "size",       CLOUDSEED_PARAM_SIZE },
+    { "diffusion",  CLOUDSEED_PARAM_DIFFUSION },
+    { "low_cut",    CLOUDSEED_PARAM_LOW_CUT },
+    { "high_cut",   CLOUDSEED_PARAM_HIGH_CUT },
+    { "cross_seed", CLOUDSEED_PARAM_CROSS_SEED },
+    { "mod_rate",   CLOUDSEED_PARAM_MOD_RATE },
+    { "mod_amount", CLOUDSEED_PARAM_MOD_AMOUNT },
+    { "early_late", CLOUDSEED_PARAM_EARLY_LATE },
+};
+
+#define PARAM_KEY_COUNT ((int)(sizeof(g_param_keys) / sizeof(g_param_keys[0])))
+
+static int find_param_key(const char *key) {
+    for (int i = 0; i < PARAM_KEY_COUNT; i++) {
+        if (strcmp(key, g_param_keys[i].key) == 0)
+            return i;
     }
-    return f->output;
+    return -1;
 }
 
-static void lp1_process(lp1_t *f, float *input, float *output, int len) {
-    for (int i = 0; i < len; i++)
-        output[i] = lp1_process_sample(f, input[i]);
+static void v2_log(const char *msg) {
+    if (g_host && g_host->log) {
+        char buf[sizeof(LOG_PREFIX) + LOG_MSG_LEN];
+        snprintf(buf, sizeof(buf), LOG_PREFIX "%s", msg);
+        g_host->log(buf);
+    }
 }
 
-static void lp1_clear(lp1_t *f) {
-    f->output = 0.0f;
+static void v2_engine_log(void *user, const char *msg) {
+    (void)user;
+    v2_log(msg);
 }
 
-/* ============================================================================
- * HP1 - Exact port from Hp1.h
- * ============================================================================ */
-
-typedef struct {
-    float fs;
-    float b0, a1;
-    float lp_out;
-    float cutoff_hz;
-    float output;
-} hp1_t;
-
-static void hp1_init(hp1_t *f, int samplerate) {
-    f->fs = (float)samplerate;
-    f->b0 = 1.0f;
-    f->a1 = 0.0f;
-    f->lp_out = 0.0f;
-    f->cutoff_hz = 100.0f;
-    f->output = 0.0f;
-}
-
-static void hp1_set_samplerate(hp1_t *f, int samplerate) {
-    f->fs = (float)samplerate;
+static const char *layout_name(int layout) {
+    if (layout == CLOUDSEED_LAYOUT_SAMPLE) return "sample";
+    if (layout == CLOUDSEED_LAYOUT_AUTO) return "auto";
+    return "block";
 }
 
-static void hp1_update(hp1_t *f) {
-    float hz = f->cutoff_hz;
-    if (hz >= f->fs * 0.5f)
-        hz = f->fs * 0.499f;
-
-    float x = 2.0f * M_PI * hz / f->fs;
-    float nn = 2.0f - cosf(x);
-    float alpha = nn - sqrtf(nn * nn - 1.0f);
-
-    f->a1 = alpha;
-    f->b0 = 1.0f - alpha;
+static void v2_set_line_layout(cloudseed_instance_t *inst, const char *val) {
+    if (strcmp(val, "block") == 0)
+        cloudseed_engine_set_line_layout(inst->engine, CLOUDSEED_LAYOUT_BLOCK);
+    else if (strcmp(val, "sample") == 0)
+        cloudseed_engine_set_line_layout(inst->engine, CLOUDSEED_LAYOUT_SAMPLE);
+    else if (strcmp(val, "auto") == 0)
+        cloudseed_engine_set_line_layout(inst->engine, CLOUDSEED_LAYOUT_AUTO);
 }
 
-static void hp1_set_cutoff(hp1_t *f, float hz) {
-    f->cutoff_hz = hz;
-    hp1_update(f);
+static const char *early_mode_name(int mode) {
+    if (mode == CLOUDSEED_EARLY_MULTITAP) return "multitap";
+    if (mode == CLOUDSEED_EARLY_VELVET) return "velvet";
+    return "off";
 }
 
-static float hp1_process_sample(hp1_t *f, float input) {
-    if (input == 0.0f && f->lp_out < 0.000001f) {
-        f->output = 0.0f;
-    } else {
-        f->lp_out = f->b0 * input + f->a1 * f->lp_out;
-        f->output = input - f->lp_out;
+/* Early mode by name, or -1 */
+static int find_early_mode(const char *name) {
+    for (int mode = CLOUDSEED_EARLY_OFF; mode <= CLOUDSEED_EARLY_VELVET; mode++) {
+        if (strcmp(name, early_mode_name(mode)) == 0)
+            return mode;
     }
-    return f->output;
-}
-
-static void hp1_process(hp1_t *f, float *input, float *output, int len) {
-    for (int i = 0; i < len; i++)
-        output[i] = hp1_process_sample(f, input[i]);
-}
-
-static void hp1_clear(hp1_t *f) {
-    f->lp_out = 0.0f;
-    f->output = 0.0f;
+    return -1;
 }
 
-/* ============================================================================
- * BIQUAD - Exact port from Biquad.h/cpp for shelf filters
- * ============================================================================ */
-
-typedef enum {
-    BIQUAD_LOWSHELF,
-    BIQUAD_HIGHSHELF
-} biquad_type_t;
-
-typedef struct {
-    float fs;
-    float fs_inv;
-    float gain_db;
-    float gain;
-    float q;
-    float frequency;
-    float a0, a1, a2, b0, b1, b2;
-    float x1, x2, y, y1, y2;
-    biquad_type_t type;
-} biquad_t;
-
-static void biquad_update(biquad_t *bq) {
-    float Fc = bq->frequency;
-    float V = powf(10.0f, fabsf(bq->gain_db) / 20.0f);
-    float K = tanf(M_PI * Fc * bq->fs_inv);
-    double norm = 1.0;
-
-    if (bq->type == BIQUAD_LOWSHELF) {
-        if (bq->gain_db >= 0) {
-            norm = 1.0 / (1.0 + sqrtf(2.0f) * K + K * K);
-            bq->b0 = (1.0f + sqrtf(2.0f * V) * K + V * K * K) * norm;
-            bq->b1 = 2.0f * (V * K * K - 1.0f) * norm;
-            bq->b2 = (1.0f - sqrtf(2.0f * V) * K + V * K * K) * norm;
-            bq->a1 = 2.0f * (K * K - 1.0f) * norm;
-            bq->a2 = (1.0f - sqrtf(2.0f) * K + K * K) * norm;
-        } else {
-            norm = 1.0 / (1.0 + sqrtf(2.0f * V) * K + V * K * K);
-            bq->b0 = (1.0f + sqrtf(2.0f) * K + K * K) * norm;
-            bq->b1 = 2.0f * (K * K - 1.0f) * norm;
-            bq->b2 = (1.0f - sqrtf(2.0f) * K + K * K) * norm;
-            bq->a1 = 2.0f * (V * K * K - 1.0f) * norm;
-            bq->a2 = (1.0f - sqrtf(2.0f * V) * K + V * K * K) * norm;
-        }
-    } else { /* HIGHSHELF */
-        if (bq->gain_db >= 0) {
-            norm = 1.0 / (1.0 + sqrtf(2.0f) * K + K * K);
-            bq->b0 = (V + sqrtf(2.0f * V) * K + K * K) * norm;
-            bq->b1 = 2.0f * (K * K - V) * norm;
-            bq->b2 = (V - sqrtf(2.0f * V) * K + K * K) * norm;
-            bq->a1 = 2.0f * (K * K - 1.0f) * norm;
-            bq->a2 = (1.0f - sqrtf(2.0f) * K + K * K) * norm;
-        } else {
-            norm = 1.0 / (V + sqrtf(2.0f * V) * K + K * K);
-            bq->b0 = (1.0f + sqrtf(2.0f) * K + K * K) * norm;
-            bq->b1 = 2.0f * (K * K - 1.0f) * norm;
-            bq->b2 = (1.0f - sqrtf(2.0f) * K + K * K) * norm;
-            bq->a1 = 2.0f * (K * K - V) * norm;
-            bq->a2 = (V - sqrtf(2.0f * V) * K + K * K) * norm;
-        }
+/* Memory tier by name ("compact", "standard", ...), or -1 */
+static int find_memory_tier(const char *name) {
+    for (int t = 0; t < CLOUDSEED_MEM_TIERS; t++) {
+        cloudseed_mem_tier_t tier;
+        cloudseed_engine_memory_tier_info(t, &tier);
+        if (strcmp(name, tier.name) == 0)
+            return t;
     }
+    return -1;
 }
 
-static void biquad_init(biquad_t *bq, biquad_type_t type, int samplerate) {
-    bq->type = type;
-    bq->fs = (float)samplerate;
-    bq->fs_inv = 1.0f / bq->fs;
-    bq->gain_db = 0.0f;
-    bq->gain = 1.0f;
-    bq->frequency = bq->fs * 0.25f;
-    bq->q = 0.5f;
-    bq->x1 = bq->x2 = bq->y = bq->y1 = bq->y2 = 0.0f;
-    biquad_update(bq);
-}
-
-static void biquad_set_samplerate(biquad_t *bq, int samplerate) {
-    bq->fs = (float)samplerate;
-    bq->fs_inv = 1.0f / bq->fs;
-    biquad_update(bq);
-}
-
-static void biquad_set_gain_db(biquad_t *bq, float db) {
-    if (db < -60.0f) db = -60.0f;
-    if (db > 60.0f) db = 60.0f;
-    bq->gain_db = db;
-    bq->gain = powf(10.0f, db / 20.0f);
-}
-
-static void biquad_set_frequency(biquad_t *bq, float freq) {
-    bq->frequency = freq;
-    biquad_update(bq);
+static const char *memory_tier_name(int t) {
+    cloudseed_mem_tier_t tier;
+    cloudseed_engine_memory_tier_info(t, &tier);
+    return tier.name;
 }
 
-static void biquad_process(biquad_t *bq, float *input, float *output, int len) {
-    for (int i = 0; i < len; i++) {
-        float x = input[i];
-        bq->y = bq->b0 * x + bq->b1 * bq->x1 + bq->b2 * bq->x2
-              - bq->a1 * bq->y1 - bq->a2 * bq->y2;
-        bq->x2 = bq->x1;
-        bq->y2 = bq->y1;
-        bq->x1 = x;
-        bq->y1 = bq->y;
-        output[i] = bq->y;
+/* Appends "category":bytes pairs and the total for one stats block */
+static int format_mem_stats(char *buf, int buf_len, const cloudseed_mem_stats_t *stats) {
+    int len = 0;
+    for (int c = 0; c < CLOUDSEED_MEM_CATEGORIES && len < buf_len; c++) {
+        len += snprintf(buf + len, buf_len - len, "\"%s\":%zu,",
+                        cloudseed_mem_category_name((cloudseed_mem_category_t)c), stats->bytes[c]);
     }
+    if (len < buf_len)
+        len += snprintf(buf + len, buf_len - len, "\"total\":%zu,\"allocations\":%d",
+                        stats->total, stats->allocations);
+    return len;
 }
 
-static void biquad_clear(biquad_t *bq) {
-    bq->x1 = bq->x2 = bq->y = bq->y1 = bq->y2 = 0.0f;
-}
+/* {"instance":{...},"module":{"instances":n,...,"shared":bytes}} */
+static int v2_memory_stats(cloudseed_instance_t *inst, char *buf, int buf_len) {
+    cloudseed_mem_stats_t stats;
+    int len = snprintf(buf, buf_len, "{\"instance\":{");
 
-/* ============================================================================
- * MODULATED ALLPASS - Exact port from ModulatedAllpass.h
- * ============================================================================ */
+    cloudseed_engine_memory_stats(inst->engine, &stats);
+    if (len < buf_len)
+        len += format_mem_stats(buf + len, buf_len - len, &stats);
 
-typedef struct {
-    float buffer[ALLPASS_BUFFER_SIZE];
-    int index;
-    uint64_t samples_processed;
-
-    float mod_phase;
-    int delay_a;
-    int delay_b;
-    float gain_a;
-    float gain_b;
-
-    int sample_delay;           /* Current delay (integer for read index) */
-    float sample_delay_current; /* Smoothed delay (float for interpolation) */
-    int sample_delay_target;    /* Target delay for smoothing */
-    float feedback;
-    float mod_amount;
-    float mod_rate;
-    int interpolation_enabled;
-    int modulation_enabled;
-} mod_allpass_t;;
-
-static void mod_allpass_update(mod_allpass_t *ap) {
-    /* Smooth delay toward target (called every MODULATION_UPDATE_RATE samples) */
-    float target = (float)ap->sample_delay_target;
-    float smooth_factor = 1.0f - powf(1.0f - DELAY_SMOOTH_COEFF, MODULATION_UPDATE_RATE);
-    ap->sample_delay_current += (target - ap->sample_delay_current) * smooth_factor;
-    ap->sample_delay = (int)ap->sample_delay_current;
-
-    ap->mod_phase += ap->mod_rate * MODULATION_UPDATE_RATE;
-    if (ap->mod_phase > 1.0f)
-        ap->mod_phase = fmodf(ap->mod_phase, 1.0f);
-
-    float mod = sinf(ap->mod_phase * 2.0f * M_PI);
-
-    float mod_amt = ap->mod_amount;
-    if (mod_amt >= ap->sample_delay_current)
-        mod_amt = ap->sample_delay_current - 1.0f;
-
-    float total_delay = ap->sample_delay_current + mod_amt * mod;
-    if (total_delay <= 0.0f)
-        total_delay = 1.0f;
-
-    ap->delay_a = (int)total_delay;
-    ap->delay_b = (int)total_delay + 1;
-
-    float partial = total_delay - ap->delay_a;
-    ap->gain_a = 1.0f - partial;
-    ap->gain_b = partial;
-}
+    int instances = cloudseed_engine_module_memory_stats(&stats);
+    if (len < buf_len)
+        len += snprintf(buf + len, buf_len - len, "},\"module\":{\"instances\":%d,", instances);
+    if (len < buf_len)
+        len += format_mem_stats(buf + len, buf_len - len, &stats);
+    size_t used;
+    size_t budget = cloudseed_engine_memory_budget(&used);
+    if (len < buf_len)
+        len += snprintf(buf + len, buf_len - len, ",\"shared\":%zu,\"budget\":%zu,\"budget_used\":%zu}}",
+                        stats.shared, budget, used);
 
-static void mod_allpass_init(mod_allpass_t *ap) {
-    memset(ap->buffer, 0, sizeof(ap->buffer));
-    ap->index = ALLPASS_BUFFER_SIZE - 1;
-    ap->samples_processed = 0;
-
-    ap->mod_phase = 0.01f + 0.98f * ((float)rand() / (float)RAND_MAX);
-    ap->delay_a = 0;
-    ap->delay_b = 0;
-    ap->gain_a = 0.0f;
-    ap->gain_b = 0.0f;
-
-    ap->sample_delay = 100;
-    ap->sample_delay_current = 100.0f;
-    ap->sample_delay_target = 100;
-    ap->feedback = 0.5f;
-    ap->mod_amount = 0.0f;
-    ap->mod_rate = 0.0f;
-    ap->interpolation_enabled = 1;
-    ap->modulation_enabled = 1;
-
-    mod_allpass_update(ap);
+    return len < buf_len ? len : -1;
 }
 
-static void mod_allpass_process_no_mod(mod_allpass_t *ap, float *input, float *output, int count) {
-    for (int i = 0; i < count; i++) {
-        /* Smooth delay toward target */
-        float target = (float)ap->sample_delay_target;
-        ap->sample_delay_current += (target - ap->sample_delay_current) * DELAY_SMOOTH_COEFF;
-        ap->sample_delay = (int)ap->sample_delay_current;
-
-        /* Interpolated read for smooth transitions */
-        float frac = ap->sample_delay_current - (float)ap->sample_delay;
-        int idx_a = ap->index - ap->sample_delay;
-        int idx_b = idx_a - 1;
-        if (idx_a < 0) idx_a += ALLPASS_BUFFER_SIZE;
-        if (idx_b < 0) idx_b += ALLPASS_BUFFER_SIZE;
-
-        float buf_out = ap->buffer[idx_a] * (1.0f - frac) + ap->buffer[idx_b] * frac;
-        float in_val = input[i] + buf_out * ap->feedback;
-
-        ap->buffer[ap->index] = in_val;
-        output[i] = buf_out - in_val * ap->feedback;
-
-        ap->index++;
-        if (ap->index >= ALLPASS_BUFFER_SIZE) ap->index -= ALLPASS_BUFFER_SIZE;
-        ap->samples_processed++;
+/* Writes the block trace up to position end to <module_dir>/trace.bin; file worker only */
+static void v2_dump_trace(cloudseed_instance_t *inst, uint32_t end) {
+    cloudseed_trace_record_t *records =
+        (cloudseed_trace_record_t*)malloc(CLOUDSEED_TRACE_RECORDS * sizeof(cloudseed_trace_record_t));
+    if (!records) {
+        v2_log("Trace dump failed: out of memory");
+        return;
     }
-}
-
-static void mod_allpass_process_with_mod(mod_allpass_t *ap, float *input, float *output, int count) {
-    for (int i = 0; i < count; i++) {
-        if (ap->samples_processed >= MODULATION_UPDATE_RATE) {
-            mod_allpass_update(ap);
-            ap->samples_processed = 0;
-        }
-
-        float buf_out;
-        if (ap->interpolation_enabled) {
-            int idx_a = ap->index - ap->delay_a;
-            int idx_b = ap->index - ap->delay_b;
-            if (idx_a < 0) idx_a += ALLPASS_BUFFER_SIZE;
-            if (idx_b < 0) idx_b += ALLPASS_BUFFER_SIZE;
-            buf_out = ap->buffer[idx_a] * ap->gain_a + ap->buffer[idx_b] * ap->gain_b;
-        } else {
-            int idx_a = ap->index - ap->delay_a;
-            if (idx_a < 0) idx_a += ALLPASS_BUFFER_SIZE;
-            buf_out = ap->buffer[idx_a];
-        }
-
-        float in_val = input[i] + buf_out * ap->feedback;
-        ap->buffer[ap->index] = in_val;
-        output[i] = buf_out - in_val * ap->feedback;
-
-        ap->index++;
-        if (ap->index >= ALLPASS_BUFFER_SIZE) ap->index -= ALLPASS_BUFFER_SIZE;
-        ap->samples_processed++;
+    int count = cloudseed_engine_trace_snapshot_until(inst->engine, end, records,
+                                                      CLOUDSEED_TRACE_RECORDS);
+
+    char path[300];
+    snprintf(path, sizeof(path), "%s/trace.bin", inst->module_dir[0] ? inst->module_dir : ".");
+
+    cloudseed_trace_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CLOUDSEED_TRACE_MAGIC, 4);
+    header.version = CLOUDSEED_TRACE_VERSION;
+    header.record_size = sizeof(cloudseed_trace_record_t);
+    header.count = (uint32_t)count;
+    header.sample_rate = CLOUDSEED_SAMPLE_RATE;
+
+    char msg[LOG_MSG_LEN];
+    FILE *f = fopen(path, "wb");
+    if (f && fwrite(&header, sizeof(header), 1, f) == 1 &&
+        fwrite(records, sizeof(cloudseed_trace_record_t), count, f) == (size_t)count) {
+        snprintf(msg, sizeof(msg), "Trace dump: %d blocks to %s", count, path);
+    } else {
+        snprintf(msg, sizeof(msg), "Trace dump failed: %s", path);
     }
+    if (f) fclose(f);
+    v2_log(msg);
+    free(records);
 }
 
-static void mod_allpass_process(mod_allpass_t *ap, float *input, float *output, int count) {
-    if (ap->modulation_enabled)
-        mod_allpass_process_with_mod(ap, input, output, count);
+/* Snapshot file path: absolute as given, else under the module directory (default snapshot.bin); -1 if it does not fit */
+static int v2_snapshot_path(const char *module_dir, const char *name, char *path, int path_len) {
+    if (!name || !*name)
+        name = "snapshot.bin";
+    int len;
+    if (name[0] == '/')
+        len = snprintf(path, path_len, "%s", name);
     else
-        mod_allpass_process_no_mod(ap, input, output, count);
-}
-
-static void mod_allpass_clear(mod_allpass_t *ap) {
-    memset(ap->buffer, 0, sizeof(ap->buffer));
-}
-
-/* ============================================================================
- * ALLPASS DIFFUSER - Exact port from AllpassDiffuser.h
- * ============================================================================ */
-
-typedef struct {
-    mod_allpass_t filters[MAX_DIFFUSER_STAGES];
-    int delay;
-    float mod_rate;
-    float seed_values[MAX_DIFFUSER_STAGES * 3];
-    int seed;
-    float cross_seed;
-    int stages;
-    int samplerate;
-} allpass_diffuser_t;
-
-static void diffuser_update(allpass_diffuser_t *d) {
-    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
-        float r = d->seed_values[i];
-        float scale = powf(10.0f, r) * 0.1f;  /* 0.1 to 1.0 */
-        int target = (int)(d->delay * scale);
-        if (target < 1) target = 1;
-        d->filters[i].sample_delay_target = target;
-    }
+        len = snprintf(path, path_len, "%s/%s", module_dir && *module_dir ? module_dir : ".", name);
+    return len >= 0 && len < path_len ? 0 : -1;
 }
 
-static void diffuser_update_seeds(allpass_diffuser_t *d) {
-    random_buffer_generate_cross(d->seed, d->cross_seed,
-                                  d->seed_values, MAX_DIFFUSER_STAGES * 3);
-    diffuser_update(d);
-}
-
-/* Forward declarations */
-static void diffuser_set_mod_rate(allpass_diffuser_t *d, float rate);
-
-static void diffuser_init(allpass_diffuser_t *d, int samplerate) {
-    d->samplerate = samplerate;
-    d->cross_seed = 0.0f;
-    d->seed = 23456;
-    d->stages = 1;
-    d->delay = 100;
-    d->mod_rate = 0.0f;
-
-    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
-        mod_allpass_init(&d->filters[i]);
+/*
+ * Writes the engine's DSP state snapshot to the requested file; file worker
+ * only. The engine copies its state at a block boundary over the next
+ * blocks; an instance closing meanwhile leaves the copy to the engine.
+ */
+static void v2_save_snapshot(cloudseed_instance_t *inst) {
+    file_worker_t *w = &inst->files;
+    char path[300];
+    if (!memchr(w->snapshot_name, '\0', sizeof(w->snapshot_name)) ||
+        v2_snapshot_path(inst->module_dir, w->snapshot_name, path, sizeof(path)) != 0) {
+        v2_log("Snapshot failed: path too long");
+        return;
     }
 
-    diffuser_update_seeds(d);
-}
-
-static void diffuser_set_samplerate(allpass_diffuser_t *d, int samplerate) {
-    d->samplerate = samplerate;
-    diffuser_set_mod_rate(d, d->mod_rate);
-}
-
-static void diffuser_set_seed(allpass_diffuser_t *d, int seed) {
-    d->seed = seed;
-    diffuser_update_seeds(d);
-}
-
-static void diffuser_set_cross_seed(allpass_diffuser_t *d, float cross_seed) {
-    d->cross_seed = cross_seed;
-    diffuser_update_seeds(d);
-}
-
-static void diffuser_set_interpolation(allpass_diffuser_t *d, int enabled) {
-    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++)
-        d->filters[i].interpolation_enabled = enabled;
-}
-
-static void diffuser_set_modulation(allpass_diffuser_t *d, int enabled) {
-    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++)
-        d->filters[i].modulation_enabled = enabled;
-}
-
-static void diffuser_set_delay(allpass_diffuser_t *d, int samples) {
-    d->delay = samples;
-    diffuser_update(d);
-}
-
-static void diffuser_set_feedback(allpass_diffuser_t *d, float fb) {
-    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++)
-        d->filters[i].feedback = fb;
-}
-
-static void diffuser_set_mod_amount(allpass_diffuser_t *d, float amount) {
-    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
-        float scale = 0.85f + 0.3f * d->seed_values[MAX_DIFFUSER_STAGES + i];
-        d->filters[i].mod_amount = amount * scale;
+    char msg[LOG_MSG_LEN];
+    if (cloudseed_engine_snapshot_begin(inst->engine) != 0) {
+        snprintf(msg, sizeof(msg), "Snapshot failed: %s (another in progress)", path);
+        v2_log(msg);
+        return;
     }
-}
 
-static void diffuser_set_mod_rate(allpass_diffuser_t *d, float rate) {
-    d->mod_rate = rate;
-    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
-        float scale = 0.85f + 0.3f * d->seed_values[MAX_DIFFUSER_STAGES * 2 + i];
-        d->filters[i].mod_rate = rate * scale / d->samplerate;
+    int ready;
+    struct timespec poll = { 0, SNAPSHOT_POLL_NS };
+    while ((ready = cloudseed_engine_snapshot_ready(inst->engine)) == 0) {
+        if (__atomic_load_n(&w->stop, __ATOMIC_ACQUIRE)) {
+            snprintf(msg, sizeof(msg), "Snapshot abandoned: %s", path);
+            v2_log(msg);
+            return;
+        }
+        nanosleep(&poll, NULL);
     }
-}
-
-static void diffuser_process(allpass_diffuser_t *d, float *input, float *output, int count) {
-    float temp[BUFFER_SIZE];
-
-    mod_allpass_process(&d->filters[0], input, temp, count);
-    for (int i = 1; i < d->stages; i++)
-        mod_allpass_process(&d->filters[i], temp, temp, count);
-
-    memcpy(output, temp, count * sizeof(float));
-}
 
-static void diffuser_clear(allpass_diffuser_t *d) {
-    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++)
-        mod_allpass_clear(&d->filters[i]);
-}
-
-/* ============================================================================
- * MODULATED DELAY - Exact port from ModulatedDelay.h
- * ============================================================================ */
+    size_t size = ready > 0 ? cloudseed_engine_snapshot_size(inst->engine) : 0;
+    void *data = size ? malloc(size) : NULL;
+    if (data)
+        size = cloudseed_engine_save_snapshot(inst->engine, data, size);
+    cloudseed_engine_snapshot_end(inst->engine);
 
-typedef struct {
-    float *buffer;  /* Dynamically allocated */
-    int write_index;
-    int read_index_a;
-    int read_index_b;
-    uint64_t samples_processed;
-
-    float mod_phase;
-    float gain_a;
-    float gain_b;
-
-    int sample_delay;           /* Current delay (integer for read index) */
-    float sample_delay_current; /* Smoothed delay (float for interpolation) */
-    int sample_delay_target;    /* Target delay for smoothing */
-    float mod_amount;
-    float mod_rate;
-} mod_delay_t;;
-
-static void mod_delay_update(mod_delay_t *d) {
-    /* Smooth delay toward target (called every MODULATION_UPDATE_RATE samples) */
-    float target = (float)d->sample_delay_target;
-    float smooth_factor = 1.0f - powf(1.0f - DELAY_SMOOTH_COEFF, MODULATION_UPDATE_RATE);
-    d->sample_delay_current += (target - d->sample_delay_current) * smooth_factor;
-    d->sample_delay = (int)d->sample_delay_current;
-
-    d->mod_phase += d->mod_rate * MODULATION_UPDATE_RATE;
-    if (d->mod_phase > 1.0f)
-        d->mod_phase = fmodf(d->mod_phase, 1.0f);
-
-    float mod = sinf(d->mod_phase * 2.0f * M_PI);
-    float total_delay = d->sample_delay_current + d->mod_amount * mod;
-
-    int delay_a = (int)total_delay;
-    int delay_b = (int)total_delay + 1;
-
-    float partial = total_delay - delay_a;
-    d->gain_a = 1.0f - partial;
-    d->gain_b = partial;
-
-    d->read_index_a = d->write_index - delay_a;
-    d->read_index_b = d->write_index - delay_b;
-    if (d->read_index_a < 0) d->read_index_a += DELAY_BUFFER_SIZE;
-    if (d->read_index_b < 0) d->read_index_b += DELAY_BUFFER_SIZE;
+    FILE *f = data && size ? fopen(path, "wb") : NULL;
+    if (f && fwrite(data, 1, size, f) == size)
+        snprintf(msg, sizeof(msg), "Snapshot: %zu bytes to %s", size, path);
+    else
+        snprintf(msg, sizeof(msg), "Snapshot failed: %s", path);
+    if (f) fclose(f);
+    v2_log(msg);
+    free(data);
 }
 
-static void mod_delay_init(mod_delay_t *d) {
-    d->buffer = (float*)calloc(DELAY_BUFFER_SIZE, sizeof(float));
-    d->write_index = 0;
-    d->read_index_a = 0;
-    d->read_index_b = 0;
-    d->samples_processed = 0;
+static void *v2_file_worker(void *arg) {
+    cloudseed_instance_t *inst = (cloudseed_instance_t*)arg;
+    file_worker_t *w = &inst->files;
 
-    d->mod_phase = 0.01f + 0.98f * ((float)rand() / (float)RAND_MAX);
-    d->gain_a = 0.0f;
-    d->gain_b = 0.0f;
+    for (;;) {
+        while (sem_wait(&w->wake) != 0 && errno == EINTR) {}
 
-    d->sample_delay = 100;
-    d->sample_delay_current = 100.0f;
-    d->sample_delay_target = 100;
-    d->mod_amount = 0.0f;
-    d->mod_rate = 0.0f;
-
-    mod_delay_update(d);
-}
-
-static void mod_delay_free(mod_delay_t *d) {
-    if (d->buffer) {
-        free(d->buffer);
-        d->buffer = NULL;
-    }
-}
-
-static void mod_delay_process(mod_delay_t *d, float *input, float *output, int count) {
-    for (int i = 0; i < count; i++) {
-        if (d->samples_processed >= MODULATION_UPDATE_RATE) {
-            mod_delay_update(d);
-            d->samples_processed = 0;
+        uint32_t jobs = __atomic_exchange_n(&w->jobs, 0, __ATOMIC_ACQUIRE);
+        if (jobs & FILE_JOB_TRACE)
+            v2_dump_trace(inst, __atomic_load_n(&w->trace_end, __ATOMIC_RELAXED));
+        if (jobs & FILE_JOB_SNAPSHOT) {
+            v2_save_snapshot(inst);
+            __atomic_store_n(&w->snapshot_busy, 0, __ATOMIC_RELEASE);
         }
 
-        d->buffer[d->write_index] = input[i];
-        output[i] = d->buffer[d->read_index_a] * d->gain_a +
-                    d->buffer[d->read_index_b] * d->gain_b;
-
-        d->write_index++;
-        d->read_index_a++;
-        d->read_index_b++;
-        if (d->write_index >= DELAY_BUFFER_SIZE) d->write_index -= DELAY_BUFFER_SIZE;
-        if (d->read_index_a >= DELAY_BUFFER_SIZE) d->read_index_a -= DELAY_BUFFER_SIZE;
-        if (d->read_index_b >= DELAY_BUFFER_SIZE) d->read_index_b -= DELAY_BUFFER_SIZE;
-        d->samples_processed++;
+        if (__atomic_load_n(&w->stop, __ATOMIC_ACQUIRE))
+            break;
     }
+    return NULL;
 }
 
-static void mod_delay_clear(mod_delay_t *d) {
-    if (d->buffer)
-        memset(d->buffer, 0, DELAY_BUFFER_SIZE * sizeof(float));
-}
-
-/* ============================================================================
- * MULTITAP DELAY - Exact port from MultitapDelay.h
- * ============================================================================ */
-
-typedef struct {
-    float *buffer;  /* Dynamically allocated */
-    float tap_gains[MAX_TAPS];
-    float tap_position[MAX_TAPS];
-    float seed_values[MAX_TAPS * 3];
-
-    int write_idx;
-    int seed;
-    float cross_seed;
-    int count;
-    float length_samples;
-    float decay;
-} multitap_delay_t;
-
-static void multitap_update(multitap_delay_t *mt) {
-    int s = 0;
-    for (int i = 0; i < MAX_TAPS; i++) {
-        float phase = mt->seed_values[s++] < 0.5f ? 1.0f : -1.0f;
-        mt->tap_gains[i] = db2gain(-20.0f + mt->seed_values[s++] * 20.0f) * phase;
-        mt->tap_position[i] = i + mt->seed_values[s++];
-    }
-}
-
-static void multitap_update_seeds(multitap_delay_t *mt) {
-    random_buffer_generate_cross(mt->seed, mt->cross_seed,
-                                  mt->seed_values, MAX_TAPS * 3);
-    multitap_update(mt);
-}
-
-static void multitap_init(multitap_delay_t *mt) {
-    mt->buffer = (float*)calloc(DELAY_BUFFER_SIZE, sizeof(float));
-    mt->write_idx = 0;
-    mt->seed = 0;
-    mt->cross_seed = 0.0f;
-    mt->count = 1;
-    mt->length_samples = 1000.0f;
-    mt->decay = 1.0f;
-
-    multitap_update_seeds(mt);
-}
-
-static void multitap_free(multitap_delay_t *mt) {
-    if (mt->buffer) {
-        free(mt->buffer);
-        mt->buffer = NULL;
+static void v2_file_worker_start(cloudseed_instance_t *inst) {
+    file_worker_t *w = &inst->files;
+    if (sem_init(&w->wake, 0, 0) != 0)
+        return;
+    if (pthread_create(&w->thread, NULL, v2_file_worker, inst) != 0) {
+        sem_destroy(&w->wake);
+        v2_log("File worker unavailable: trace dumps and snapshots disabled");
+        return;
     }
+    w->started = 1;
 }
 
-static void multitap_set_seed(multitap_delay_t *mt, int seed) {
-    mt->seed = seed;
-    multitap_update_seeds(mt);
-}
-
-static void multitap_set_cross_seed(multitap_delay_t *mt, float cross_seed) {
-    mt->cross_seed = cross_seed;
-    multitap_update_seeds(mt);
-}
-
-static void multitap_set_tap_count(multitap_delay_t *mt, int count) {
-    if (count < 1) count = 1;
-    mt->count = count;
-    multitap_update(mt);
-}
-
-static void multitap_set_tap_length(multitap_delay_t *mt, int samples) {
-    if (samples < 10) samples = 10;
-    mt->length_samples = (float)samples;
-    multitap_update(mt);
+/* Finishes queued jobs, then joins the thread */
+static void v2_file_worker_stop(cloudseed_instance_t *inst) {
+    file_worker_t *w = &inst->files;
+    if (!w->started)
+        return;
+    __atomic_store_n(&w->stop, 1, __ATOMIC_RELEASE);
+    sem_post(&w->wake);
+    pthread_join(w->thread, NULL);
+    sem_destroy(&w->wake);
+    w->started = 0;
 }
 
-static void multitap_set_tap_decay(multitap_delay_t *mt, float decay) {
-    mt->decay = decay;
+/* Queues jobs for the file worker; wait-free, safe on the audio thread */
+static void v2_file_worker_post(cloudseed_instance_t *inst, uint32_t jobs) {
+    file_worker_t *w = &inst->files;
+    if (!w->started)
+        return;
+    __atomic_fetch_or(&w->jobs, jobs, __ATOMIC_RELEASE);
+    sem_post(&w->wake);
 }
 
-static void multitap_process(multitap_delay_t *mt, float *input, float *output, int count) {
-    float length_scaler = mt->length_samples / (float)mt->count;
-    float total_gain = 3.0f / sqrtf(1.0f + mt->count);
-    total_gain *= (1.0f + mt->decay * 2.0f);
-
-    for (int i = 0; i < count; i++) {
-        mt->buffer[mt->write_idx] = input[i];
-        output[i] = 0.0f;
-
-        for (int j = 0; j < mt->count; j++) {
-            float offset = mt->tap_position[j] * length_scaler;
-            float decay_effective = expf(-offset / mt->length_samples * 3.3f) * mt->decay
-                                   + (1.0f - mt->decay);
-            int read_idx = mt->write_idx - (int)offset;
-            if (read_idx < 0) read_idx += DELAY_BUFFER_SIZE;
-
-            output[i] += mt->buffer[read_idx] * mt->tap_gains[j] * decay_effective * total_gain;
-        }
+/* Queues a snapshot save to name; dropped while one is still being saved */
+static void v2_request_snapshot(cloudseed_instance_t *inst, const char *name) {
+    file_worker_t *w = &inst->files;
+    int idle = 0;
+    if (!w->started ||
+        !__atomic_compare_exchange_n(&w->snapshot_busy, &idle, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return;
 
-        mt->write_idx = (mt->write_idx + 1) % DELAY_BUFFER_SIZE;
+    /* A name that does not fit is left unterminated, for the worker to refuse */
+    int i = 0;
+    for (; name && name[i] && i < (int)sizeof(w->snapshot_name); i++)
+        w->snapshot_name[i] = name[i];
+    if (i < (int)sizeof(w->snapshot_name))
+        w->snapshot_name[i] = '\0';
+    v2_file_worker_post(inst, FILE_JOB_SNAPSHOT);
+}
+
+/* Creates an engine resuming a snapshot file, mapped rather than read; NULL if unusable */
+static cloudseed_engine_t *v2_restore_snapshot(const char *module_dir, const char *name,
+                                               const cloudseed_hooks_t *hooks) {
+    char path[300];
+    if (v2_snapshot_path(module_dir, name, path, sizeof(path)) != 0) {
+        v2_log("Snapshot not restored: path too long");
+        return NULL;
     }
-}
 
-static void multitap_clear(multitap_delay_t *mt) {
-    if (mt->buffer)
-        memset(mt->buffer, 0, DELAY_BUFFER_SIZE * sizeof(float));
-}
-
-/* ============================================================================
- * CIRCULAR BUFFER - For feedback in delay lines
- * ============================================================================ */
-
-typedef struct {
-    float buffer[BUFFER_SIZE * 2];
-    int idx_read;
-    int idx_write;
-    int count;
-} circular_buffer_t;
-
-static void circular_init(circular_buffer_t *cb) {
-    memset(cb->buffer, 0, sizeof(cb->buffer));
-    cb->idx_read = 0;
-    cb->idx_write = 0;
-    cb->count = 0;
-}
-
-static void circular_push(circular_buffer_t *cb, float *data, int size) {
-    for (int i = 0; i < size; i++) {
-        cb->buffer[cb->idx_write] = data[i];
-        cb->idx_write = (cb->idx_write + 1) % (BUFFER_SIZE * 2);
-        cb->count++;
-        if (cb->count >= BUFFER_SIZE * 2) break;
+    char msg[LOG_MSG_LEN];
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0) {
+        if (fd >= 0) close(fd);
+        snprintf(msg, sizeof(msg), "Snapshot not found: %s", path);
+        v2_log(msg);
+        return NULL;
     }
-}
 
-static void circular_pop(circular_buffer_t *cb, float *dest, int size) {
-    for (int i = 0; i < size; i++) {
-        if (cb->count > 0) {
-            dest[i] = cb->buffer[cb->idx_read];
-            cb->idx_read = (cb->idx_read + 1) % (BUFFER_SIZE * 2);
-            cb->count--;
-        } else {
-            dest[i] = 0.0f;
-        }
+    cloudseed_engine_t *engine = NULL;
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+        engine = cloudseed_engine_create_from_snapshot(hooks, data, (size_t)st.st_size);
+        munmap(data, (size_t)st.st_size);
     }
-}
+    close(fd);
 
-/* ============================================================================
- * DELAY LINE - Exact port from DelayLine.h
- * ============================================================================ */
-
-typedef struct {
-    mod_delay_t delay;
-    allpass_diffuser_t diffuser;
-    biquad_t low_shelf;
-    biquad_t high_shelf;
-    lp1_t low_pass;
-    circular_buffer_t feedback_buffer;
-    float feedback;
-
-    int diffuser_enabled;
-    int low_shelf_enabled;
-    int high_shelf_enabled;
-    int cutoff_enabled;
-    int tap_post_diffuser;
-    int samplerate;
-} delay_line_t;
-
-static void delay_line_init(delay_line_t *dl, int samplerate) {
-    dl->samplerate = samplerate;
-    mod_delay_init(&dl->delay);
-    diffuser_init(&dl->diffuser, samplerate);
-    biquad_init(&dl->low_shelf, BIQUAD_LOWSHELF, samplerate);
-    biquad_init(&dl->high_shelf, BIQUAD_HIGHSHELF, samplerate);
-    lp1_init(&dl->low_pass, samplerate);
-    circular_init(&dl->feedback_buffer);
-
-    dl->feedback = 0.0f;
-
-    biquad_set_gain_db(&dl->low_shelf, -20.0f);
-    dl->low_shelf.frequency = 20.0f;
-    biquad_update(&dl->low_shelf);
-
-    biquad_set_gain_db(&dl->high_shelf, -20.0f);
-    dl->high_shelf.frequency = 19000.0f;
-    biquad_update(&dl->high_shelf);
-
-    lp1_set_cutoff(&dl->low_pass, 1000.0f);
-    diffuser_set_seed(&dl->diffuser, 1);
-    diffuser_set_cross_seed(&dl->diffuser, 0.0f);
-
-    dl->diffuser_enabled = 0;
-    dl->low_shelf_enabled = 0;
-    dl->high_shelf_enabled = 0;
-    dl->cutoff_enabled = 0;
-    dl->tap_post_diffuser = 0;
-}
-
-static void delay_line_free(delay_line_t *dl) {
-    mod_delay_free(&dl->delay);
-}
-
-static void delay_line_set_samplerate(delay_line_t *dl, int samplerate) {
-    dl->samplerate = samplerate;
-    diffuser_set_samplerate(&dl->diffuser, samplerate);
-    lp1_set_samplerate(&dl->low_pass, samplerate);
-    biquad_set_samplerate(&dl->low_shelf, samplerate);
-    biquad_set_samplerate(&dl->high_shelf, samplerate);
-}
-
-static void delay_line_set_diffuser_seed(delay_line_t *dl, int seed, float cross_seed) {
-    diffuser_set_seed(&dl->diffuser, seed);
-    diffuser_set_cross_seed(&dl->diffuser, cross_seed);
-}
-
-static void delay_line_set_delay(delay_line_t *dl, int samples) {
-    dl->delay.sample_delay_target = samples;
-}
-
-static void delay_line_set_feedback(delay_line_t *dl, float fb) {
-    dl->feedback = fb;
-}
-
-static void delay_line_set_diffuser_delay(delay_line_t *dl, int samples) {
-    diffuser_set_delay(&dl->diffuser, samples);
-}
-
-static void delay_line_set_diffuser_feedback(delay_line_t *dl, float fb) {
-    diffuser_set_feedback(&dl->diffuser, fb);
-}
-
-static void delay_line_set_diffuser_stages(delay_line_t *dl, int stages) {
-    dl->diffuser.stages = stages;
-}
-
-static void delay_line_set_low_shelf_gain(delay_line_t *dl, float db) {
-    biquad_set_gain_db(&dl->low_shelf, db);
-    biquad_update(&dl->low_shelf);
-}
-
-static void delay_line_set_low_shelf_freq(delay_line_t *dl, float freq) {
-    dl->low_shelf.frequency = freq;
-    biquad_update(&dl->low_shelf);
-}
-
-static void delay_line_set_high_shelf_gain(delay_line_t *dl, float db) {
-    biquad_set_gain_db(&dl->high_shelf, db);
-    biquad_update(&dl->high_shelf);
-}
-
-static void delay_line_set_high_shelf_freq(delay_line_t *dl, float freq) {
-    dl->high_shelf.frequency = freq;
-    biquad_update(&dl->high_shelf);
-}
-
-static void delay_line_set_cutoff(delay_line_t *dl, float freq) {
-    lp1_set_cutoff(&dl->low_pass, freq);
-}
-
-static void delay_line_set_line_mod_amount(delay_line_t *dl, float amount) {
-    dl->delay.mod_amount = amount;
-}
-
-static void delay_line_set_line_mod_rate(delay_line_t *dl, float rate) {
-    dl->delay.mod_rate = rate;
-}
-
-static void delay_line_set_diffuser_mod_amount(delay_line_t *dl, float amount) {
-    diffuser_set_modulation(&dl->diffuser, amount > 0.0f);
-    diffuser_set_mod_amount(&dl->diffuser, amount);
-}
-
-static void delay_line_set_diffuser_mod_rate(delay_line_t *dl, float rate) {
-    diffuser_set_mod_rate(&dl->diffuser, rate);
-}
-
-static void delay_line_set_interpolation(delay_line_t *dl, int enabled) {
-    diffuser_set_interpolation(&dl->diffuser, enabled);
-}
-
-static void delay_line_process(delay_line_t *dl, float *input, float *output, int count) {
-    float temp[BUFFER_SIZE];
-    circular_pop(&dl->feedback_buffer, temp, count);
-
-    for (int i = 0; i < count; i++)
-        temp[i] = input[i] + temp[i] * dl->feedback;
-
-    mod_delay_process(&dl->delay, temp, temp, count);
-
-    if (!dl->tap_post_diffuser)
-        memcpy(output, temp, count * sizeof(float));
-
-    if (dl->diffuser_enabled)
-        diffuser_process(&dl->diffuser, temp, temp, count);
-    if (dl->low_shelf_enabled)
-        biquad_process(&dl->low_shelf, temp, temp, count);
-    if (dl->high_shelf_enabled)
-        biquad_process(&dl->high_shelf, temp, temp, count);
-    if (dl->cutoff_enabled)
-        lp1_process(&dl->low_pass, temp, temp, count);
-
-    circular_push(&dl->feedback_buffer, temp, count);
-
-    if (dl->tap_post_diffuser)
-        memcpy(output, temp, count * sizeof(float));
-}
-
-static void delay_line_clear_diffuser(delay_line_t *dl) {
-    diffuser_clear(&dl->diffuser);
+    snprintf(msg, sizeof(msg), engine ? "Resumed snapshot %s" : "Snapshot unusable: %s", path);
+    v2_log(msg);
+    return engine;
 }
 
-static void delay_line_clear(delay_line_t *dl) {
-    mod_delay_clear(&dl->delay);
-    diffuser_clear(&dl->diffuser);
-    biquad_clear(&dl->low_shelf);
-    biquad_clear(&dl->high_shelf);
-    lp1_clear(&dl->low_pass);
-    circular_init(&dl->feedback_buffer);
-}
-
-/* ============================================================================
- * REVERB CHANNEL - Exact port from ReverbChannel.h
- * ============================================================================ */
-
-typedef struct {
-    mod_delay_t predelay;
-    multitap_delay_t multitap;
-    allpass_diffuser_t diffuser;
-    delay_line_t lines[MAX_LINE_COUNT];
-    hp1_t high_pass;
-    lp1_t low_pass;
-
-    float delay_line_seeds[MAX_LINE_COUNT * 3];
-    int delay_line_seed;
-    int post_diffusion_seed;
-    float cross_seed;
-
-    int line_count;
-    int low_cut_enabled;
-    int high_cut_enabled;
-    int multitap_enabled;
-    int diffuser_enabled;
-
-    float input_mix;
-    float dry_out;
-    float early_out;
-    float line_out;
-
-    int is_right;
-    int samplerate;
-} reverb_channel_t;
-
-static float channel_ms2samples(reverb_channel_t *ch, float ms) {
-    return ms / 1000.0f * ch->samplerate;
-}
-
-static float channel_get_per_line_gain(reverb_channel_t *ch) {
-    return 1.0f / sqrtf((float)ch->line_count);
+/* Helper to extract a JSON number value by key */
+static int json_get_number(const char *json, const char *key, float *out) {
+    char search[64];
+    snprintf(search, sizeof(search), "\"%s\":", key);
+    const char *pos = strstr(json, search);
+    if (!pos) return -1;
+    pos += strlen(search);
+    while (*pos == ' ') pos++;
+    *out = (float)atof(pos);
+    return 0;
 }
 
-static void channel_update_post_diffusion(reverb_channel_t *ch) {
-    for (int i = 0; i < MAX_LINE_COUNT; i++)
-        delay_line_set_diffuser_seed(&ch->lines[i],
-                                      (ch->post_diffusion_seed) * (i + 1),
-                                      ch->cross_seed);
-}
+/* Helper to extract a JSON string value by key (no escapes); returns its length, cut short in out past out_len - 1, or -1 if missing */
+static int json_get_string(const char *json, const char *key, char *out, int out_len) {
+    char search[64];
+    snprintf(search, sizeof(search), "\"%s\":", key);
+    const char *pos = strstr(json, search);
+    if (!pos) return -1;
+    pos += strlen(search);
+    while (*pos == ' ') pos++;
+    if (*pos++ != '"') return -1;
 
-static void channel_update_lines(reverb_channel_t *ch,
-                                  int line_delay_samples,
-                                  float line_decay_samples,
-                                  float line_mod_amount,
-                                  float line_mod_rate,
-                                  float late_diffusion_mod_amount,
-                                  float late_diffusion_mod_rate) {
-    random_buffer_generate_cross(ch->delay_line_seed, ch->cross_seed,
-                                  ch->delay_line_seeds, MAX_LINE_COUNT * 3);
-
-    for (int i = 0; i < MAX_LINE_COUNT; i++) {
-        float mod_amt = line_mod_amount * (0.7f + 0.3f * ch->delay_line_seeds[i]);
-        float mod_rate = line_mod_rate * (0.7f + 0.3f * ch->delay_line_seeds[MAX_LINE_COUNT + i])
-                         / ch->samplerate;
-
-        float delay_samples = (0.5f + 1.0f * ch->delay_line_seeds[MAX_LINE_COUNT * 2 + i])
-                              * line_delay_samples;
-        if (delay_samples < mod_amt + 2)
-            delay_samples = mod_amt + 2;
-
-        float db_per_iteration = delay_samples / line_decay_samples * (-60.0f);
-        float gain_per_iteration = db2gain(db_per_iteration);
-
-        delay_line_set_delay(&ch->lines[i], (int)delay_samples);
-        delay_line_set_feedback(&ch->lines[i], gain_per_iteration);
-        delay_line_set_line_mod_amount(&ch->lines[i], mod_amt);
-        delay_line_set_line_mod_rate(&ch->lines[i], mod_rate);
-        delay_line_set_diffuser_mod_amount(&ch->lines[i], late_diffusion_mod_amount);
-        delay_line_set_diffuser_mod_rate(&ch->lines[i], late_diffusion_mod_rate);
+    int len = 0;
+    for (; pos[len] && pos[len] != '"'; len++) {
+        if (len < out_len - 1)
+            out[len] = pos[len];
     }
+    out[len < out_len - 1 ? len : out_len - 1] = '\0';
+    return len;
 }
 
-static void channel_init(reverb_channel_t *ch, int samplerate, int is_right) {
-    ch->samplerate = samplerate;
-    ch->is_right = is_right;
-    ch->cross_seed = 0.0f;
-    ch->line_count = 8;  /* Default from reference */
-    ch->delay_line_seed = 12345;
-    ch->post_diffusion_seed = 12345;
-
-    mod_delay_init(&ch->predelay);
-    multitap_init(&ch->multitap);
-    diffuser_init(&ch->diffuser, samplerate);
-    hp1_init(&ch->high_pass, samplerate);
-    lp1_init(&ch->low_pass, samplerate);
-
-    diffuser_set_interpolation(&ch->diffuser, 1);
-    hp1_set_cutoff(&ch->high_pass, 20.0f);
-    lp1_set_cutoff(&ch->low_pass, 20000.0f);
-
-    for (int i = 0; i < MAX_LINE_COUNT; i++)
-        delay_line_init(&ch->lines[i], samplerate);
-
-    ch->low_cut_enabled = 0;
-    ch->high_cut_enabled = 1;
-    ch->multitap_enabled = 0;
-    ch->diffuser_enabled = 1;
-
-    ch->input_mix = 1.0f;
-    ch->dry_out = 0.0f;
-    ch->early_out = 0.0f;
-    ch->line_out = 1.0f;
-}
-
-static void channel_free(reverb_channel_t *ch) {
-    mod_delay_free(&ch->predelay);
-    multitap_free(&ch->multitap);
-    for (int i = 0; i < MAX_LINE_COUNT; i++)
-        delay_line_free(&ch->lines[i]);
-}
-
-static void channel_set_samplerate(reverb_channel_t *ch, int samplerate) {
-    ch->samplerate = samplerate;
-    hp1_set_samplerate(&ch->high_pass, samplerate);
-    lp1_set_samplerate(&ch->low_pass, samplerate);
-    diffuser_set_samplerate(&ch->diffuser, samplerate);
-
-    for (int i = 0; i < MAX_LINE_COUNT; i++)
-        delay_line_set_samplerate(&ch->lines[i], samplerate);
-}
-
-static void channel_set_cross_seed(reverb_channel_t *ch, float seed_param) {
-    /* Exact from reference: Right channel uses 0.5 * seed, Left uses 1 - 0.5 * seed */
-    ch->cross_seed = ch->is_right ? 0.5f * seed_param : 1.0f - 0.5f * seed_param;
-    multitap_set_cross_seed(&ch->multitap, ch->cross_seed);
-    diffuser_set_cross_seed(&ch->diffuser, ch->cross_seed);
-}
-
-static void channel_process(reverb_channel_t *ch, float *input, float *output, int count) {
-    float temp[BUFFER_SIZE];
-    float early_out_buf[BUFFER_SIZE];
-    float line_out_buf[BUFFER_SIZE];
-    float line_sum[BUFFER_SIZE];
-
-    for (int i = 0; i < count; i++)
-        temp[i] = input[i] * ch->input_mix;
-
-    if (ch->low_cut_enabled)
-        hp1_process(&ch->high_pass, temp, temp, count);
-    if (ch->high_cut_enabled)
-        lp1_process(&ch->low_pass, temp, temp, count);
-
-    /* Denormal prevention */
-    for (int i = 0; i < count; i++) {
-        if (temp[i] * temp[i] < 0.000000001f)
-            temp[i] = 0.0f;
-    }
-
-    mod_delay_process(&ch->predelay, temp, temp, count);
-
-    if (ch->multitap_enabled)
-        multitap_process(&ch->multitap, temp, temp, count);
-
-    if (ch->diffuser_enabled)
-        diffuser_process(&ch->diffuser, temp, temp, count);
-
-    memcpy(early_out_buf, temp, count * sizeof(float));
-    memset(line_sum, 0, count * sizeof(float));
+/* Sets the module memory budget from module.json's memory_budget_mb; instance configs cannot change it */
+static void v2_load_memory_budget(const char *module_dir) {
+    float mb;
+    if (g_memory_budget_loaded || !module_dir)
+        return;
+    g_memory_budget_loaded = 1;
 
-    for (int i = 0; i < ch->line_count; i++) {
-        delay_line_process(&ch->lines[i], temp, line_out_buf, count);
-        for (int j = 0; j < count; j++)
-            line_sum[j] += line_out_buf[j];
-    }
+    char path[300];
+    snprintf(path, sizeof(path), "%s/module.json", module_dir);
+    FILE *f = fopen(path, "rb");
+    if (!f) return;
 
-    float per_line_gain = channel_get_per_line_gain(ch);
-    for (int i = 0; i < count; i++)
-        line_sum[i] *= per_line_gain;
+    char json[8192];
+    size_t n = fread(json, 1, sizeof(json) - 1, f);
+    fclose(f);
+    json[n] = '\0';
 
-    for (int i = 0; i < count; i++) {
-        output[i] = ch->dry_out * input[i]
-                  + ch->early_out * early_out_buf[i]
-                  + ch->line_out * line_sum[i];
+    if (json_get_number(json, "memory_budget_mb", &mb) == 0) {
+        cloudseed_engine_set_memory_budget(mb > 0.0f ? (size_t)(mb * 1048576.0f) : 0);
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Memory budget: %.0f MB", mb);
+        v2_log(msg);
     }
 }
 
-static void channel_clear(reverb_channel_t *ch) {
-    lp1_clear(&ch->low_pass);
-    hp1_clear(&ch->high_pass);
-    mod_delay_clear(&ch->predelay);
-    multitap_clear(&ch->multitap);
-    diffuser_clear(&ch->diffuser);
-    for (int i = 0; i < MAX_LINE_COUNT; i++)
-        delay_line_clear(&ch->lines[i]);
-}
-
-/* ============================================================================
- * V2 API - Instance-based (V1 API removed)
- * ============================================================================ */
-
-static const host_api_v1_t *g_host = NULL;
-
-#define AUDIO_FX_API_VERSION_2 2
-#define AUDIO_FX_INIT_V2_SYMBOL "move_audio_fx_init_v2"
-
-typedef struct audio_fx_api_v2 {
-    uint32_t api_version;
-    void* (*create_instance)(const char *module_dir, const char *config_json);
-    void (*destroy_instance)(void *instance);
-    void (*process_block)(void *instance, int16_t *audio_inout, int frames);
-    void (*set_param)(void *instance, const char *key, const char *val);
-    int (*get_param)(void *instance, const char *key, char *buf, int buf_len);
-} audio_fx_api_v2_t;
-
-typedef audio_fx_api_v2_t* (*audio_fx_init_v2_fn)(const host_api_v1_t *host);
-
-/* Instance structure for v2 API */
-typedef struct {
-    /* Module directory */
-    char module_dir[256];
-
-    /* Parameters (0-1 normalized) */
-    float input_mix;
-    float predelay;
-    float decay;
-    float size;
-    float diffusion;
-    float mix;
-    float low_cut;
-    float high_cut;
-    float cross_seed;
-    float mod_rate;
-    float mod_amount;
-
-    /* Reverb channels */
-    reverb_channel_t *channel_l;
-    reverb_channel_t *channel_r;
-} cloudseed_instance_t;
-
-static void v2_log(const char *msg) {
-    if (g_host && g_host->log) {
-        char buf[256];
-        snprintf(buf, sizeof(buf), "[cloudseed-v2] %s", msg);
-        g_host->log(buf);
+/*
+ * Loads <module_dir>/presets.json, {"presets":[{"name":"Hall","decay":0.7,...},...]},
+ * into the engine's preset bank. Knobs a preset leaves out keep their current value.
+ */
+static void v2_load_presets(cloudseed_instance_t *inst) {
+    char path[300];
+    snprintf(path, sizeof(path), "%s/presets.json", inst->module_dir);
+    FILE *f = fopen(path, "rb");
+    if (!f) return;
+
+    char *json = (char*)malloc(65536);
+    size_t n = json ? fread(json, 1, 65535, f) : 0;
+    fclose(f);
+    if (!json) return;
+    json[n] = '\0';
+
+    float defaults[CLOUDSEED_PARAM_COUNT];
+    for (int p = 0; p < CLOUDSEED_PARAM_COUNT; p++)
+        defaults[p] = cloudseed_engine_get_param(inst->engine, (cloudseed_param_t)p);
+
+    float values[CLOUDSEED_MAX_PRESETS][CLOUDSEED_PARAM_COUNT];
+    int count = 0;
+    const char *pos = strstr(json, "\"presets\"");
+    pos = pos ? strchr(pos, '[') : NULL;
+    while (pos && count < CLOUDSEED_MAX_PRESETS) {
+        const char *start = strchr(pos, '{');
+        const char *end = start ? strchr(start, '}') : NULL;
+        if (!end) break;
+
+        /* One preset object; the key helpers search a terminated copy */
+        char entry[1024];
+        int len = (int)(end - start) + 1;
+        if (len >= (int)sizeof(entry)) len = sizeof(entry) - 1;
+        memcpy(entry, start, len);
+        entry[len] = '\0';
+        pos = end + 1;
+
+        memcpy(values[count], defaults, sizeof(defaults));
+        for (int i = 0; i < PARAM_KEY_COUNT; i++)
+            json_get_number(entry, g_param_keys[i].key, &values[count][g_param_keys[i].param]);
+        if (json_get_string(entry, "name", inst->preset_names[count], sizeof(inst->preset_names[count])) < 0)
+            snprintf(inst->preset_names[count], sizeof(inst->preset_names[count]), "%d", count + 1);
+        count++;
+    }
+    free(json);
+
+    char msg[LOG_MSG_LEN];
+    if (cloudseed_engine_set_presets(inst->engine, &values[0][0], count) == count) {
+        inst->preset_count = count;
+        snprintf(msg, sizeof(msg), "Presets: %d from %s", count, path);
+    } else {
+        snprintf(msg, sizeof(msg), "Presets not loaded: %s", path);
     }
+    v2_log(msg);
 }
 
-static void v2_apply_parameters(cloudseed_instance_t *inst) {
-    if (!inst->channel_l || !inst->channel_r) return;
-
-    int samplerate = SAMPLE_RATE;
-
-    /* Pre-delay: 0-500ms using Resp2dec curve */
-    float predelay_ms = resp2dec(inst->predelay) * 500.0f;
-    int predelay_samples = (int)(predelay_ms / 1000.0f * samplerate);
-    if (predelay_samples < 1) predelay_samples = 1;
-    inst->channel_l->predelay.sample_delay_target = predelay_samples;
-    inst->channel_r->predelay.sample_delay_target = predelay_samples;
-
-    /* Room size: 20-1000ms using Resp2dec curve */
-    float line_size_ms = 20.0f + resp2dec(inst->size) * 980.0f;
-    int line_delay_samples = (int)(line_size_ms / 1000.0f * samplerate);
-
-    /* Decay: 0.05-60 seconds using Resp3dec curve */
-    float decay_seconds = 0.05f + resp3dec(inst->decay) * 59.95f;
-    float line_decay_samples = decay_seconds * samplerate;
-
-    /* Modulation amounts */
-    float line_mod_amount = inst->mod_amount * 2.5f * samplerate / 1000.0f;
-    float line_mod_rate = resp2dec(inst->mod_rate) * 5.0f;
-
-    float late_diff_mod_amount = inst->mod_amount * 2.5f * samplerate / 1000.0f;
-    float late_diff_mod_rate = resp2dec(inst->mod_rate) * 5.0f;
-
-    /* Update delay lines */
-    channel_update_lines(inst->channel_l, line_delay_samples, line_decay_samples,
-                          line_mod_amount, line_mod_rate,
-                          late_diff_mod_amount, late_diff_mod_rate);
-    channel_update_lines(inst->channel_r, line_delay_samples, line_decay_samples,
-                          line_mod_amount, line_mod_rate,
-                          late_diff_mod_amount, late_diff_mod_rate);
-
-    /* Early diffuser settings */
-    int diff_stages = 4 + (int)(inst->diffusion * 7.999f);
-    inst->channel_l->diffuser.stages = diff_stages;
-    inst->channel_r->diffuser.stages = diff_stages;
-
-    float diff_delay_ms = 10.0f + inst->size * 90.0f;
-    int diff_delay = (int)(diff_delay_ms / 1000.0f * samplerate);
-    diffuser_set_delay(&inst->channel_l->diffuser, diff_delay);
-    diffuser_set_delay(&inst->channel_r->diffuser, diff_delay);
-
-    diffuser_set_feedback(&inst->channel_l->diffuser, inst->diffusion);
-    diffuser_set_feedback(&inst->channel_r->diffuser, inst->diffusion);
-
-    float diff_mod_amount = inst->mod_amount * 2.5f * samplerate / 1000.0f;
-    diffuser_set_mod_amount(&inst->channel_l->diffuser, diff_mod_amount);
-    diffuser_set_mod_amount(&inst->channel_r->diffuser, diff_mod_amount);
-
-    float diff_mod_rate = resp2dec(inst->mod_rate) * 5.0f;
-    diffuser_set_mod_rate(&inst->channel_l->diffuser, diff_mod_rate);
-    diffuser_set_mod_rate(&inst->channel_r->diffuser, diff_mod_rate);
-
-    /* Input filters */
-    float low_cut_hz = 20.0f + resp4oct(inst->low_cut) * 980.0f;
-    float high_cut_hz = 400.0f + resp4oct(inst->high_cut) * 19600.0f;
-    hp1_set_cutoff(&inst->channel_l->high_pass, low_cut_hz);
-    hp1_set_cutoff(&inst->channel_r->high_pass, low_cut_hz);
-    lp1_set_cutoff(&inst->channel_l->low_pass, high_cut_hz);
-    lp1_set_cutoff(&inst->channel_r->low_pass, high_cut_hz);
-
-    /* Cross seed for stereo */
-    channel_set_cross_seed(inst->channel_l, inst->cross_seed);
-    channel_set_cross_seed(inst->channel_r, inst->cross_seed);
-    channel_update_post_diffusion(inst->channel_l);
-    channel_update_post_diffusion(inst->channel_r);
-
-    /* EQ cutoff in delay lines (damping) */
-    float eq_cutoff = 400.0f + resp4oct(inst->high_cut * 0.8f) * 19600.0f;
-    for (int i = 0; i < MAX_LINE_COUNT; i++) {
-        delay_line_set_cutoff(&inst->channel_l->lines[i], eq_cutoff);
-        delay_line_set_cutoff(&inst->channel_r->lines[i], eq_cutoff);
-        inst->channel_l->lines[i].cutoff_enabled = 1;
-        inst->channel_r->lines[i].cutoff_enabled = 1;
+static int find_preset(const cloudseed_instance_t *inst, const char *val) {
+    for (int i = 0; i < inst->preset_count; i++) {
+        if (strcmp(val, inst->preset_names[i]) == 0)
+            return i;
     }
-
-    /* Output mix */
-    inst->channel_l->dry_out = 0.0f;
-    inst->channel_r->dry_out = 0.0f;
-    inst->channel_l->line_out = 1.0f;
-    inst->channel_r->line_out = 1.0f;
+    char *end;
+    long index = strtol(val, &end, 10);
+    return (*val && !*end && index >= 0 && index < inst->preset_count) ? (int)index : -1;
 }
 
 static void* v2_create_instance(const char *module_dir, const char *config_json) {
     v2_log("Creating instance");
+    v2_load_memory_budget(module_dir);
 
     cloudseed_instance_t *inst = (cloudseed_instance_t*)calloc(1, sizeof(cloudseed_instance_t));
     if (!inst) {
@@ -1358,39 +536,41 @@ static void* v2_create_instance(const char *module_dir, const char *config_json)
         return NULL;
     }
 
+    /* Files are written under module_dir; one cut short here gets no file worker */
+    int dir_fits = !module_dir || strlen(module_dir) < sizeof(inst->module_dir);
     if (module_dir) {
         strncpy(inst->module_dir, module_dir, sizeof(inst->module_dir) - 1);
     }
 
-    /* Set default parameters */
-    inst->input_mix = 1.0f;
-    inst->predelay = 0.0f;
-    inst->decay = 0.5f;
-    inst->size = 0.5f;
-    inst->diffusion = 0.7f;
-    inst->mix = 0.3f;
-    inst->low_cut = 0.0f;
-    inst->high_cut = 1.0f;
-    inst->cross_seed = 0.5f;
-    inst->mod_rate = 0.3f;
-    inst->mod_amount = 0.3f;
-
-    /* Allocate reverb channels */
-    inst->channel_l = (reverb_channel_t*)malloc(sizeof(reverb_channel_t));
-    inst->channel_r = (reverb_channel_t*)malloc(sizeof(reverb_channel_t));
-
-    if (!inst->channel_l || !inst->channel_r) {
-        v2_log("Failed to allocate reverb channels");
-        if (inst->channel_l) free(inst->channel_l);
-        if (inst->channel_r) free(inst->channel_r);
+    /*
+     * A snapshot named in the config resumes its state and tail; otherwise
+     * start fresh. memory_budget_mb in the config caps this instance only.
+     */
+    cloudseed_hooks_t hooks = { NULL, NULL, v2_engine_log, NULL, 0 };
+    float mb;
+    if (config_json && json_get_number(config_json, "memory_budget_mb", &mb) == 0 && mb > 0.0f)
+        hooks.memory_limit = (size_t)(mb * 1048576.0f);
+    char snapshot[256];
+    int snapshot_len = config_json ? json_get_string(config_json, "snapshot", snapshot, sizeof(snapshot)) : -1;
+    if (snapshot_len >= (int)sizeof(snapshot))
+        v2_log("Snapshot not restored: path too long");
+    else if (snapshot_len >= 0)
+        inst->engine = v2_restore_snapshot(module_dir, snapshot, &hooks);
+    if (!inst->engine)
+        inst->engine = cloudseed_engine_create(&hooks);
+    if (!inst->engine) {
         free(inst);
         return NULL;
     }
 
-    channel_init(inst->channel_l, SAMPLE_RATE, 0);
-    channel_init(inst->channel_r, SAMPLE_RATE, 1);
-
-    v2_apply_parameters(inst);
+    inst->preset = -1;
+    inst->morph_from = -1;
+    inst->morph_to = -1;
+    v2_load_presets(inst);
+    if (dir_fits)
+        v2_file_worker_start(inst);
+    else
+        v2_log("Module path too long: trace dumps and snapshots disabled");
 
     v2_log("Instance created");
     return inst;
@@ -1402,72 +582,16 @@ static void v2_destroy_instance(void *instance) {
 
     v2_log("Destroying instance");
 
-    if (inst->channel_l) {
-        channel_free(inst->channel_l);
-        free(inst->channel_l);
-    }
-    if (inst->channel_r) {
-        channel_free(inst->channel_r);
-        free(inst->channel_r);
-    }
-
+    v2_file_worker_stop(inst);
+    cloudseed_engine_destroy(inst->engine);
     free(inst);
 }
 
 static void v2_process_block(void *instance, int16_t *audio_inout, int frames) {
     cloudseed_instance_t *inst = (cloudseed_instance_t*)instance;
-    if (!inst || !inst->channel_l || !inst->channel_r) return;
-
-    /* Process in chunks of BUFFER_SIZE */
-    int offset = 0;
-    while (offset < frames) {
-        int chunk = frames - offset;
-        if (chunk > BUFFER_SIZE) chunk = BUFFER_SIZE;
-
-        float in_l[BUFFER_SIZE];
-        float in_r[BUFFER_SIZE];
-        float out_l[BUFFER_SIZE];
-        float out_r[BUFFER_SIZE];
-
-        /* Convert to float */
-        for (int i = 0; i < chunk; i++) {
-            in_l[i] = audio_inout[(offset + i) * 2] / 32768.0f;
-            in_r[i] = audio_inout[(offset + i) * 2 + 1] / 32768.0f;
-        }
-
-        /* Process through reverb channels */
-        channel_process(inst->channel_l, in_l, out_l, chunk);
-        channel_process(inst->channel_r, in_r, out_r, chunk);
-
-        /* Mix dry and wet, convert back to int16 */
-        for (int i = 0; i < chunk; i++) {
-            float mixed_l = in_l[i] * (1.0f - inst->mix) + out_l[i] * inst->mix;
-            float mixed_r = in_r[i] * (1.0f - inst->mix) + out_r[i] * inst->mix;
-
-            /* Soft clipping */
-            if (mixed_l > 1.0f) mixed_l = 1.0f;
-            if (mixed_l < -1.0f) mixed_l = -1.0f;
-            if (mixed_r > 1.0f) mixed_r = 1.0f;
-            if (mixed_r < -1.0f) mixed_r = -1.0f;
-
-            audio_inout[(offset + i) * 2] = (int16_t)(mixed_l * 32767.0f);
-            audio_inout[(offset + i) * 2 + 1] = (int16_t)(mixed_r * 32767.0f);
-        }
-
-        offset += chunk;
-    }
-}
+    if (!inst) return;
 
-/* Helper to extract a JSON number value by key */
-static int json_get_number(const char *json, const char *key, float *out) {
-    char search[64];
-    snprintf(search, sizeof(search), "\"%s\":", key);
-    const char *pos = strstr(json, search);
-    if (!pos) return -1;
-    pos += strlen(search);
-    while (*pos == ' ') pos++;
-    *out = (float)atof(pos);
-    return 0;
+    cloudseed_engine_process(inst->engine, audio_inout, frames);
 }
 
 static void v2_set_param(void *instance, const char *key, const char *val) {
@@ -1476,98 +600,209 @@ static void v2_set_param(void *instance, const char *key, const char *val) {
 
     /* State restore from patch save */
     if (strcmp(key, "state") == 0) {
+        float values[CLOUDSEED_PARAM_COUNT];
+        uint32_t mask = 0;
         float v;
-        int need_update = 0;
-        if (json_get_number(val, "decay", &v) == 0) { inst->decay = v; need_update = 1; }
-        if (json_get_number(val, "mix", &v) == 0) { inst->mix = v; }
-        if (json_get_number(val, "predelay", &v) == 0) { inst->predelay = v; need_update = 1; }
-        if (json_get_number(val, "size", &v) == 0) { inst->size = v; need_update = 1; }
-        if (json_get_number(val, "diffusion", &v) == 0) { inst->diffusion = v; need_update = 1; }
-        if (json_get_number(val, "low_cut", &v) == 0) { inst->low_cut = v; need_update = 1; }
-        if (json_get_number(val, "high_cut", &v) == 0) { inst->high_cut = v; need_update = 1; }
-        if (json_get_number(val, "cross_seed", &v) == 0) { inst->cross_seed = v; need_update = 1; }
-        if (json_get_number(val, "mod_rate", &v) == 0) { inst->mod_rate = v; need_update = 1; }
-        if (json_get_number(val, "mod_amount", &v) == 0) { inst->mod_amount = v; need_update = 1; }
-        if (need_update) v2_apply_parameters(inst);
+        for (int i = 0; i < PARAM_KEY_COUNT; i++) {
+            if (json_get_number(val, g_param_keys[i].key, &v) == 0) {
+                values[g_param_keys[i].param] = v;
+                mask |= 1u << g_param_keys[i].param;
+            }
+        }
+        if (json_get_number(val, "mod_update_rate", &v) == 0)
+            cloudseed_engine_set_mod_update_rate(inst->engine, (int)v);
+        if (json_get_number(val, "line_count", &v) == 0)
+            cloudseed_engine_set_line_count(inst->engine, (int)v);
+        char profile[16];
+        if (json_get_string(val, "memory_profile", profile, sizeof(profile)) >= 0 &&
+            find_memory_tier(profile) >= 0)
+            cloudseed_engine_set_memory_profile(inst->engine, find_memory_tier(profile));
+        char early[16];
+        if (json_get_string(val, "early_reflections", early, sizeof(early)) >= 0 &&
+            find_early_mode(early) >= 0)
+            cloudseed_engine_set_early_mode(inst->engine, find_early_mode(early));
+        if (json_get_number(val, "early_taps", &v) == 0)
+            cloudseed_engine_set_early_taps(inst->engine, (int)v);
+        cloudseed_engine_set_params(inst->engine, values, mask);
+        inst->preset = -1;
+        return;
+    }
+
+    /* Preset by name or bank index; installed at the next block, safe from any thread */
+    if (strcmp(key, "preset") == 0) {
+        int preset = find_preset(inst, val);
+        if (preset >= 0) {
+            cloudseed_engine_recall_preset(inst->engine, preset);
+            inst->preset = preset;
+        }
         return;
     }
 
-    int need_update = 0;
-    float v = atof(val);
-
-    /* Clamp to 0-1 */
-    if (v < 0.0f) v = 0.0f;
-    if (v > 1.0f) v = 1.0f;
-
-    if (strcmp(key, "decay") == 0) {
-        inst->decay = v;
-        need_update = 1;
-    } else if (strcmp(key, "mix") == 0) {
-        inst->mix = v;
-    } else if (strcmp(key, "predelay") == 0) {
-        inst->predelay = v;
-        need_update = 1;
-    } else if (strcmp(key, "size") == 0) {
-        inst->size = v;
-        need_update = 1;
-    } else if (strcmp(key, "diffusion") == 0) {
-        inst->diffusion = v;
-        need_update = 1;
-    } else if (strcmp(key, "low_cut") == 0) {
-        inst->low_cut = v;
-        need_update = 1;
-    } else if (strcmp(key, "high_cut") == 0) {
-        inst->high_cut = v;
-        need_update = 1;
-    } else if (strcmp(key, "cross_seed") == 0) {
-        inst->cross_seed = v;
-        need_update = 1;
-    } else if (strcmp(key, "mod_rate") == 0) {
-        inst->mod_rate = v;
-        need_update = 1;
-    } else if (strcmp(key, "mod_amount") == 0) {
-        inst->mod_amount = v;
-        need_update = 1;
+    /* Morph between two bank presets; the ends take effect with the next morph amount */
+    if (strcmp(key, "morph_from") == 0 || strcmp(key, "morph_to") == 0) {
+        int preset = find_preset(inst, val);
+        if (preset >= 0 && strcmp(key, "morph_from") == 0)
+            inst->morph_from = preset;
+        else if (preset >= 0)
+            inst->morph_to = preset;
+        return;
+    }
+    if (strcmp(key, "morph") == 0) {
+        if (inst->morph_from >= 0 && inst->morph_to >= 0) {
+            cloudseed_engine_set_morph(inst->engine, inst->morph_from, inst->morph_to, (float)atof(val));
+            inst->preset = -1;
+        }
+        return;
+    }
+
+    /* Action: clear the reverb tail without blocking the audio thread */
+    if (strcmp(key, "clear_tail") == 0) {
+        cloudseed_engine_clear_tail(inst->engine);
+        return;
+    }
+
+    if (strcmp(key, "line_layout") == 0) {
+        v2_set_line_layout(inst, val);
+        return;
+    }
+
+    if (strcmp(key, "early_reflections") == 0) {
+        int mode = find_early_mode(val);
+        if (mode >= 0)
+            cloudseed_engine_set_early_mode(inst->engine, mode);
+        return;
     }
 
-    if (need_update)
-        v2_apply_parameters(inst);
+    if (strcmp(key, "early_taps") == 0) {
+        cloudseed_engine_set_early_taps(inst->engine, atoi(val));
+        return;
+    }
+
+    /* Topology: buffers are rebuilt off the audio thread and swapped in at a block boundary */
+    if (strcmp(key, "memory_profile") == 0) {
+        int tier = find_memory_tier(val);
+        if (tier >= 0)
+            cloudseed_engine_set_memory_profile(inst->engine, tier);
+        return;
+    }
+    if (strcmp(key, "line_count") == 0) {
+        cloudseed_engine_set_line_count(inst->engine, atoi(val));
+        return;
+    }
+    if (strcmp(key, "rebuild_tail") == 0) {
+        if (strcmp(val, "keep") == 0)
+            cloudseed_engine_set_tail_priming(inst->engine, 1);
+        else if (strcmp(val, "drop") == 0)
+            cloudseed_engine_set_tail_priming(inst->engine, 0);
+        return;
+    }
+
+    /* Action: save a DSP state snapshot to val, a path; copied at a block boundary, the file worker writes it */
+    if (strcmp(key, "snapshot_save") == 0) {
+        v2_request_snapshot(inst, val);
+        return;
+    }
+
+    /* Action: dump the block trace ring up to this block; the file worker writes it */
+    if (strcmp(key, "trace_dump") == 0) {
+        __atomic_store_n(&inst->files.trace_end,
+                         cloudseed_engine_trace_position(inst->engine), __ATOMIC_RELAXED);
+        v2_file_worker_post(inst, FILE_JOB_TRACE);
+        return;
+    }
+
+    /* Integer control period, not a normalized knob */
+    if (strcmp(key, "mod_update_rate") == 0) {
+        cloudseed_engine_set_mod_update_rate(inst->engine, atoi(val));
+        return;
+    }
+
+    int index = find_param_key(key);
+    if (index >= 0) {
+        cloudseed_engine_set_param(inst->engine, g_param_keys[index].param, (float)atof(val));
+        inst->preset = -1;
+    }
 }
 
 static int v2_get_param(void *instance, const char *key, char *buf, int buf_len) {
     cloudseed_instance_t *inst = (cloudseed_instance_t*)instance;
     if (!inst) return -1;
-
-    if (strcmp(key, "decay") == 0) {
-        return snprintf(buf, buf_len, "%.2f", inst->decay);
-    } else if (strcmp(key, "mix") == 0) {
-        return snprintf(buf, buf_len, "%.2f", inst->mix);
-    } else if (strcmp(key, "predelay") == 0) {
-        return snprintf(buf, buf_len, "%.2f", inst->predelay);
-    } else if (strcmp(key, "size") == 0) {
-        return snprintf(buf, buf_len, "%.2f", inst->size);
-    } else if (strcmp(key, "diffusion") == 0) {
-        return snprintf(buf, buf_len, "%.2f", inst->diffusion);
-    } else if (strcmp(key, "low_cut") == 0) {
-        return snprintf(buf, buf_len, "%.2f", inst->low_cut);
-    } else if (strcmp(key, "high_cut") == 0) {
-        return snprintf(buf, buf_len, "%.2f", inst->high_cut);
-    } else if (strcmp(key, "cross_seed") == 0) {
-        return snprintf(buf, buf_len, "%.2f", inst->cross_seed);
-    } else if (strcmp(key, "mod_rate") == 0) {
-        return snprintf(buf, buf_len, "%.2f", inst->mod_rate);
-    } else if (strcmp(key, "mod_amount") == 0) {
-        return snprintf(buf, buf_len, "%.2f", inst->mod_amount);
+    const cloudseed_engine_t *e = inst->engine;
+
+    int index = find_param_key(key);
+    if (index >= 0) {
+        return snprintf(buf, buf_len, "%.2f", cloudseed_engine_get_param(e, g_param_keys[index].param));
+    } else if (strcmp(key, "mod_update_rate") == 0) {
+        return snprintf(buf, buf_len, "%d", cloudseed_engine_get_mod_update_rate(e));
+    } else if (strcmp(key, "clear_tail") == 0) {
+        return snprintf(buf, buf_len, "%d", cloudseed_engine_clear_busy(e));
+    } else if (strcmp(key, "line_layout") == 0) {
+        /* Mode plus the per block-size choice, e.g. "auto 32:sample 64:- 128:block" */
+        const char *choice[CLOUDSEED_LAYOUT_BUCKETS];
+        for (int i = 0; i < CLOUDSEED_LAYOUT_BUCKETS; i++) {
+            int c = cloudseed_engine_layout_choice(e, i);
+            choice[i] = c < 0 ? "-" : layout_name(c);
+        }
+        return snprintf(buf, buf_len, "%s 32:%s 64:%s 128:%s",
+                        layout_name(cloudseed_engine_get_line_layout(e)),
+                        choice[0], choice[1], choice[2]);
+    } else if (strcmp(key, "early_reflections") == 0) {
+        return snprintf(buf, buf_len, "%s", early_mode_name(cloudseed_engine_get_early_mode(e)));
+    } else if (strcmp(key, "early_taps") == 0) {
+        return snprintf(buf, buf_len, "%d", cloudseed_engine_get_early_taps(e));
+    } else if (strcmp(key, "tail_samples") == 0) {
+        return snprintf(buf, buf_len, "%d", cloudseed_engine_tail_samples(e));
+    } else if (strcmp(key, "is_silent") == 0) {
+        return snprintf(buf, buf_len, "%d", cloudseed_engine_is_silent(e));
+    } else if (strcmp(key, "memory_stats") == 0) {
+        return v2_memory_stats(inst, buf, buf_len);
+    } else if (strcmp(key, "memory_profile") == 0) {
+        return snprintf(buf, buf_len, "%s", memory_tier_name(cloudseed_engine_get_memory_profile(e)));
+    } else if (strcmp(key, "line_count") == 0) {
+        return snprintf(buf, buf_len, "%d", cloudseed_engine_get_line_count(e));
+    } else if (strcmp(key, "rebuild_tail") == 0) {
+        return snprintf(buf, buf_len, "%s", cloudseed_engine_get_tail_priming(e) ? "keep" : "drop");
+    } else if (strcmp(key, "memory_tier") == 0) {
+        /* Live tier, its limits and line count, e.g. "reduced predelay:250 size:500 lines:8" */
+        cloudseed_mem_tier_t tier;
+        cloudseed_engine_memory_tier_info(cloudseed_engine_memory_tier(e), &tier);
+        return snprintf(buf, buf_len, "%s predelay:%d size:%d lines:%d",
+                        tier.name, tier.max_predelay_ms, tier.max_size_ms,
+                        cloudseed_engine_active_lines(e));
+    } else if (strcmp(key, "preset") == 0) {
+        return snprintf(buf, buf_len, "%s", inst->preset >= 0 ? inst->preset_names[inst->preset] : "");
+    } else if (strcmp(key, "morph") == 0) {
+        return snprintf(buf, buf_len, "%.2f", cloudseed_engine_get_morph(e));
+    } else if (strcmp(key, "morph_from") == 0 || strcmp(key, "morph_to") == 0) {
+        int preset = strcmp(key, "morph_from") == 0 ? inst->morph_from : inst->morph_to;
+        return snprintf(buf, buf_len, "%s", preset >= 0 ? inst->preset_names[preset] : "");
+    } else if (strcmp(key, "presets") == 0) {
+        /* Bank names in order, comma-separated */
+        int len = 0;
+        buf[0] = '\0';
+        for (int i = 0; i < inst->preset_count && len < buf_len; i++)
+            len += snprintf(buf + len, buf_len - len, "%s%s", i ? "," : "", inst->preset_names[i]);
+        return len < buf_len ? len : -1;
+    } else if (strcmp(key, "cpu_variant") == 0) {
+        return snprintf(buf, buf_len, "%s", cloudseed_engine_cpu_variant());
     } else if (strcmp(key, "name") == 0) {
         return snprintf(buf, buf_len, "CloudSeed");
     } else if (strcmp(key, "state") == 0) {
-        return snprintf(buf, buf_len,
-            "{\"decay\":%.4f,\"mix\":%.4f,\"predelay\":%.4f,\"size\":%.4f,"
-            "\"diffusion\":%.4f,\"low_cut\":%.4f,\"high_cut\":%.4f,"
-            "\"cross_seed\":%.4f,\"mod_rate\":%.4f,\"mod_amount\":%.4f}",
-            inst->decay, inst->mix, inst->predelay, inst->size,
-            inst->diffusion, inst->low_cut, inst->high_cut,
-            inst->cross_seed, inst->mod_rate, inst->mod_amount);
+        int len = snprintf(buf, buf_len, "{");
+        for (int i = 0; i < PARAM_KEY_COUNT && len < buf_len; i++) {
+            len += snprintf(buf + len, buf_len - len, "\"%s\":%.4f,", g_param_keys[i].key,
+                            cloudseed_engine_get_param(e, g_param_keys[i].param));
+        }
+        if (len < buf_len)
+            len += snprintf(buf + len, buf_len - len,
+                            "\"mod_update_rate\":%d,\"line_count\":%d,\"memory_profile\":\"%s\","
+                            "\"early_reflections\":\"%s\",\"early_taps\":%d}",
+                            cloudseed_engine_get_mod_update_rate(e),
+                            cloudseed_engine_get_line_count(e),
+                            memory_tier_name(cloudseed_engine_get_memory_profile(e)),
+                            early_mode_name(cloudseed_engine_get_early_mode(e)),
+                            cloudseed_engine_get_early_taps(e));
+        return len < buf_len ? len : -1;
     } else if (strcmp(key, "ui_hierarchy") == 0) {
         const char *hierarchy = "{"
             "\"modes\":null,"
@@ -1575,7 +810,7 @@ static int v2_get_param(void *instance, const char *key, char *buf, int buf_len)
                 "\"root\":{"
                     "\"children\":null,"
                     "\"knobs\":[\"mix\",\"decay\",\"size\",\"predelay\",\"diffusion\",\"low_cut\",\"high_cut\",\"mod_amount\"],"
-                    "\"params\":[\"mix\",\"decay\",\"size\",\"predelay\",\"diffusion\",\"low_cut\",\"high_cut\",\"mod_amount\",\"mod_rate\",\"cross_seed\"]"
+                    "\"params\":[\"mix\",\"decay\",\"size\",\"predelay\",\"diffusion\",\"low_cut\",\"high_cut\",\"mod_amount\",\"mod_rate\",\"cross_seed\",\"early_late\"]"
                 "}"
             "}"
         "}";
@@ -1594,6 +829,8 @@ static audio_fx_api_v2_t g_fx_api_v2;
 audio_fx_api_v2_t* move_audio_fx_init_v2(const host_api_v1_t *host) {
     g_host = host;
 
+    cloudseed_engine_global_init();
+
     memset(&g_fx_api_v2, 0, sizeof(g_fx_api_v2));
     g_fx_api_v2.api_version = AUDIO_FX_API_VERSION_2;
     g_fx_api_v2.create_instance = v2_create_instance;
@@ -1602,7 +839,10 @@ audio_fx_api_v2_t* move_audio_fx_init_v2(const host_api_v1_t *host) {
     g_fx_api_v2.set_param = v2_set_param;
     g_fx_api_v2.get_param = v2_get_param;
 
-    v2_log("CloudSeed v2 plugin initialized");
+    char msg[64];
+    snprintf(msg, sizeof(msg), "CloudSeed v2 plugin initialized (%s kernels)",
+             cloudseed_engine_cpu_variant());
+    v2_log(msg);
 
     return &g_fx_api_v2;
 }
@@ -0,0 +1,5094 @@
+/*
+ * CloudSeed reverb engine
+ *
+ * C port of CloudSeedCore by Ghost Note Audio (MIT Licensed)
+ * https://github.com/GhostNoteAudio/CloudSeedCore
+ *
+ * The signal path follows the C++ reference; sections marked "Exact port"
+ * translate it directly. Additions on top of it: control-rate fast_math
+ * approximations, memory tiers and a module budget, a configurable line count,
+ * velvet and FFT-convolved early reflections, block-level line layout,
+ * worker-thread rebuilds and snapshots.
+ * Host-independent; see cloudseed_engine.h for the public API.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+
+#include "cloudseed_engine.h"
+#include "fast_math.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define SAMPLE_RATE CLOUDSEED_SAMPLE_RATE
+
+/* Buffer sizes - EXACT from reference */
+#define DELAY_BUFFER_SIZE 384000      /* 192000 * 2 - exact from ModulatedDelay.h */
+#define ALLPASS_BUFFER_SIZE 19200     /* 100ms at 192kHz - exact from ModulatedAllpass.h */
+#define BUFFER_SIZE 128               /* Process block size */
+
+/* Configuration - EXACT from reference */
+#define MAX_LINE_COUNT 12             /* TotalLineCount from ReverbChannel.h */
+#define MAX_DIFFUSER_STAGES 12        /* MaxStageCount from AllpassDiffuser.h */
+#define MAX_TAPS 256                  /* MaxTaps from MultitapDelay.h */
+#define MODULATION_UPDATE_RATE 8      /* Default control period - exact from reference */
+#define MAX_MODULATION_UPDATE_RATE 64 /* Coarsest control period (cheapest, most stepped LFO) */
+#define DELAY_SMOOTH_COEFF 0.00008f   /* Smoothing for delay changes (~250ms settle at 44.1kHz) */
+#define CLEAR_SAMPLES_PER_FRAME 512   /* Lazy tail clear budget: 256KB per 128-frame block */
+#define PRIME_SAMPLES_PER_FRAME 512   /* Tail priming copy budget, same size as the clear's */
+#define SILENCE_THRESHOLD (1.0f / 32768.0f) /* Below one int16 LSB */
+#define TAIL_FLOOR_DB 96.0f           /* Tail is over once it has decayed below 16-bit range */
+#define STAGE_SILENCE_THRESHOLD 1e-6f /* -120 dBFS: a stage writing only this is treated as empty */
+#define SILENT_RUN_MAX (1 << 30)
+#define CACHE_LINE_FLOATS 16          /* 64-byte lines on Cortex-A53/A72 and x86 */
+#define LINE_LAYOUT_BLOCK CLOUDSEED_LAYOUT_BLOCK
+#define LINE_LAYOUT_SAMPLE CLOUDSEED_LAYOUT_SAMPLE
+#define LINE_LAYOUT_AUTO CLOUDSEED_LAYOUT_AUTO
+#define LAYOUT_BUCKETS CLOUDSEED_LAYOUT_BUCKETS
+#define LAYOUT_CALIBRATION_BLOCKS 64  /* Timed non-silent blocks per layout before choosing */
+#define MOD_DEPTH_MS 2.5f             /* Delay modulation depth at mod_amount 1 */
+#define RING_MARGIN (BUFFER_SIZE + 4) /* Ring headroom past the furthest read in a tier-sized buffer */
+#define EARLY_OFF CLOUDSEED_EARLY_OFF
+#define EARLY_MULTITAP CLOUDSEED_EARLY_MULTITAP
+#define EARLY_VELVET CLOUDSEED_EARLY_VELVET
+#define EARLY_TAP_COUNT 128           /* Default early reflection taps */
+#define MIN_EARLY_TAPS 16
+#define EARLY_TAP_LENGTH_MS 80        /* Pattern length; fits the smallest tier's multitap ring */
+#define VELVET_SEGMENTS 8             /* Gain steps of the velvet decay envelope */
+#define CONV_BLOCK BUFFER_SIZE        /* Partition length of the multitap's FFT path */
+#define CONV_BINS (CONV_BLOCK + 1)    /* Real spectrum of a 2 * CONV_BLOCK frame */
+#define CONV_PARTITIONS ((EARLY_TAP_LENGTH_MS * SAMPLE_RATE / 1000 + CONV_BLOCK - 1) / CONV_BLOCK)
+#define CONV_MIN_TAPS 64              /* Multitap tap count from which the FFT path is cheaper */
+
+/* ============================================================================
+ * UTILITY FUNCTIONS - From Utils.h
+ * ============================================================================ */
+
+static inline float db2gain(float db) {
+    return fast_db2gain(db);
+}
+
+static inline float resp2dec(float x) {
+    /* (10^(2x) - 1) * (100/99) * 0.01 */
+    return (fast_exp10f(2.0f * x) - 1.0f) * (100.0f / 99.0f) * 0.01f;
+}
+
+static inline float resp3dec(float x) {
+    /* (10^(3x) - 1) * (1000/999) * 0.001 */
+    return (fast_exp10f(3.0f * x) - 1.0f) * (1000.0f / 999.0f) * 0.001f;
+}
+
+static inline float resp4oct(float x) {
+    /* (2^(4x) - 1) * (16/15) * 0.0625 */
+    return (fast_exp2f(4.0f * x) - 1.0f) * (16.0f / 15.0f) * 0.0625f;
+}
+
+/* ============================================================================
+ * ALLOCATION - Host hooks with libc fallback; used at create/destroy and on the worker
+ * ============================================================================ */
+
+/* Host hooks plus what has been allocated through them, by category */
+typedef struct {
+    cloudseed_hooks_t hooks;
+    size_t bytes[CLOUDSEED_MEM_CATEGORIES];
+    int allocations;
+} engine_allocator_t;
+
+/* Sum over live engines; updated atomically on create/destroy and rebuilds */
+static size_t g_module_bytes[CLOUDSEED_MEM_CATEGORIES];
+static int g_module_allocations;
+static int g_module_engines;
+
+/* Module-wide budget (0 = unlimited) and the part reserved by live engines */
+static size_t g_memory_budget;
+static size_t g_budget_used;
+
+static void *engine_alloc(engine_allocator_t *a, cloudseed_mem_category_t category, size_t size) {
+    void *ptr = a->hooks.alloc ? a->hooks.alloc(a->hooks.user, size) : malloc(size);
+    if (ptr) {
+        memset(ptr, 0, size);
+        a->bytes[category] += size;
+        a->allocations++;
+    }
+    return ptr;
+}
+
+static void engine_free(engine_allocator_t *a, void *ptr) {
+    if (!ptr) return;
+    if (a->hooks.free)
+        a->hooks.free(a->hooks.user, ptr);
+    else
+        free(ptr);
+}
+
+/* Re-files part of an allocation under a finer category */
+static void engine_mem_reclassify(engine_allocator_t *a, cloudseed_mem_category_t from,
+                                  cloudseed_mem_category_t to, size_t size) {
+    a->bytes[from] -= size;
+    a->bytes[to] += size;
+}
+
+/* Adds (sign 1) or removes (sign -1) allocations from the module totals */
+static void engine_mem_register(const engine_allocator_t *a, int sign) {
+    for (int c = 0; c < CLOUDSEED_MEM_CATEGORIES; c++) {
+        if (sign > 0)
+            __atomic_add_fetch(&g_module_bytes[c], a->bytes[c], __ATOMIC_RELAXED);
+        else
+            __atomic_sub_fetch(&g_module_bytes[c], a->bytes[c], __ATOMIC_RELAXED);
+    }
+    __atomic_add_fetch(&g_module_allocations, sign * a->allocations, __ATOMIC_RELAXED);
+}
+
+/* Reserves size from the budget; returns 0 if it does not fit, unless forced */
+static int budget_reserve(size_t size, int force) {
+    size_t used = __atomic_load_n(&g_budget_used, __ATOMIC_RELAXED);
+    do {
+        size_t budget = __atomic_load_n(&g_memory_budget, __ATOMIC_RELAXED);
+        if (!force && budget && used + size > budget)
+            return 0;
+    } while (!__atomic_compare_exchange_n(&g_budget_used, &used, used + size, 1,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return 1;
+}
+
+static void budget_release(size_t size) {
+    __atomic_sub_fetch(&g_budget_used, size, __ATOMIC_RELAXED);
+}
+
+/* ============================================================================
+ * DSP KERNELS - Hot loops compiled per CPU variant, picked once at init
+ * ============================================================================ */
+
+typedef struct {
+    const char *name;
+    void (*convert_in)(const int16_t *src, float *left, float *right, int frames);
+    void (*output_wet)(int16_t *dst, const float *wet_l, const float *wet_r, int frames);
+    void (*output_mix)(int16_t *dst, const float *dry_l, const float *dry_r,
+                       const float *wet_l, const float *wet_r,
+                       float mix_start, float mix_step, int frames);
+    int (*delay_process)(float *buf, int size, int write_index, const float *delay,
+                         const float *input, float *output, int count);
+    int (*allpass_process)(float *buf, int size, int index, float feedback,
+                           const float *delay, const float *input, float *output, int count);
+} dsp_kernels_t;
+
+#define KERNEL_SUFFIX generic
+#define KERNEL_NAME "generic"
+#define KERNEL_TARGET
+#include "dsp_kernels.h"
+#undef KERNEL_SUFFIX
+#undef KERNEL_NAME
+#undef KERNEL_TARGET
+
+/*
+ * ARM builds use the generic set: it is already compiled for ARMv8.0 NEON,
+ * fp16 would cost the tail's feedback paths precision, and dot product
+ * only covers integer lanes.
+ */
+#if defined(__x86_64__) && defined(__GNUC__)
+#define KERNEL_SUFFIX avx2
+#define KERNEL_NAME "avx2"
+#define KERNEL_TARGET __attribute__((target("avx2,fma")))
+#include "dsp_kernels.h"
+#undef KERNEL_SUFFIX
+#undef KERNEL_NAME
+#undef KERNEL_TARGET
+
+static const dsp_kernels_t *dsp_kernels_select(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return &dsp_kernels_avx2;
+    return &dsp_kernels_generic;
+}
+#else
+static const dsp_kernels_t *dsp_kernels_select(void) {
+    return &dsp_kernels_generic;
+}
+#endif
+
+static const dsp_kernels_t *g_kernels = &dsp_kernels_generic;
+
+/* ============================================================================
+ * SILENCE TRACKING - Lets idle stages skip their work
+ * ============================================================================ */
+
+/* Index of the last sample at or above the stage silence threshold, or -1 */
+static int block_last_active(const float *x, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        if (fabsf(x[i]) >= STAGE_SILENCE_THRESHOLD)
+            return i;
+    }
+    return -1;
+}
+
+/* Same scan over count samples of a ring buffer starting at start */
+static int ring_last_active(const float *buf, int size, int start, int count) {
+    int first = size - start;
+    if (first > count) first = count;
+
+    int last = block_last_active(buf, count - first);
+    if (last >= 0)
+        return first + last;
+    return block_last_active(buf + start, first);
+}
+
+static void ring_zero(float *buf, int size, int start, int count) {
+    int first = size - start;
+    if (first > count) first = count;
+
+    memset(buf + start, 0, first * sizeof(float));
+    memset(buf, 0, (count - first) * sizeof(float));
+}
+
+/* Copies count samples between two rings from the given positions, wrapping both */
+static void ring_copy(float *dst, int dst_size, int dst_pos,
+                      const float *src, int src_size, int src_pos, int count) {
+    while (count > 0) {
+        int n = count;
+        if (n > dst_size - dst_pos) n = dst_size - dst_pos;
+        if (n > src_size - src_pos) n = src_size - src_pos;
+        memcpy(dst + dst_pos, src + src_pos, n * sizeof(float));
+
+        dst_pos += n;
+        if (dst_pos == dst_size) dst_pos = 0;
+        src_pos += n;
+        if (src_pos == src_size) src_pos = 0;
+        count -= n;
+    }
+}
+
+/* Requests the cache lines covering count samples of a ring buffer starting at start */
+static inline void prefetch_ring(const float *buf, int size, int start, int count) {
+    if (start < 0) start += size;
+    for (int i = 0; i <= count; i += CACHE_LINE_FLOATS) {
+        int idx = start + i;
+        if (idx >= size) idx -= size;
+        __builtin_prefetch(buf + idx, 0, 3);
+    }
+}
+
+/* Extends a run of silent samples by one block whose last active sample is last */
+static int silent_run_extend(int run, int last, int count) {
+    if (last >= 0)
+        return count - 1 - last;
+    return run > SILENT_RUN_MAX - count ? SILENT_RUN_MAX : run + count;
+}
+
+/* ============================================================================
+ * LCG RANDOM - Exact port from LcgRandom.h
+ * ============================================================================ */
+
+typedef struct {
+    uint64_t x;
+} lcg_random_t;
+
+static const uint64_t LCG_A = 22695477;
+static const uint64_t LCG_C = 1;
+
+static void lcg_init(lcg_random_t *rng, uint64_t seed) {
+    rng->x = seed;
+}
+
+static uint32_t lcg_next_uint(lcg_random_t *rng) {
+    uint64_t axc = LCG_A * rng->x + LCG_C;
+    rng->x = axc & 0xFFFFFFFF;
+    return (uint32_t)rng->x;
+}
+
+/* ============================================================================
+ * RANDOM BUFFER - Exact port from RandomBuffer.cpp
+ * ============================================================================ */
+
+static void random_buffer_generate(uint64_t seed, float *output, int count) {
+    lcg_random_t rand;
+    lcg_init(&rand, seed);
+    for (int i = 0; i < count; i++) {
+        uint32_t val = lcg_next_uint(&rand);
+        output[i] = (float)val / (float)UINT32_MAX;
+    }
+}
+
+/* Blends the seed and ~seed series; both generators run in lockstep, no scratch buffers */
+static void random_buffer_generate_cross(uint64_t seed, float cross_seed,
+                                          float *output, int count) {
+    lcg_random_t rand_a;
+    lcg_random_t rand_b;
+    lcg_init(&rand_a, seed);
+    lcg_init(&rand_b, ~seed);
+
+    for (int i = 0; i < count; i++) {
+        float a = (float)lcg_next_uint(&rand_a) / (float)UINT32_MAX;
+        float b = (float)lcg_next_uint(&rand_b) / (float)UINT32_MAX;
+        output[i] = a * (1.0f - cross_seed) + b * cross_seed;
+    }
+}
+
+/* One-pole smoothing coefficient shared by Lp1 and Hp1 */
+static float onepole_alpha(float hz, float fs) {
+    if (hz >= fs * 0.5f)
+        hz = fs * 0.499f;
+
+    float x = 2.0f * M_PI * hz / fs;
+    float nn = 2.0f - fast_cosf(x);
+    return nn - sqrtf(nn * nn - 1.0f);
+}
+
+/* ============================================================================
+ * LP1 - Exact port from Lp1.h
+ * ============================================================================ */
+
+typedef struct {
+    float fs;
+    float b0, a1;
+    float cutoff_hz;
+    float output;
+} lp1_t;
+
+static void lp1_init(lp1_t *f, int samplerate) {
+    f->fs = (float)samplerate;
+    f->b0 = 1.0f;
+    f->a1 = 0.0f;
+    f->cutoff_hz = 1000.0f;
+    f->output = 0.0f;
+}
+
+static void lp1_set_samplerate(lp1_t *f, int samplerate) {
+    f->fs = (float)samplerate;
+}
+
+static void lp1_update(lp1_t *f) {
+    float alpha = onepole_alpha(f->cutoff_hz, f->fs);
+    f->a1 = alpha;
+    f->b0 = 1.0f - alpha;
+}
+
+static void lp1_set_cutoff(lp1_t *f, float hz) {
+    f->cutoff_hz = hz;
+    lp1_update(f);
+}
+
+/* Cutoff with a precomputed alpha (see knob tables) */
+static void lp1_set_cutoff_alpha(lp1_t *f, float hz, float alpha) {
+    f->cutoff_hz = hz;
+    f->a1 = alpha;
+    f->b0 = 1.0f - alpha;
+}
+
+/* One step with the state passed in, for coefficients shared between filters */
+static inline float lp1_step(const lp1_t *f, float *state, float input) {
+    if (input == 0.0f && *state < 0.0000001f) {
+        *state = 0.0f;
+    } else {
+        *state = f->b0 * input + f->a1 * *state;
+    }
+    return *state;
+}
+
+static float lp1_process_sample(lp1_t *f, float input) {
+    return lp1_step(f, &f->output, input);
+}
+
+static void lp1_process(lp1_t *f, float *input, float *output, int len) {
+    for (int i = 0; i < len; i++)
+        output[i] = lp1_process_sample(f, input[i]);
+}
+
+static void lp1_process_state(const lp1_t *f, float *state, float *input, float *output, int len) {
+    float y = *state;
+    for (int i = 0; i < len; i++)
+        output[i] = lp1_step(f, &y, input[i]);
+    *state = y;
+}
+
+static void lp1_clear(lp1_t *f) {
+    f->output = 0.0f;
+}
+
+static int lp1_is_settled(lp1_t *f) {
+    return fabsf(f->output) < STAGE_SILENCE_THRESHOLD;
+}
+
+/* ============================================================================
+ * HP1 - Exact port from Hp1.h
+ * ============================================================================ */
+
+typedef struct {
+    float fs;
+    float b0, a1;
+    float lp_out;
+    float cutoff_hz;
+    float output;
+} hp1_t;
+
+static void hp1_init(hp1_t *f, int samplerate) {
+    f->fs = (float)samplerate;
+    f->b0 = 1.0f;
+    f->a1 = 0.0f;
+    f->lp_out = 0.0f;
+    f->cutoff_hz = 100.0f;
+    f->output = 0.0f;
+}
+
+static void hp1_set_samplerate(hp1_t *f, int samplerate) {
+    f->fs = (float)samplerate;
+}
+
+static void hp1_update(hp1_t *f) {
+    float alpha = onepole_alpha(f->cutoff_hz, f->fs);
+    f->a1 = alpha;
+    f->b0 = 1.0f - alpha;
+}
+
+static void hp1_set_cutoff(hp1_t *f, float hz) {
+    f->cutoff_hz = hz;
+    hp1_update(f);
+}
+
+/* Cutoff with a precomputed alpha (see knob tables) */
+static void hp1_set_cutoff_alpha(hp1_t *f, float hz, float alpha) {
+    f->cutoff_hz = hz;
+    f->a1 = alpha;
+    f->b0 = 1.0f - alpha;
+}
+
+static float hp1_process_sample(hp1_t *f, float input) {
+    if (input == 0.0f && f->lp_out < 0.000001f) {
+        f->output = 0.0f;
+    } else {
+        f->lp_out = f->b0 * input + f->a1 * f->lp_out;
+        f->output = input - f->lp_out;
+    }
+    return f->output;
+}
+
+static void hp1_process(hp1_t *f, float *input, float *output, int len) {
+    for (int i = 0; i < len; i++)
+        output[i] = hp1_process_sample(f, input[i]);
+}
+
+static void hp1_clear(hp1_t *f) {
+    f->lp_out = 0.0f;
+    f->output = 0.0f;
+}
+
+static int hp1_is_settled(hp1_t *f) {
+    return fabsf(f->lp_out) < STAGE_SILENCE_THRESHOLD;
+}
+
+/* ============================================================================
+ * BIQUAD - Exact port from Biquad.h/cpp for shelf filters
+ * ============================================================================ */
+
+typedef enum {
+    BIQUAD_LOWSHELF,
+    BIQUAD_HIGHSHELF
+} biquad_type_t;
+
+/* Coefficients; the state is separate so filters can share them */
+typedef struct {
+    float fs;
+    float fs_inv;
+    float gain_db;
+    float gain;
+    float q;
+    float frequency;
+    float a0, a1, a2, b0, b1, b2;
+    biquad_type_t type;
+} biquad_t;
+
+typedef struct {
+    float x1, x2, y, y1, y2;
+} biquad_state_t;
+
+static void biquad_update(biquad_t *bq) {
+    float Fc = bq->frequency;
+    float V = fast_db2gain(fabsf(bq->gain_db));
+    float K = fast_tanf(M_PI * Fc * bq->fs_inv);
+    float norm = 1.0f;
+
+    if (bq->type == BIQUAD_LOWSHELF) {
+        if (bq->gain_db >= 0) {
+            norm = 1.0f / (1.0f + sqrtf(2.0f) * K + K * K);
+            bq->b0 = (1.0f + sqrtf(2.0f * V) * K + V * K * K) * norm;
+            bq->b1 = 2.0f * (V * K * K - 1.0f) * norm;
+            bq->b2 = (1.0f - sqrtf(2.0f * V) * K + V * K * K) * norm;
+            bq->a1 = 2.0f * (K * K - 1.0f) * norm;
+            bq->a2 = (1.0f - sqrtf(2.0f) * K + K * K) * norm;
+        } else {
+            norm = 1.0f / (1.0f + sqrtf(2.0f * V) * K + V * K * K);
+            bq->b0 = (1.0f + sqrtf(2.0f) * K + K * K) * norm;
+            bq->b1 = 2.0f * (K * K - 1.0f) * norm;
+            bq->b2 = (1.0f - sqrtf(2.0f) * K + K * K) * norm;
+            bq->a1 = 2.0f * (V * K * K - 1.0f) * norm;
+            bq->a2 = (1.0f - sqrtf(2.0f * V) * K + V * K * K) * norm;
+        }
+    } else { /* HIGHSHELF */
+        if (bq->gain_db >= 0) {
+            norm = 1.0f / (1.0f + sqrtf(2.0f) * K + K * K);
+            bq->b0 = (V + sqrtf(2.0f * V) * K + K * K) * norm;
+            bq->b1 = 2.0f * (K * K - V) * norm;
+            bq->b2 = (V - sqrtf(2.0f * V) * K + K * K) * norm;
+            bq->a1 = 2.0f * (K * K - 1.0f) * norm;
+            bq->a2 = (1.0f - sqrtf(2.0f) * K + K * K) * norm;
+        } else {
+            norm = 1.0f / (V + sqrtf(2.0f * V) * K + K * K);
+            bq->b0 = (1.0f + sqrtf(2.0f) * K + K * K) * norm;
+            bq->b1 = 2.0f * (K * K - 1.0f) * norm;
+            bq->b2 = (1.0f - sqrtf(2.0f) * K + K * K) * norm;
+            bq->a1 = 2.0f * (K * K - V) * norm;
+            bq->a2 = (V - sqrtf(2.0f * V) * K + K * K) * norm;
+        }
+    }
+}
+
+static void biquad_init(biquad_t *bq, biquad_type_t type, int samplerate) {
+    bq->type = type;
+    bq->fs = (float)samplerate;
+    bq->fs_inv = 1.0f / bq->fs;
+    bq->gain_db = 0.0f;
+    bq->gain = 1.0f;
+    bq->frequency = bq->fs * 0.25f;
+    bq->q = 0.5f;
+    biquad_update(bq);
+}
+
+static void biquad_set_samplerate(biquad_t *bq, int samplerate) {
+    bq->fs = (float)samplerate;
+    bq->fs_inv = 1.0f / bq->fs;
+    biquad_update(bq);
+}
+
+static void biquad_set_gain_db(biquad_t *bq, float db) {
+    if (db < -60.0f) db = -60.0f;
+    if (db > 60.0f) db = 60.0f;
+    bq->gain_db = db;
+    bq->gain = fast_db2gain(db);
+}
+
+static void biquad_set_frequency(biquad_t *bq, float freq) {
+    bq->frequency = freq;
+    biquad_update(bq);
+}
+
+static void biquad_process(const biquad_t *bq, biquad_state_t *st, float *input, float *output, int len) {
+    for (int i = 0; i < len; i++) {
+        float x = input[i];
+        st->y = bq->b0 * x + bq->b1 * st->x1 + bq->b2 * st->x2
+              - bq->a1 * st->y1 - bq->a2 * st->y2;
+        st->x2 = st->x1;
+        st->y2 = st->y1;
+        st->x1 = x;
+        st->y1 = st->y;
+        output[i] = st->y;
+    }
+}
+
+static void biquad_clear(biquad_state_t *st) {
+    st->x1 = st->x2 = st->y = st->y1 = st->y2 = 0.0f;
+}
+
+static int biquad_is_settled(const biquad_state_t *st) {
+    return fabsf(st->x1) < STAGE_SILENCE_THRESHOLD && fabsf(st->x2) < STAGE_SILENCE_THRESHOLD &&
+           fabsf(st->y1) < STAGE_SILENCE_THRESHOLD && fabsf(st->y2) < STAGE_SILENCE_THRESHOLD;
+}
+
+/* ============================================================================
+ * MODULATED ALLPASS - Exact port from ModulatedAllpass.h
+ * ============================================================================ */
+
+typedef struct {
+    float *buffer;              /* Slice of the channel's allpass pool; NULL for unused lines */
+    int size;                   /* Ring length in samples */
+    int index;
+
+    float mod_phase;
+    float delay_value;          /* Modulated delay reached at the end of the last rendered sample */
+    float delay_step;           /* Per-sample ramp increment within the current segment */
+    int segment_left;           /* Samples remaining before the next control update */
+    int update_rate;            /* Control update period in samples (CPU/quality trade-off) */
+    float update_rate_inv;
+    float smooth_factor;        /* Per-segment delay smoothing, derived from update_rate */
+
+    int sample_delay;           /* Current delay (integer for read index) */
+    float sample_delay_current; /* Smoothed delay (float for interpolation) */
+    int sample_delay_target;    /* Target delay for smoothing */
+    float mod_amount;
+    float mod_rate;
+    int interpolation_enabled;
+    int modulation_enabled;
+    int silent_run;             /* Consecutive near-zero samples written to the buffer */
+} mod_allpass_t;
+
+/* Fills dst[0..n) with a linear ramp start + step * (i + 1); no branches, vectorizes */
+static inline void ramp_fill(float *dst, float start, float step, int n) {
+    for (int i = 0; i < n; i++)
+        dst[i] = start + step * (float)(i + 1);
+}
+
+static float mod_smooth_factor(int update_rate) {
+    return 1.0f - fast_powf(1.0f - DELAY_SMOOTH_COEFF, (float)update_rate);
+}
+
+static float mod_allpass_total_delay(mod_allpass_t *ap) {
+    float mod = fast_sin2pi(ap->mod_phase);
+
+    float mod_amt = ap->mod_amount;
+    if (mod_amt >= ap->sample_delay_current)
+        mod_amt = ap->sample_delay_current - 1.0f;
+
+    float total_delay = ap->sample_delay_current + mod_amt * mod;
+    if (total_delay <= 0.0f)
+        total_delay = 1.0f;
+    return total_delay;
+}
+
+static void mod_allpass_update(mod_allpass_t *ap) {
+    /* Smooth delay toward target and advance the LFO to the end of the next segment */
+    float target = (float)ap->sample_delay_target;
+    ap->sample_delay_current += (target - ap->sample_delay_current) * ap->smooth_factor;
+    ap->sample_delay = (int)ap->sample_delay_current;
+
+    ap->mod_phase += ap->mod_rate * ap->update_rate;
+    if (ap->mod_phase > 1.0f)
+        ap->mod_phase = fmodf(ap->mod_phase, 1.0f);
+
+    /* Ramp linearly from the current delay to the segment end point */
+    float total_delay = mod_allpass_total_delay(ap);
+    ap->delay_step = (total_delay - ap->delay_value) * ap->update_rate_inv;
+    ap->segment_left = ap->update_rate;
+}
+
+static void mod_allpass_set_update_rate(mod_allpass_t *ap, int rate) {
+    ap->update_rate = rate;
+    ap->update_rate_inv = 1.0f / (float)rate;
+    ap->smooth_factor = mod_smooth_factor(rate);
+    if (ap->segment_left > rate)
+        ap->segment_left = rate;
+}
+
+/* Builds the per-sample fractional delay control vector for one block */
+static void mod_allpass_render_delays(mod_allpass_t *ap, float *delay, int count) {
+    int i = 0;
+    while (i < count) {
+        if (ap->segment_left == 0)
+            mod_allpass_update(ap);
+
+        int n = count - i;
+        if (n > ap->segment_left) n = ap->segment_left;
+
+        ramp_fill(delay + i, ap->delay_value, ap->delay_step, n);
+        ap->delay_value += ap->delay_step * (float)n;
+        ap->segment_left -= n;
+        i += n;
+    }
+}
+
+/* buffer must be zeroed (see engine_alloc) */
+static void mod_allpass_init(mod_allpass_t *ap, float *buffer, int size) {
+    ap->buffer = buffer;
+    ap->size = size;
+    ap->index = size > 0 ? size - 1 : 0;
+
+    ap->mod_phase = 0.01f + 0.98f * ((float)rand() / (float)RAND_MAX);
+    ap->delay_step = 0.0f;
+    ap->segment_left = 0;
+    mod_allpass_set_update_rate(ap, MODULATION_UPDATE_RATE);
+
+    ap->sample_delay = 100;
+    ap->sample_delay_current = 100.0f;
+    ap->sample_delay_target = 100;
+    ap->mod_amount = 0.0f;
+    ap->mod_rate = 0.0f;
+    ap->interpolation_enabled = 1;
+    ap->modulation_enabled = 1;
+    ap->silent_run = SILENT_RUN_MAX;
+
+    ap->delay_value = mod_allpass_total_delay(ap);
+}
+
+static void mod_allpass_process_no_mod(mod_allpass_t *ap, float fb, float *input, float *output, int count) {
+    for (int i = 0; i < count; i++) {
+        /* Smooth delay toward target */
+        float target = (float)ap->sample_delay_target;
+        ap->sample_delay_current += (target - ap->sample_delay_current) * DELAY_SMOOTH_COEFF;
+        ap->sample_delay = (int)ap->sample_delay_current;
+
+        /* Interpolated read for smooth transitions */
+        float frac = ap->sample_delay_current - (float)ap->sample_delay;
+        int idx_a = ap->index - ap->sample_delay;
+        int idx_b = idx_a - 1;
+        if (idx_a < 0) idx_a += ap->size;
+        if (idx_b < 0) idx_b += ap->size;
+
+        float buf_out = ap->buffer[idx_a] * (1.0f - frac) + ap->buffer[idx_b] * frac;
+        float in_val = input[i] + buf_out * fb;
+
+        ap->buffer[ap->index] = in_val;
+        output[i] = buf_out - in_val * fb;
+
+        ap->index++;
+        if (ap->index >= ap->size) ap->index -= ap->size;
+    }
+
+    /* Keep the modulated path continuous if modulation is re-enabled */
+    ap->delay_value = ap->sample_delay_current;
+    ap->segment_left = 0;
+}
+
+static void mod_allpass_process_with_mod(mod_allpass_t *ap, float fb, float *input, float *output, int count) {
+    float delay[BUFFER_SIZE];
+    mod_allpass_render_delays(ap, delay, count);
+
+    float *buf = ap->buffer;
+    int size = ap->size;
+    int index = ap->index;
+
+    if (ap->interpolation_enabled) {
+        index = g_kernels->allpass_process(buf, size, index, fb,
+                                           delay, input, output, count);
+    } else {
+        for (int i = 0; i < count; i++) {
+            int idx_a = index - (int)delay[i];
+            if (idx_a < 0) idx_a += size;
+
+            float buf_out = buf[idx_a];
+            float in_val = input[i] + buf_out * fb;
+            buf[index] = in_val;
+            output[i] = buf_out - in_val * fb;
+
+            index++;
+            if (index >= size) index = 0;
+        }
+    }
+
+    ap->index = index;
+}
+
+/* Furthest back a read can reach during the next block */
+static int mod_allpass_reach(mod_allpass_t *ap) {
+    float delay = fmaxf(ap->sample_delay_current, (float)ap->sample_delay_target);
+    return (int)(delay + fabsf(ap->mod_amount)) + 2;
+}
+
+/* Prefetches the block's read window; idle stages have nothing worth fetching */
+static void mod_allpass_prefetch(mod_allpass_t *ap, int count) {
+    if (ap->silent_run >= mod_allpass_reach(ap))
+        return;
+    int start = ap->index - (int)ap->delay_value - 1;
+    prefetch_ring(ap->buffer, ap->size, start, count);
+}
+
+/* Idle stage: advance delay smoothing and the LFO, write zeros, skip the reads */
+static void mod_allpass_skip(mod_allpass_t *ap, int count) {
+    if (ap->modulation_enabled) {
+        float delay[BUFFER_SIZE];
+        mod_allpass_render_delays(ap, delay, count);
+    } else {
+        float target = (float)ap->sample_delay_target;
+        for (int i = 0; i < count; i++)
+            ap->sample_delay_current += (target - ap->sample_delay_current) * DELAY_SMOOTH_COEFF;
+        ap->sample_delay = (int)ap->sample_delay_current;
+        ap->delay_value = ap->sample_delay_current;
+        ap->segment_left = 0;
+    }
+
+    ring_zero(ap->buffer, ap->size, ap->index, count);
+    ap->index += count;
+    if (ap->index >= ap->size) ap->index -= ap->size;
+}
+
+/* fb is the diffuser's, shared by its stages. Returns 1 if the stage was idle and output is all zeros */
+static int mod_allpass_process(mod_allpass_t *ap, float fb, float *input, float *output, int count) {
+    int start = ap->index;
+    int input_last = block_last_active(input, count);
+
+    if (input_last < 0 && ap->silent_run >= mod_allpass_reach(ap)) {
+        mod_allpass_skip(ap, count);
+        memset(output, 0, count * sizeof(float));
+        ap->silent_run = silent_run_extend(ap->silent_run, -1, count);
+        return 1;
+    }
+
+    if (ap->modulation_enabled)
+        mod_allpass_process_with_mod(ap, fb, input, output, count);
+    else
+        mod_allpass_process_no_mod(ap, fb, input, output, count);
+
+    int last = ring_last_active(ap->buffer, ap->size, start, count);
+    ap->silent_run = silent_run_extend(ap->silent_run, last, count);
+    return 0;
+}
+
+/* Jumps to the target delay; only for an empty buffer, where there is nothing to glide over */
+static void mod_allpass_snap(mod_allpass_t *ap) {
+    ap->sample_delay_current = (float)ap->sample_delay_target;
+    ap->sample_delay = ap->sample_delay_target;
+    ap->delay_value = mod_allpass_total_delay(ap);
+    ap->segment_left = 0;
+}
+
+static void mod_allpass_clear(mod_allpass_t *ap) {
+    if (ap->buffer)
+        memset(ap->buffer, 0, ap->size * sizeof(float));
+    ap->silent_run = SILENT_RUN_MAX;
+}
+
+/* ============================================================================
+ * ALLPASS DIFFUSER - Exact port from AllpassDiffuser.h
+ * ============================================================================ */
+
+typedef struct {
+    mod_allpass_t filters[MAX_DIFFUSER_STAGES];
+    float feedback;             /* Every stage's */
+    int delay;
+    float mod_rate;
+    float seed_values[MAX_DIFFUSER_STAGES * 3];
+    int seed;
+    float cross_seed;
+    int stages;
+    int samplerate;
+} allpass_diffuser_t;
+
+static void diffuser_update(allpass_diffuser_t *d) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        float r = d->seed_values[i];
+        float scale = fast_exp10f(r) * 0.1f;  /* 0.1 to 1.0 */
+        int target = (int)(d->delay * scale);
+        if (target < 1) target = 1;
+        d->filters[i].sample_delay_target = target;
+    }
+}
+
+static void diffuser_update_seeds(allpass_diffuser_t *d) {
+    random_buffer_generate_cross(d->seed, d->cross_seed,
+                                  d->seed_values, MAX_DIFFUSER_STAGES * 3);
+    diffuser_update(d);
+}
+
+/* Forward declarations */
+static void diffuser_set_mod_rate(allpass_diffuser_t *d, float rate);
+
+/* pool holds MAX_DIFFUSER_STAGES rings of stage_size samples, or is NULL */
+static void diffuser_init(allpass_diffuser_t *d, int samplerate, float *pool, int stage_size) {
+    d->samplerate = samplerate;
+    d->cross_seed = 0.0f;
+    d->seed = 23456;
+    d->stages = 1;
+    d->feedback = 0.5f;
+    d->delay = 100;
+    d->mod_rate = 0.0f;
+
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        if (pool)
+            mod_allpass_init(&d->filters[i], pool + (size_t)i * stage_size, stage_size);
+        else
+            mod_allpass_init(&d->filters[i], NULL, 0);
+    }
+
+    diffuser_update_seeds(d);
+}
+
+static void diffuser_set_samplerate(allpass_diffuser_t *d, int samplerate) {
+    d->samplerate = samplerate;
+    diffuser_set_mod_rate(d, d->mod_rate);
+}
+
+static void diffuser_set_seed(allpass_diffuser_t *d, int seed) {
+    d->seed = seed;
+    diffuser_update_seeds(d);
+}
+
+static void diffuser_set_cross_seed(allpass_diffuser_t *d, float cross_seed) {
+    d->cross_seed = cross_seed;
+    diffuser_update_seeds(d);
+}
+
+static void diffuser_set_interpolation(allpass_diffuser_t *d, int enabled) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++)
+        d->filters[i].interpolation_enabled = enabled;
+}
+
+static void diffuser_set_modulation(allpass_diffuser_t *d, int enabled) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++)
+        d->filters[i].modulation_enabled = enabled;
+}
+
+static void diffuser_set_mod_update_rate(allpass_diffuser_t *d, int rate) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++)
+        mod_allpass_set_update_rate(&d->filters[i], rate);
+}
+
+static void diffuser_set_delay(allpass_diffuser_t *d, int samples) {
+    d->delay = samples;
+    diffuser_update(d);
+}
+
+static void diffuser_set_feedback(allpass_diffuser_t *d, float fb) {
+    d->feedback = fb;
+}
+
+static void diffuser_set_mod_amount(allpass_diffuser_t *d, float amount) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        float scale = 0.85f + 0.3f * d->seed_values[MAX_DIFFUSER_STAGES + i];
+        d->filters[i].mod_amount = amount * scale;
+    }
+}
+
+static void diffuser_set_mod_rate(allpass_diffuser_t *d, float rate) {
+    d->mod_rate = rate;
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        float scale = 0.85f + 0.3f * d->seed_values[MAX_DIFFUSER_STAGES * 2 + i];
+        d->filters[i].mod_rate = rate * scale / d->samplerate;
+    }
+}
+
+/* Returns 1 if the last stage was idle and output is all zeros */
+static int diffuser_process(allpass_diffuser_t *d, float *input, float *output, int count) {
+    float temp[BUFFER_SIZE];
+
+    int idle = mod_allpass_process(&d->filters[0], d->feedback, input, temp, count);
+    for (int i = 1; i < d->stages; i++)
+        idle = mod_allpass_process(&d->filters[i], d->feedback, temp, temp, count);
+
+    memcpy(output, temp, count * sizeof(float));
+    return idle;
+}
+
+static void diffuser_prefetch(allpass_diffuser_t *d, int count) {
+    for (int i = 0; i < d->stages; i++)
+        mod_allpass_prefetch(&d->filters[i], count);
+}
+
+static void diffuser_clear(allpass_diffuser_t *d) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++)
+        mod_allpass_clear(&d->filters[i]);
+}
+
+static void diffuser_snap(allpass_diffuser_t *d) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++)
+        mod_allpass_snap(&d->filters[i]);
+}
+
+/* Buffers were zeroed externally (lazy clear): let every stage gate at once */
+static void diffuser_mark_silent(allpass_diffuser_t *d) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++)
+        d->filters[i].silent_run = SILENT_RUN_MAX;
+}
+
+/* ============================================================================
+ * MODULATED DELAY - Exact port from ModulatedDelay.h
+ * ============================================================================ */
+
+typedef struct {
+    float *buffer;  /* Dynamically allocated; NULL for unused lines */
+    int size;       /* Ring length in samples */
+    int write_index;
+
+    float mod_phase;
+    float delay_value;          /* Modulated delay reached at the end of the last rendered sample */
+    float delay_step;           /* Per-sample ramp increment within the current segment */
+    int segment_left;           /* Samples remaining before the next control update */
+    int update_rate;            /* Control update period in samples (CPU/quality trade-off) */
+    float update_rate_inv;
+    float smooth_factor;        /* Per-segment delay smoothing, derived from update_rate */
+
+    int sample_delay;           /* Current delay (integer for read index) */
+    float sample_delay_current; /* Smoothed delay (float for interpolation) */
+    int sample_delay_target;    /* Target delay for smoothing */
+    float mod_amount;
+    float mod_rate;
+    int silent_run;             /* Consecutive near-zero samples written to the buffer */
+} mod_delay_t;
+
+static float mod_delay_total_delay(mod_delay_t *d) {
+    float mod = fast_sin2pi(d->mod_phase);
+    return d->sample_delay_current + d->mod_amount * mod;
+}
+
+static void mod_delay_update(mod_delay_t *d) {
+    /* Smooth delay toward target and advance the LFO to the end of the next segment */
+    float target = (float)d->sample_delay_target;
+    d->sample_delay_current += (target - d->sample_delay_current) * d->smooth_factor;
+    d->sample_delay = (int)d->sample_delay_current;
+
+    d->mod_phase += d->mod_rate * d->update_rate;
+    if (d->mod_phase > 1.0f)
+        d->mod_phase = fmodf(d->mod_phase, 1.0f);
+
+    /* Ramp linearly from the current delay to the segment end point */
+    float total_delay = mod_delay_total_delay(d);
+    d->delay_step = (total_delay - d->delay_value) * d->update_rate_inv;
+    d->segment_left = d->update_rate;
+}
+
+static void mod_delay_set_update_rate(mod_delay_t *d, int rate) {
+    d->update_rate = rate;
+    d->update_rate_inv = 1.0f / (float)rate;
+    d->smooth_factor = mod_smooth_factor(rate);
+    if (d->segment_left > rate)
+        d->segment_left = rate;
+}
+
+/* Builds the per-sample fractional delay control vector for one block */
+static void mod_delay_render_delays(mod_delay_t *d, float *delay, int count) {
+    int i = 0;
+    while (i < count) {
+        if (d->segment_left == 0)
+            mod_delay_update(d);
+
+        int n = count - i;
+        if (n > d->segment_left) n = d->segment_left;
+
+        ramp_fill(delay + i, d->delay_value, d->delay_step, n);
+        d->delay_value += d->delay_step * (float)n;
+        d->segment_left -= n;
+        i += n;
+    }
+}
+
+/* size 0 leaves the delay without a buffer; it must then never be processed */
+static void mod_delay_init(mod_delay_t *d, int size, engine_allocator_t *alloc) {
+    d->buffer = size > 0 ? (float*)engine_alloc(alloc, CLOUDSEED_MEM_DELAY, size * sizeof(float)) : NULL;
+    d->size = d->buffer ? size : 0;
+    d->write_index = 0;
+
+    d->mod_phase = 0.01f + 0.98f * ((float)rand() / (float)RAND_MAX);
+    d->delay_step = 0.0f;
+    d->segment_left = 0;
+    mod_delay_set_update_rate(d, MODULATION_UPDATE_RATE);
+
+    d->sample_delay = 100;
+    d->sample_delay_current = 100.0f;
+    d->sample_delay_target = 100;
+    d->mod_amount = 0.0f;
+    d->mod_rate = 0.0f;
+    d->silent_run = SILENT_RUN_MAX;
+
+    d->delay_value = mod_delay_total_delay(d);
+}
+
+static void mod_delay_free(mod_delay_t *d, engine_allocator_t *alloc) {
+    if (d->buffer) {
+        engine_free(alloc, d->buffer);
+        d->buffer = NULL;
+    }
+}
+
+/* Furthest back a read can reach during the next block */
+static int mod_delay_reach(mod_delay_t *d) {
+    float delay = fmaxf(d->sample_delay_current, (float)d->sample_delay_target);
+    return (int)(delay + fabsf(d->mod_amount)) + 2;
+}
+
+/* Prefetches the block's read window; idle delays have nothing worth fetching */
+static void mod_delay_prefetch(mod_delay_t *d, int count) {
+    if (d->silent_run >= mod_delay_reach(d))
+        return;
+    int start = d->write_index - (int)d->delay_value - 1;
+    prefetch_ring(d->buffer, d->size, start, count);
+}
+
+/* Returns 1 if the delay was idle and output is all zeros */
+static int mod_delay_process(mod_delay_t *d, float *input, float *output, int count) {
+    float delay[BUFFER_SIZE];
+    mod_delay_render_delays(d, delay, count);
+
+    int input_last = block_last_active(input, count);
+    if (input_last < 0 && d->silent_run >= mod_delay_reach(d)) {
+        ring_zero(d->buffer, d->size, d->write_index, count);
+        d->write_index += count;
+        if (d->write_index >= d->size) d->write_index -= d->size;
+        memset(output, 0, count * sizeof(float));
+        d->silent_run = silent_run_extend(d->silent_run, -1, count);
+        return 1;
+    }
+    d->silent_run = silent_run_extend(d->silent_run, input_last, count);
+
+    d->write_index = g_kernels->delay_process(d->buffer, d->size, d->write_index,
+                                              delay, input, output, count);
+    return 0;
+}
+
+/* Jumps to the target delay; only for an empty buffer, where there is nothing to glide over */
+static void mod_delay_snap(mod_delay_t *d) {
+    d->sample_delay_current = (float)d->sample_delay_target;
+    d->sample_delay = d->sample_delay_target;
+    d->delay_value = mod_delay_total_delay(d);
+    d->segment_left = 0;
+}
+
+static void mod_delay_clear(mod_delay_t *d) {
+    if (d->buffer)
+        memset(d->buffer, 0, d->size * sizeof(float));
+    d->silent_run = SILENT_RUN_MAX;
+}
+
+/* ============================================================================
+ * MULTITAP DELAY - Exact port from MultitapDelay.h
+ * ============================================================================ */
+
+typedef struct {
+    float *buffer;  /* Dynamically allocated */
+    int size;       /* Ring length in samples */
+    float tap_gains[MAX_TAPS];
+    float tap_position[MAX_TAPS];
+    float seed_values[MAX_TAPS * 3];
+
+    int write_idx;
+    int seed;
+    float cross_seed;
+    int count;
+    float length_samples;
+    float decay;
+    int silent_run;             /* Consecutive near-zero samples written to the buffer */
+    unsigned pattern_gen;       /* Bumped whenever the tap pattern may have changed */
+} multitap_delay_t;
+
+static void multitap_update(multitap_delay_t *mt) {
+    int s = 0;
+    for (int i = 0; i < MAX_TAPS; i++) {
+        float phase = mt->seed_values[s++] < 0.5f ? 1.0f : -1.0f;
+        mt->tap_gains[i] = db2gain(-20.0f + mt->seed_values[s++] * 20.0f) * phase;
+        mt->tap_position[i] = i + mt->seed_values[s++];
+    }
+    mt->pattern_gen++;
+}
+
+static void multitap_update_seeds(multitap_delay_t *mt) {
+    random_buffer_generate_cross(mt->seed, mt->cross_seed,
+                                  mt->seed_values, MAX_TAPS * 3);
+    multitap_update(mt);
+}
+
+static void multitap_init(multitap_delay_t *mt, int size, engine_allocator_t *alloc) {
+    mt->buffer = (float*)engine_alloc(alloc, CLOUDSEED_MEM_MULTITAP, size * sizeof(float));
+    mt->size = mt->buffer ? size : 0;
+    mt->write_idx = 0;
+    mt->seed = 0;
+    mt->cross_seed = 0.0f;
+    mt->count = 1;
+    mt->length_samples = 1000.0f;
+    mt->decay = 1.0f;
+    mt->silent_run = SILENT_RUN_MAX;
+
+    multitap_update_seeds(mt);
+}
+
+static void multitap_free(multitap_delay_t *mt, engine_allocator_t *alloc) {
+    if (mt->buffer) {
+        engine_free(alloc, mt->buffer);
+        mt->buffer = NULL;
+    }
+}
+
+static void multitap_set_seed(multitap_delay_t *mt, int seed) {
+    mt->seed = seed;
+    multitap_update_seeds(mt);
+}
+
+static void multitap_set_cross_seed(multitap_delay_t *mt, float cross_seed) {
+    mt->cross_seed = cross_seed;
+    multitap_update_seeds(mt);
+}
+
+static void multitap_set_tap_count(multitap_delay_t *mt, int count) {
+    if (count < 1) count = 1;
+    if (count > MAX_TAPS) count = MAX_TAPS;
+    mt->count = count;
+    multitap_update(mt);
+}
+
+static void multitap_set_tap_length(multitap_delay_t *mt, int samples) {
+    if (samples > mt->size - 2) samples = mt->size - 2;
+    if (samples < 10) samples = 10;
+    mt->length_samples = (float)samples;
+    multitap_update(mt);
+}
+
+static void multitap_set_tap_decay(multitap_delay_t *mt, float decay) {
+    mt->decay = decay;
+    mt->pattern_gen++;
+}
+
+/* Ring offset and gain of each of the count taps */
+static void multitap_pattern(const multitap_delay_t *mt, int *offsets, float *gains) {
+    float length_scaler = mt->length_samples / (float)mt->count;
+    float total_gain = 3.0f / sqrtf(1.0f + mt->count);
+    total_gain *= (1.0f + mt->decay * 2.0f);
+
+    for (int j = 0; j < mt->count; j++) {
+        float offset = mt->tap_position[j] * length_scaler;
+        float decay_effective = fast_expf(-offset / mt->length_samples * 3.3f) * mt->decay
+                               + (1.0f - mt->decay);
+        offsets[j] = (int)offset;
+        gains[j] = mt->tap_gains[j] * decay_effective * total_gain;
+    }
+}
+
+static void multitap_process(multitap_delay_t *mt, float *input, float *output, int count) {
+    /* Idle: every tap would read zeros */
+    int input_last = block_last_active(input, count);
+    if (input_last < 0 && mt->silent_run >= (int)mt->length_samples + 2) {
+        ring_zero(mt->buffer, mt->size, mt->write_idx, count);
+        mt->write_idx = (mt->write_idx + count) % mt->size;
+        memset(output, 0, count * sizeof(float));
+        mt->silent_run = silent_run_extend(mt->silent_run, -1, count);
+        return;
+    }
+    mt->silent_run = silent_run_extend(mt->silent_run, input_last, count);
+
+    /* Tap offsets and gains only change between blocks */
+    int tap_offset[MAX_TAPS];
+    float tap_gain[MAX_TAPS];
+    multitap_pattern(mt, tap_offset, tap_gain);
+
+    for (int i = 0; i < count; i++) {
+        mt->buffer[mt->write_idx] = input[i];
+
+        float sum = 0.0f;
+        for (int j = 0; j < mt->count; j++) {
+            int read_idx = mt->write_idx - tap_offset[j];
+            if (read_idx < 0) read_idx += mt->size;
+            sum += mt->buffer[read_idx] * tap_gain[j];
+        }
+        output[i] = sum;
+
+        mt->write_idx = (mt->write_idx + 1) % mt->size;
+    }
+}
+
+static void multitap_clear(multitap_delay_t *mt) {
+    if (mt->buffer)
+        memset(mt->buffer, 0, mt->size * sizeof(float));
+    mt->silent_run = SILENT_RUN_MAX;
+}
+
+/* ============================================================================
+ * VELVET NOISE - Sparse early reflections on the multitap's ring and pattern
+ * ============================================================================ */
+
+/*
+ * The multitap's seeded tap positions and signs with every gain set to
+ * +-1, so a tap costs one add or subtract. Taps are grouped into
+ * VELVET_SEGMENTS runs along the pattern, positives then negatives, and
+ * one gain per segment carries the decay envelope and the RMS of the
+ * random tap gains it replaces, keeping the multitap's level.
+ */
+typedef struct {
+    int offsets[MAX_TAPS];
+    int segment_start[VELVET_SEGMENTS + 1];
+    int segment_split[VELVET_SEGMENTS];     /* First negative tap of a segment */
+    float segment_gain[VELVET_SEGMENTS];
+    int stale;                              /* Multitap pattern changed since the last build */
+} velvet_taps_t;
+
+/* Rebuilds from the multitap's pattern; rerun whenever its seeds, count or length change */
+static void velvet_build(velvet_taps_t *v, const multitap_delay_t *mt) {
+    float length_scaler = mt->length_samples / (float)mt->count;
+    float total_gain = 3.0f / sqrtf(1.0f + mt->count) * (1.0f + mt->decay * 2.0f);
+
+    /* The block is written before it is read, so taps stay a block short of the ring */
+    int limit = mt->size - BUFFER_SIZE;
+    if (limit < 0) limit = 0;
+
+    int n = 0;
+    for (int s = 0; s < VELVET_SEGMENTS; s++) {
+        int first = s * mt->count / VELVET_SEGMENTS;
+        int last = (s + 1) * mt->count / VELVET_SEGMENTS;
+
+        float power = 0.0f;
+        for (int j = first; j < last; j++)
+            power += mt->tap_gains[j] * mt->tap_gains[j];
+        float rms = last > first ? sqrtf(power / (float)(last - first)) : 0.0f;
+
+        v->segment_start[s] = n;
+        for (int negative = 0; negative < 2; negative++) {
+            if (negative)
+                v->segment_split[s] = n;
+            for (int j = first; j < last; j++) {
+                if ((mt->tap_gains[j] < 0.0f) != negative)
+                    continue;
+                int offset = (int)(mt->tap_position[j] * length_scaler);
+                v->offsets[n++] = offset < limit ? offset : limit;
+            }
+        }
+
+        /* Envelope at the segment's middle, the curve multitap_process weighs each tap by */
+        float middle = (first + last) * 0.5f * length_scaler;
+        v->segment_gain[s] = (fast_expf(-middle / mt->length_samples * 3.3f) * mt->decay
+                              + (1.0f - mt->decay)) * rms * total_gain;
+    }
+    v->segment_start[VELVET_SEGMENTS] = n;
+    v->stale = 0;
+}
+
+static inline void velvet_add(float *acc, const float *ring, int size, int start, int count) {
+    int first = size - start;
+    if (first > count) first = count;
+    for (int i = 0; i < first; i++)
+        acc[i] += ring[start + i];
+    for (int i = first; i < count; i++)
+        acc[i] += ring[i - first];
+}
+
+static inline void velvet_sub(float *acc, const float *ring, int size, int start, int count) {
+    int first = size - start;
+    if (first > count) first = count;
+    for (int i = 0; i < first; i++)
+        acc[i] -= ring[start + i];
+    for (int i = first; i < count; i++)
+        acc[i] -= ring[i - first];
+}
+
+/* Same ring, silence tracking and output level as multitap_process */
+static void velvet_process(const velvet_taps_t *v, multitap_delay_t *mt,
+                           float *input, float *output, int count) {
+    int input_last = block_last_active(input, count);
+    if (input_last < 0 && mt->silent_run >= (int)mt->length_samples + 2) {
+        ring_zero(mt->buffer, mt->size, mt->write_idx, count);
+        mt->write_idx = (mt->write_idx + count) % mt->size;
+        memset(output, 0, count * sizeof(float));
+        mt->silent_run = silent_run_extend(mt->silent_run, -1, count);
+        return;
+    }
+    mt->silent_run = silent_run_extend(mt->silent_run, input_last, count);
+
+    /* Whole block in first; each tap then reads one contiguous span */
+    int base = mt->write_idx;
+    ring_copy(mt->buffer, mt->size, base, input, count, 0, count);
+    mt->write_idx = (base + count) % mt->size;
+
+    float segment[BUFFER_SIZE];
+    memset(output, 0, count * sizeof(float));
+    for (int s = 0; s < VELVET_SEGMENTS; s++) {
+        int first = v->segment_start[s];
+        int split = v->segment_split[s];
+        int last = v->segment_start[s + 1];
+        if (first == last)
+            continue;
+
+        memset(segment, 0, count * sizeof(float));
+        for (int j = first; j < split; j++) {
+            int start = base - v->offsets[j];
+            velvet_add(segment, mt->buffer, mt->size, start < 0 ? start + mt->size : start, count);
+        }
+        for (int j = split; j < last; j++) {
+            int start = base - v->offsets[j];
+            velvet_sub(segment, mt->buffer, mt->size, start < 0 ? start + mt->size : start, count);
+        }
+
+        float gain = v->segment_gain[s];
+        for (int i = 0; i < count; i++)
+            output[i] += segment[i] * gain;
+    }
+}
+
+/* ============================================================================
+ * FFT - Real transforms for the multitap's partitioned convolution
+ * ============================================================================ */
+
+/*
+ * A real frame of 2 * CONV_BLOCK samples goes through one complex
+ * CONV_BLOCK-point transform, even samples as real and odd as imaginary,
+ * and a split pass that pulls the two halves apart into CONV_BINS bins.
+ */
+typedef struct {
+    float twiddle_re[CONV_BLOCK / 2];   /* e^(-2 pi i k / CONV_BLOCK) */
+    float twiddle_im[CONV_BLOCK / 2];
+    float split_re[CONV_BLOCK];         /* e^(-pi i k / CONV_BLOCK) */
+    float split_im[CONV_BLOCK];
+    uint16_t bit_reverse[CONV_BLOCK];
+} fft_tables_t;
+
+static fft_tables_t g_fft_tables;
+
+static void fft_tables_init(fft_tables_t *t) {
+    int bits = 0;
+    while ((1 << bits) < CONV_BLOCK)
+        bits++;
+
+    for (int i = 0; i < CONV_BLOCK; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b))
+                r |= 1 << (bits - 1 - b);
+        }
+        t->bit_reverse[i] = (uint16_t)r;
+        t->split_re[i] = (float)cos(-M_PI * i / CONV_BLOCK);
+        t->split_im[i] = (float)sin(-M_PI * i / CONV_BLOCK);
+    }
+    for (int i = 0; i < CONV_BLOCK / 2; i++) {
+        t->twiddle_re[i] = (float)cos(-2.0 * M_PI * i / CONV_BLOCK);
+        t->twiddle_im[i] = (float)sin(-2.0 * M_PI * i / CONV_BLOCK);
+    }
+}
+
+/* In-place radix-2 transform of CONV_BLOCK points; the inverse is unscaled */
+static void fft_complex(const fft_tables_t *t, float *re, float *im, int inverse) {
+    for (int i = 0; i < CONV_BLOCK; i++) {
+        int j = t->bit_reverse[i];
+        if (j > i) {
+            float r = re[i], m = im[i];
+            re[i] = re[j];
+            im[i] = im[j];
+            re[j] = r;
+            im[j] = m;
+        }
+    }
+
+    float sign = inverse ? -1.0f : 1.0f;
+    for (int half = 1; half < CONV_BLOCK; half <<= 1) {
+        int stride = CONV_BLOCK / (2 * half);
+        for (int start = 0; start < CONV_BLOCK; start += 2 * half) {
+            for (int k = 0; k < half; k++) {
+                float wr = t->twiddle_re[k * stride];
+                float wi = t->twiddle_im[k * stride] * sign;
+                int a = start + k;
+                int b = a + half;
+                float xr = re[b] * wr - im[b] * wi;
+                float xi = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - xr;
+                im[b] = im[a] - xi;
+                re[a] += xr;
+                im[a] += xi;
+            }
+        }
+    }
+}
+
+/* 2 * CONV_BLOCK real samples to CONV_BINS bins */
+static void fft_real_forward(const fft_tables_t *t, const float *x, float *out_re, float *out_im) {
+    float zr[CONV_BLOCK], zi[CONV_BLOCK];
+    for (int n = 0; n < CONV_BLOCK; n++) {
+        zr[n] = x[2 * n];
+        zi[n] = x[2 * n + 1];
+    }
+    fft_complex(t, zr, zi, 0);
+
+    out_re[0] = zr[0] + zi[0];
+    out_im[0] = 0.0f;
+    out_re[CONV_BLOCK] = zr[0] - zi[0];
+    out_im[CONV_BLOCK] = 0.0f;
+    for (int k = 1; k < CONV_BLOCK; k++) {
+        /* Even half (Z[k] + Z*[N-k]) / 2, odd half (Z[k] - Z*[N-k]) / 2i */
+        float br = zr[CONV_BLOCK - k], bi = -zi[CONV_BLOCK - k];
+        float er = 0.5f * (zr[k] + br), ei = 0.5f * (zi[k] + bi);
+        float odd_re = 0.5f * (zi[k] - bi), odd_im = -0.5f * (zr[k] - br);
+        float wr = t->split_re[k], wi = t->split_im[k];
+        out_re[k] = er + wr * odd_re - wi * odd_im;
+        out_im[k] = ei + wr * odd_im + wi * odd_re;
+    }
+}
+
+/* CONV_BINS bins back to 2 * CONV_BLOCK samples, scaled by CONV_BLOCK */
+static void fft_real_inverse(const fft_tables_t *t, const float *in_re, const float *in_im, float *x) {
+    float zr[CONV_BLOCK], zi[CONV_BLOCK];
+    for (int k = 0; k < CONV_BLOCK; k++) {
+        float br = in_re[CONV_BLOCK - k], bi = -in_im[CONV_BLOCK - k];
+        float er = 0.5f * (in_re[k] + br), ei = 0.5f * (in_im[k] + bi);
+        float dr = 0.5f * (in_re[k] - br), di = 0.5f * (in_im[k] - bi);
+        float wr = t->split_re[k], wi = t->split_im[k];
+        float odd_re = dr * wr + di * wi, odd_im = di * wr - dr * wi;
+        zr[k] = er - odd_im;
+        zi[k] = ei + odd_re;
+    }
+    fft_complex(t, zr, zi, 1);
+
+    for (int n = 0; n < CONV_BLOCK; n++) {
+        x[2 * n] = zr[n];
+        x[2 * n + 1] = zi[n];
+    }
+}
+
+/* ============================================================================
+ * MULTITAP FFT PATH - Partitioned convolution of the tap pattern
+ * ============================================================================ */
+
+/*
+ * From CONV_MIN_TAPS taps the multitap is run as a convolution with its
+ * sparse impulse response, cut into CONV_BLOCK partitions. Taps in the
+ * first partition are summed from the ring as in velvet_process, so the
+ * path adds no latency; the later partitions are multiplied with the
+ * spectra of past input frames, once per CONV_BLOCK samples, at a cost
+ * set by the pattern length rather than the tap count.
+ *
+ * The tap spectra are built off the audio thread. The audio thread
+ * publishes the pattern it wants under want_seq (odd while it is
+ * writing), the engine worker builds it into the idle slot and sets
+ * ready_seq, and the next frame boundary makes that slot active. Until
+ * the active slot holds the wanted pattern and enough input frames have
+ * been seen since a restart, multitap_process runs instead; both give the
+ * same output to rounding.
+ */
+typedef struct {
+    int count;
+    int offsets[MAX_TAPS];
+    float gains[MAX_TAPS];
+} tap_pattern_t;
+
+typedef struct {
+    int usable;                 /* 0 if a tap lies past the last partition */
+    int partitions;             /* Up to the last partition holding a tap */
+    int head_count;             /* Taps in the first partition, summed from the ring */
+    int head_offsets[MAX_TAPS];
+    float head_gains[MAX_TAPS];
+    float re[CONV_PARTITIONS][CONV_BINS];   /* Partition spectra, scaled by 1 / CONV_BLOCK */
+    float im[CONV_PARTITIONS][CONV_BINS];
+} tap_spectra_t;
+
+typedef struct {
+    tap_pattern_t want;
+    uint32_t want_seq;
+    uint32_t ready_seq;         /* want_seq built into the idle slot */
+    uint32_t active_seq;        /* want_seq of slots[active] */
+    int active;
+    tap_spectra_t slots[2];
+    sem_t *wake;                /* Worker to post after publishing a pattern; NULL builds nothing */
+
+    /* Audio thread only */
+    unsigned pattern_gen;       /* multitap pattern_gen want was taken at */
+    int check_pattern;
+    int frames;                 /* Frames since the last restart; -1 restarts at the next block */
+    int fill;
+    int spectrum_idx;
+    int tail_valid;             /* tail holds the current frame's later partitions */
+    float frame[2 * CONV_BLOCK];                    /* Previous and current input frame */
+    float tail[CONV_BLOCK];
+    uint8_t spectrum_zero[CONV_PARTITIONS];
+    float in_re[CONV_PARTITIONS][CONV_BINS];        /* Spectra of the last input frames */
+    float in_im[CONV_PARTITIONS][CONV_BINS];
+} tap_conv_t;
+
+static void tap_conv_init(tap_conv_t *c, sem_t *wake) {
+    memset(c, 0, sizeof(*c));
+    c->wake = wake;
+    c->check_pattern = 1;
+    c->frames = -1;
+}
+
+/* Input history no longer follows the multitap's ring; also rechecks the pattern */
+static void tap_conv_reset(tap_conv_t *c) {
+    c->frames = -1;
+    c->check_pattern = 1;
+}
+
+static void tap_spectra_build(tap_spectra_t *s, const tap_pattern_t *p) {
+    int last = 0;
+    for (int j = 0; j < p->count; j++) {
+        if (p->offsets[j] > last)
+            last = p->offsets[j];
+    }
+    s->usable = last < CONV_PARTITIONS * CONV_BLOCK;
+    if (!s->usable)
+        return;
+    s->partitions = last / CONV_BLOCK + 1;
+
+    s->head_count = 0;
+    for (int j = 0; j < p->count; j++) {
+        if (p->offsets[j] < CONV_BLOCK) {
+            s->head_offsets[s->head_count] = p->offsets[j];
+            s->head_gains[s->head_count] = p->gains[j];
+            s->head_count++;
+        }
+    }
+
+    /* Partitions are zero-padded to a frame; the overlap-save output is the frame's second half */
+    float frame[2 * CONV_BLOCK];
+    for (int k = 1; k < s->partitions; k++) {
+        memset(frame, 0, sizeof(frame));
+        for (int j = 0; j < p->count; j++) {
+            int n = p->offsets[j] - k * CONV_BLOCK;
+            if (n >= 0 && n < CONV_BLOCK)
+                frame[n] += p->gains[j] * (1.0f / CONV_BLOCK);
+        }
+        fft_real_forward(&g_fft_tables, frame, s->re[k], s->im[k]);
+    }
+}
+
+/* Worker: builds the wanted pattern into the idle slot unless the last build is still waiting */
+static void tap_conv_build(tap_conv_t *c) {
+    uint32_t ready = __atomic_load_n(&c->ready_seq, __ATOMIC_ACQUIRE);
+    if (ready != __atomic_load_n(&c->active_seq, __ATOMIC_ACQUIRE))
+        return;
+
+    uint32_t seq = __atomic_load_n(&c->want_seq, __ATOMIC_ACQUIRE);
+    if ((seq & 1) || seq == ready)
+        return;
+    tap_pattern_t want;
+    memcpy(&want, &c->want, sizeof(want));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&c->want_seq, __ATOMIC_RELAXED) != seq)
+        return;
+
+    int idle = 1 - __atomic_load_n(&c->active, __ATOMIC_RELAXED);
+    tap_spectra_build(&c->slots[idle], &want);
+    __atomic_store_n(&c->ready_seq, seq, __ATOMIC_RELEASE);
+}
+
+/* Publishes the multitap's pattern for a build if it differs from the one wanted */
+static void tap_conv_watch(tap_conv_t *c, const multitap_delay_t *mt) {
+    c->pattern_gen = mt->pattern_gen;
+    c->check_pattern = 0;
+
+    tap_pattern_t p;
+    p.count = mt->count;
+    multitap_pattern(mt, p.offsets, p.gains);
+    if (c->want_seq && p.count == c->want.count &&
+        memcmp(p.offsets, c->want.offsets, p.count * sizeof(int)) == 0 &&
+        memcmp(p.gains, c->want.gains, p.count * sizeof(float)) == 0)
+        return;
+
+    uint32_t seq = c->want_seq;
+    __atomic_store_n(&c->want_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&c->want, &p, sizeof(p));
+    __atomic_store_n(&c->want_seq, seq + 2, __ATOMIC_RELEASE);
+    if (c->wake)
+        sem_post(c->wake);
+}
+
+static void tap_conv_restart(tap_conv_t *c) {
+    memset(c->frame, 0, sizeof(c->frame));
+    c->frames = 0;
+    c->fill = 0;
+    c->spectrum_idx = 0;
+    c->tail_valid = 0;
+}
+
+/* Frame boundary: transforms the finished frame, takes a finished build, computes the next tail */
+static void tap_conv_frame(tap_conv_t *c) {
+    int idx = c->spectrum_idx;
+    int active = 0;
+    for (int i = 0; i < 2 * CONV_BLOCK; i++)
+        active |= c->frame[i] != 0.0f;
+    c->spectrum_zero[idx] = !active;
+    if (active)
+        fft_real_forward(&g_fft_tables, c->frame, c->in_re[idx], c->in_im[idx]);
+
+    memcpy(c->frame, c->frame + CONV_BLOCK, CONV_BLOCK * sizeof(float));
+    c->fill = 0;
+    c->spectrum_idx = (idx + 1) % CONV_PARTITIONS;
+    if (c->frames < CONV_PARTITIONS)
+        c->frames++;
+
+    uint32_t ready = __atomic_load_n(&c->ready_seq, __ATOMIC_ACQUIRE);
+    if (ready != c->active_seq) {
+        __atomic_store_n(&c->active, 1 - c->active, __ATOMIC_RELAXED);
+        __atomic_store_n(&c->active_seq, ready, __ATOMIC_RELEASE);
+        if (c->want_seq != ready && c->wake)
+            sem_post(c->wake);
+    }
+
+    const tap_spectra_t *s = &c->slots[c->active];
+    c->tail_valid = c->active_seq == c->want_seq && s->usable && c->frames >= s->partitions;
+    if (!c->tail_valid)
+        return;
+
+    /* Partition k meets the frame k - 1 frames before the one just finished */
+    float yr[CONV_BINS], yi[CONV_BINS];
+    int terms = 0;
+    memset(yr, 0, sizeof(yr));
+    memset(yi, 0, sizeof(yi));
+    for (int k = 1; k < s->partitions; k++) {
+        int x = (idx - (k - 1) + CONV_PARTITIONS) % CONV_PARTITIONS;
+        if (c->spectrum_zero[x])
+            continue;
+        const float *xr = c->in_re[x], *xi = c->in_im[x];
+        const float *hr = s->re[k], *hi = s->im[k];
+        for (int b = 0; b < CONV_BINS; b++) {
+            yr[b] += xr[b] * hr[b] - xi[b] * hi[b];
+            yi[b] += xr[b] * hi[b] + xi[b] * hr[b];
+        }
+        terms++;
+    }
+
+    if (!terms) {
+        memset(c->tail, 0, sizeof(c->tail));
+        return;
+    }
+    float y[2 * CONV_BLOCK];
+    fft_real_inverse(&g_fft_tables, yr, yi, y);
+    memcpy(c->tail, y + CONV_BLOCK, sizeof(c->tail));
+}
+
+/* Appends count input samples (NULL: silence) to the frames; with out, adds each one's tail */
+static void tap_conv_feed(tap_conv_t *c, const float *input, float *out, int count) {
+    int done = 0;
+    while (done < count) {
+        int n = CONV_BLOCK - c->fill;
+        if (n > count - done) n = count - done;
+
+        float *frame = c->frame + CONV_BLOCK + c->fill;
+        if (input)
+            memcpy(frame, input + done, n * sizeof(float));
+        else
+            memset(frame, 0, n * sizeof(float));
+        if (out) {
+            const float *tail = c->tail + c->fill;
+            for (int i = 0; i < n; i++)
+                out[done + i] += tail[i];
+        }
+
+        c->fill += n;
+        done += n;
+        if (c->fill == CONV_BLOCK)
+            tap_conv_frame(c);
+    }
+}
+
+static inline void tap_conv_head(float *acc, const float *ring, int size, int start, int count,
+                                 float gain) {
+    int first = size - start;
+    if (first > count) first = count;
+    for (int i = 0; i < first; i++)
+        acc[i] += ring[start + i] * gain;
+    for (int i = first; i < count; i++)
+        acc[i] += ring[i - first] * gain;
+}
+
+/* Drop-in for multitap_process: same ring, silence tracking and output to rounding */
+static void tap_conv_process(tap_conv_t *c, multitap_delay_t *mt,
+                             float *input, float *output, int count) {
+    if (c->frames < 0)
+        tap_conv_restart(c);
+    if (c->check_pattern || c->pattern_gen != mt->pattern_gen)
+        tap_conv_watch(c, mt);
+
+    if (!c->tail_valid || c->active_seq != c->want_seq) {
+        float in[BUFFER_SIZE];
+        memcpy(in, input, count * sizeof(float));
+        int idle = mt->silent_run >= (int)mt->length_samples + 2 && block_last_active(in, count) < 0;
+        multitap_process(mt, input, output, count);
+        tap_conv_feed(c, idle ? NULL : in, NULL, count);
+        return;
+    }
+
+    int input_last = block_last_active(input, count);
+    if (input_last < 0 && mt->silent_run >= (int)mt->length_samples + 2) {
+        ring_zero(mt->buffer, mt->size, mt->write_idx, count);
+        mt->write_idx = (mt->write_idx + count) % mt->size;
+        memset(output, 0, count * sizeof(float));
+        mt->silent_run = silent_run_extend(mt->silent_run, -1, count);
+        tap_conv_feed(c, NULL, NULL, count);
+        return;
+    }
+    mt->silent_run = silent_run_extend(mt->silent_run, input_last, count);
+
+    int base = mt->write_idx;
+    ring_copy(mt->buffer, mt->size, base, input, count, 0, count);
+    mt->write_idx = (base + count) % mt->size;
+
+    const tap_spectra_t *s = &c->slots[c->active];
+    float wet[BUFFER_SIZE];
+    memset(wet, 0, count * sizeof(float));
+    for (int j = 0; j < s->head_count; j++) {
+        int start = base - s->head_offsets[j];
+        tap_conv_head(wet, mt->buffer, mt->size, start < 0 ? start + mt->size : start, count,
+                      s->head_gains[j]);
+    }
+    tap_conv_feed(c, input, wet, count);
+    memcpy(output, wet, count * sizeof(float));
+}
+
+/* ============================================================================
+ * CIRCULAR BUFFER - For feedback in delay lines
+ * ============================================================================ */
+
+typedef struct {
+    float buffer[BUFFER_SIZE * 2];
+    int idx_read;
+    int idx_write;
+    int count;
+} circular_buffer_t;
+
+static void circular_init(circular_buffer_t *cb) {
+    memset(cb->buffer, 0, sizeof(cb->buffer));
+    cb->idx_read = 0;
+    cb->idx_write = 0;
+    cb->count = 0;
+}
+
+static void circular_push(circular_buffer_t *cb, float *data, int size) {
+    for (int i = 0; i < size; i++) {
+        cb->buffer[cb->idx_write] = data[i];
+        cb->idx_write = (cb->idx_write + 1) % (BUFFER_SIZE * 2);
+        cb->count++;
+        if (cb->count >= BUFFER_SIZE * 2) break;
+    }
+}
+
+static void circular_pop(circular_buffer_t *cb, float *dest, int size) {
+    for (int i = 0; i < size; i++) {
+        if (cb->count > 0) {
+            dest[i] = cb->buffer[cb->idx_read];
+            cb->idx_read = (cb->idx_read + 1) % (BUFFER_SIZE * 2);
+            cb->count--;
+        } else {
+            dest[i] = 0.0f;
+        }
+    }
+}
+
+/* ============================================================================
+ * DELAY LINE - Exact port from DelayLine.h
+ * ============================================================================ */
+
+/* Filter coefficients every line of a channel shares; set once per change, not per line */
+typedef struct {
+    biquad_t low_shelf;
+    biquad_t high_shelf;
+    lp1_t low_pass;             /* Coefficients only; each line keeps its own output */
+    int low_shelf_enabled;
+    int high_shelf_enabled;
+    int cutoff_enabled;
+} line_filters_t;
+
+static void line_filters_init(line_filters_t *f, int samplerate) {
+    biquad_init(&f->low_shelf, BIQUAD_LOWSHELF, samplerate);
+    biquad_init(&f->high_shelf, BIQUAD_HIGHSHELF, samplerate);
+    lp1_init(&f->low_pass, samplerate);
+
+    biquad_set_gain_db(&f->low_shelf, -20.0f);
+    f->low_shelf.frequency = 20.0f;
+    biquad_update(&f->low_shelf);
+
+    biquad_set_gain_db(&f->high_shelf, -20.0f);
+    f->high_shelf.frequency = 19000.0f;
+    biquad_update(&f->high_shelf);
+
+    lp1_set_cutoff(&f->low_pass, 1000.0f);
+
+    f->low_shelf_enabled = 0;
+    f->high_shelf_enabled = 0;
+    f->cutoff_enabled = 0;
+}
+
+static void line_filters_set_samplerate(line_filters_t *f, int samplerate) {
+    lp1_set_samplerate(&f->low_pass, samplerate);
+    biquad_set_samplerate(&f->low_shelf, samplerate);
+    biquad_set_samplerate(&f->high_shelf, samplerate);
+}
+
+static void line_filters_set_low_shelf_gain(line_filters_t *f, float db) {
+    biquad_set_gain_db(&f->low_shelf, db);
+    biquad_update(&f->low_shelf);
+}
+
+static void line_filters_set_low_shelf_freq(line_filters_t *f, float freq) {
+    f->low_shelf.frequency = freq;
+    biquad_update(&f->low_shelf);
+}
+
+static void line_filters_set_high_shelf_gain(line_filters_t *f, float db) {
+    biquad_set_gain_db(&f->high_shelf, db);
+    biquad_update(&f->high_shelf);
+}
+
+static void line_filters_set_high_shelf_freq(line_filters_t *f, float freq) {
+    f->high_shelf.frequency = freq;
+    biquad_update(&f->high_shelf);
+}
+
+static void line_filters_set_cutoff(line_filters_t *f, float freq) {
+    lp1_set_cutoff(&f->low_pass, freq);
+}
+
+static void line_filters_set_cutoff_alpha(line_filters_t *f, float freq, float alpha) {
+    lp1_set_cutoff_alpha(&f->low_pass, freq, alpha);
+}
+
+typedef struct {
+    mod_delay_t delay;
+    allpass_diffuser_t diffuser;
+    biquad_state_t low_shelf;   /* Coefficients in the channel's line_filters_t */
+    biquad_state_t high_shelf;
+    float low_pass_out;
+    circular_buffer_t feedback_buffer;
+    float feedback;
+
+    int diffuser_enabled;
+    int tap_post_diffuser;
+    int samplerate;
+} delay_line_t;
+
+/* delay_size 0 (and a NULL allpass_pool) leaves the line unallocated */
+static void delay_line_init(delay_line_t *dl, int samplerate, int delay_size,
+                            float *allpass_pool, int allpass_size, engine_allocator_t *alloc) {
+    dl->samplerate = samplerate;
+    mod_delay_init(&dl->delay, delay_size, alloc);
+    diffuser_init(&dl->diffuser, samplerate, allpass_pool, allpass_size);
+    biquad_clear(&dl->low_shelf);
+    biquad_clear(&dl->high_shelf);
+    dl->low_pass_out = 0.0f;
+    circular_init(&dl->feedback_buffer);
+
+    dl->feedback = 0.0f;
+
+    diffuser_set_seed(&dl->diffuser, 1);
+    diffuser_set_cross_seed(&dl->diffuser, 0.0f);
+
+    dl->diffuser_enabled = 0;
+    dl->tap_post_diffuser = 0;
+}
+
+static void delay_line_free(delay_line_t *dl, engine_allocator_t *alloc) {
+    mod_delay_free(&dl->delay, alloc);
+}
+
+static void delay_line_set_samplerate(delay_line_t *dl, int samplerate) {
+    dl->samplerate = samplerate;
+    diffuser_set_samplerate(&dl->diffuser, samplerate);
+}
+
+static void delay_line_set_diffuser_seed(delay_line_t *dl, int seed, float cross_seed) {
+    diffuser_set_seed(&dl->diffuser, seed);
+    diffuser_set_cross_seed(&dl->diffuser, cross_seed);
+}
+
+static void delay_line_set_delay(delay_line_t *dl, int samples) {
+    dl->delay.sample_delay_target = samples;
+}
+
+static void delay_line_set_feedback(delay_line_t *dl, float fb) {
+    dl->feedback = fb;
+}
+
+static void delay_line_set_diffuser_delay(delay_line_t *dl, int samples) {
+    diffuser_set_delay(&dl->diffuser, samples);
+}
+
+static void delay_line_set_diffuser_feedback(delay_line_t *dl, float fb) {
+    diffuser_set_feedback(&dl->diffuser, fb);
+}
+
+static void delay_line_set_diffuser_stages(delay_line_t *dl, int stages) {
+    dl->diffuser.stages = stages;
+}
+
+static void delay_line_set_line_mod_amount(delay_line_t *dl, float amount) {
+    dl->delay.mod_amount = amount;
+}
+
+static void delay_line_set_line_mod_rate(delay_line_t *dl, float rate) {
+    dl->delay.mod_rate = rate;
+}
+
+static void delay_line_set_diffuser_mod_amount(delay_line_t *dl, float amount) {
+    diffuser_set_modulation(&dl->diffuser, amount > 0.0f);
+    diffuser_set_mod_amount(&dl->diffuser, amount);
+}
+
+static void delay_line_set_diffuser_mod_rate(delay_line_t *dl, float rate) {
+    diffuser_set_mod_rate(&dl->diffuser, rate);
+}
+
+static void delay_line_set_mod_update_rate(delay_line_t *dl, int rate) {
+    mod_delay_set_update_rate(&dl->delay, rate);
+    diffuser_set_mod_update_rate(&dl->diffuser, rate);
+}
+
+static void delay_line_set_interpolation(delay_line_t *dl, int enabled) {
+    diffuser_set_interpolation(&dl->diffuser, enabled);
+}
+
+static void delay_line_process(delay_line_t *dl, const line_filters_t *f,
+                               float *input, float *output, int count) {
+    float temp[BUFFER_SIZE];
+    circular_pop(&dl->feedback_buffer, temp, count);
+
+    for (int i = 0; i < count; i++)
+        temp[i] = input[i] + temp[i] * dl->feedback;
+
+    /* idle: temp is all zeros, so settled filters can be skipped */
+    int idle = mod_delay_process(&dl->delay, temp, temp, count);
+
+    if (!dl->tap_post_diffuser)
+        memcpy(output, temp, count * sizeof(float));
+
+    if (dl->diffuser_enabled)
+        idle = diffuser_process(&dl->diffuser, temp, temp, count);
+
+    if (f->low_shelf_enabled) {
+        if (idle && biquad_is_settled(&dl->low_shelf)) {
+            biquad_clear(&dl->low_shelf);
+        } else {
+            biquad_process(&f->low_shelf, &dl->low_shelf, temp, temp, count);
+            idle = 0;
+        }
+    }
+    if (f->high_shelf_enabled) {
+        if (idle && biquad_is_settled(&dl->high_shelf)) {
+            biquad_clear(&dl->high_shelf);
+        } else {
+            biquad_process(&f->high_shelf, &dl->high_shelf, temp, temp, count);
+            idle = 0;
+        }
+    }
+    if (f->cutoff_enabled) {
+        if (idle && fabsf(dl->low_pass_out) < STAGE_SILENCE_THRESHOLD)
+            dl->low_pass_out = 0.0f;
+        else
+            lp1_process_state(&f->low_pass, &dl->low_pass_out, temp, temp, count);
+    }
+
+    circular_push(&dl->feedback_buffer, temp, count);
+
+    if (dl->tap_post_diffuser)
+        memcpy(output, temp, count * sizeof(float));
+}
+
+static void delay_line_prefetch(delay_line_t *dl, int count) {
+    mod_delay_prefetch(&dl->delay, count);
+    if (dl->diffuser_enabled)
+        diffuser_prefetch(&dl->diffuser, count);
+}
+
+static void delay_line_clear_diffuser(delay_line_t *dl) {
+    diffuser_clear(&dl->diffuser);
+}
+
+/* Filter and feedback state only; sample buffers are cleared separately */
+static void delay_line_reset_state(delay_line_t *dl) {
+    biquad_clear(&dl->low_shelf);
+    biquad_clear(&dl->high_shelf);
+    dl->low_pass_out = 0.0f;
+    circular_init(&dl->feedback_buffer);
+    dl->delay.silent_run = SILENT_RUN_MAX;
+    diffuser_mark_silent(&dl->diffuser);
+}
+
+static void delay_line_clear(delay_line_t *dl) {
+    mod_delay_clear(&dl->delay);
+    diffuser_clear(&dl->diffuser);
+    biquad_clear(&dl->low_shelf);
+    biquad_clear(&dl->high_shelf);
+    dl->low_pass_out = 0.0f;
+    circular_init(&dl->feedback_buffer);
+}
+
+/* ============================================================================
+ * REVERB CHANNEL - Exact port from ReverbChannel.h
+ * ============================================================================ */
+
+/* Buffer lengths a channel is built with (see engine memory tiers) */
+typedef struct {
+    int predelay;               /* Samples */
+    int multitap;
+    int line;
+    int allpass;                /* Per diffuser stage */
+    int lines;                  /* Lines given buffers; the rest stay unallocated */
+    int active_lines;           /* line_count, <= lines */
+} channel_capacity_t;
+
+typedef struct {
+    mod_delay_t predelay;
+    multitap_delay_t multitap;
+    velvet_taps_t velvet;       /* Built from the multitap's pattern */
+    tap_conv_t *tap_conv;       /* Engine's FFT path for this side; set on the live pair only */
+    allpass_diffuser_t diffuser;
+    delay_line_t lines[MAX_LINE_COUNT];
+    line_filters_t line_filters;
+    float *allpass_pool;        /* Every diffuser stage's ring, one allocation */
+    hp1_t high_pass;
+    lp1_t low_pass;
+
+    float delay_line_seeds[MAX_LINE_COUNT * 3];
+    int delay_line_seed;
+    int post_diffusion_seed;
+    float cross_seed;
+
+    int line_count;
+    int low_cut_enabled;
+    int high_cut_enabled;
+    int early_mode;             /* EARLY_OFF, EARLY_MULTITAP or EARLY_VELVET */
+    int diffuser_enabled;
+
+    float input_mix;
+    float dry_out;
+    float early_out;
+    float line_out;
+
+    int line_layout;            /* LINE_LAYOUT_BLOCK or LINE_LAYOUT_SAMPLE for the next block */
+
+    int is_right;
+    int samplerate;
+} reverb_channel_t;
+
+static float channel_ms2samples(reverb_channel_t *ch, float ms) {
+    return ms / 1000.0f * ch->samplerate;
+}
+
+static float channel_get_per_line_gain(reverb_channel_t *ch) {
+    return 1.0f / sqrtf((float)ch->line_count);
+}
+
+static void channel_update_post_diffusion(reverb_channel_t *ch) {
+    for (int i = 0; i < MAX_LINE_COUNT; i++)
+        delay_line_set_diffuser_seed(&ch->lines[i],
+                                      (ch->post_diffusion_seed) * (i + 1),
+                                      ch->cross_seed);
+}
+
+static void channel_update_lines(reverb_channel_t *ch,
+                                  int line_delay_samples,
+                                  float line_decay_samples,
+                                  float line_mod_amount,
+                                  float line_mod_rate,
+                                  float late_diffusion_mod_amount,
+                                  float late_diffusion_mod_rate) {
+    random_buffer_generate_cross(ch->delay_line_seed, ch->cross_seed,
+                                  ch->delay_line_seeds, MAX_LINE_COUNT * 3);
+
+    for (int i = 0; i < MAX_LINE_COUNT; i++) {
+        float mod_amt = line_mod_amount * (0.7f + 0.3f * ch->delay_line_seeds[i]);
+        float mod_rate = line_mod_rate * (0.7f + 0.3f * ch->delay_line_seeds[MAX_LINE_COUNT + i])
+                         / ch->samplerate;
+
+        float delay_samples = (0.5f + 1.0f * ch->delay_line_seeds[MAX_LINE_COUNT * 2 + i])
+                              * line_delay_samples;
+        if (delay_samples < mod_amt + 2)
+            delay_samples = mod_amt + 2;
+
+        float db_per_iteration = delay_samples / line_decay_samples * (-60.0f);
+        float gain_per_iteration = db2gain(db_per_iteration);
+
+        delay_line_set_delay(&ch->lines[i], (int)delay_samples);
+        delay_line_set_feedback(&ch->lines[i], gain_per_iteration);
+        delay_line_set_line_mod_amount(&ch->lines[i], mod_amt);
+        delay_line_set_line_mod_rate(&ch->lines[i], mod_rate);
+        delay_line_set_diffuser_mod_amount(&ch->lines[i], late_diffusion_mod_amount);
+        delay_line_set_diffuser_mod_rate(&ch->lines[i], late_diffusion_mod_rate);
+    }
+}
+
+/* Allpass pool length: the early diffuser plus one per allocated line */
+static size_t channel_allpass_samples(const channel_capacity_t *cap) {
+    return (size_t)(1 + cap->lines) * MAX_DIFFUSER_STAGES * cap->allpass;
+}
+
+/* Bytes channel_init allocates for cap, excluding the channel struct */
+static size_t channel_buffer_bytes(const channel_capacity_t *cap) {
+    size_t samples = (size_t)cap->predelay + cap->multitap + (size_t)cap->lines * cap->line
+                   + channel_allpass_samples(cap);
+    return samples * sizeof(float);
+}
+
+/* Returns 0 on success, -1 if a buffer could not be allocated */
+static int channel_init(reverb_channel_t *ch, int samplerate, int is_right,
+                        const channel_capacity_t *cap, engine_allocator_t *alloc) {
+    ch->samplerate = samplerate;
+    ch->is_right = is_right;
+    ch->cross_seed = 0.0f;
+    ch->line_count = cap->active_lines;  /* 8 by default, from reference */
+    ch->delay_line_seed = 12345;
+    ch->post_diffusion_seed = 12345;
+
+    ch->allpass_pool = (float*)engine_alloc(alloc, CLOUDSEED_MEM_ALLPASS,
+                                            channel_allpass_samples(cap) * sizeof(float));
+    float *pool = ch->allpass_pool;
+    size_t diffuser_samples = (size_t)MAX_DIFFUSER_STAGES * cap->allpass;
+
+    mod_delay_init(&ch->predelay, cap->predelay, alloc);
+    multitap_init(&ch->multitap, cap->multitap, alloc);
+    multitap_set_tap_length(&ch->multitap, EARLY_TAP_LENGTH_MS * samplerate / 1000);
+    diffuser_init(&ch->diffuser, samplerate, pool, cap->allpass);
+    hp1_init(&ch->high_pass, samplerate);
+    lp1_init(&ch->low_pass, samplerate);
+
+    diffuser_set_interpolation(&ch->diffuser, 1);
+    hp1_set_cutoff(&ch->high_pass, 20.0f);
+    lp1_set_cutoff(&ch->low_pass, 20000.0f);
+
+    line_filters_init(&ch->line_filters, samplerate);
+
+    /* Unallocated lines are still initialized, keeping the LFO phase sequence */
+    for (int i = 0; i < MAX_LINE_COUNT; i++) {
+        int used = pool && i < cap->lines;
+        delay_line_init(&ch->lines[i], samplerate, used ? cap->line : 0,
+                        used ? pool + (1 + i) * diffuser_samples : NULL,
+                        used ? cap->allpass : 0, alloc);
+    }
+
+    ch->low_cut_enabled = 0;
+    ch->high_cut_enabled = 1;
+    ch->early_mode = EARLY_OFF;
+    ch->velvet.stale = 1;
+    ch->diffuser_enabled = 1;
+
+    ch->line_layout = LINE_LAYOUT_BLOCK;
+
+    ch->input_mix = 1.0f;
+    ch->dry_out = 0.0f;
+    ch->early_out = 0.0f;
+    ch->line_out = 1.0f;
+
+    if (!ch->allpass_pool || !ch->predelay.buffer || !ch->multitap.buffer)
+        return -1;
+    for (int i = 0; i < cap->lines; i++) {
+        if (!ch->lines[i].delay.buffer)
+            return -1;
+    }
+    return 0;
+}
+
+static void channel_free(reverb_channel_t *ch, engine_allocator_t *alloc) {
+    mod_delay_free(&ch->predelay, alloc);
+    multitap_free(&ch->multitap, alloc);
+    for (int i = 0; i < MAX_LINE_COUNT; i++)
+        delay_line_free(&ch->lines[i], alloc);
+    engine_free(alloc, ch->allpass_pool);
+    ch->allpass_pool = NULL;
+}
+
+/* Splits a channel struct allocation (filed as state) into its seed tables */
+static void channel_account_memory(engine_allocator_t *alloc) {
+    size_t diffusers = 1 + MAX_LINE_COUNT;
+    size_t seeds = diffusers * sizeof(((allpass_diffuser_t*)0)->seed_values)
+                 + sizeof(((multitap_delay_t*)0)->seed_values)
+                 + sizeof(((multitap_delay_t*)0)->tap_gains)
+                 + sizeof(((multitap_delay_t*)0)->tap_position)
+                 + sizeof(((reverb_channel_t*)0)->delay_line_seeds);
+
+    engine_mem_reclassify(alloc, CLOUDSEED_MEM_STATE, CLOUDSEED_MEM_SEEDS, seeds);
+}
+
+static void channel_set_samplerate(reverb_channel_t *ch, int samplerate) {
+    ch->samplerate = samplerate;
+    hp1_set_samplerate(&ch->high_pass, samplerate);
+    lp1_set_samplerate(&ch->low_pass, samplerate);
+    diffuser_set_samplerate(&ch->diffuser, samplerate);
+    line_filters_set_samplerate(&ch->line_filters, samplerate);
+
+    for (int i = 0; i < MAX_LINE_COUNT; i++)
+        delay_line_set_samplerate(&ch->lines[i], samplerate);
+}
+
+static void channel_set_cross_seed(reverb_channel_t *ch, float seed_param) {
+    /* Exact from reference: Right channel uses 0.5 * seed, Left uses 1 - 0.5 * seed */
+    ch->cross_seed = ch->is_right ? 0.5f * seed_param : 1.0f - 0.5f * seed_param;
+    if (ch->multitap.cross_seed != ch->cross_seed) {
+        multitap_set_cross_seed(&ch->multitap, ch->cross_seed);
+        ch->velvet.stale = 1;
+    }
+    diffuser_set_cross_seed(&ch->diffuser, ch->cross_seed);
+}
+
+/* Velvet taps are rebuilt from a changed pattern only while velvet is playing */
+static void channel_sync_velvet(reverb_channel_t *ch) {
+    if (ch->early_mode == EARLY_VELVET && ch->velvet.stale)
+        velvet_build(&ch->velvet, &ch->multitap);
+}
+
+/* Both generators share the multitap's ring, which sat unused while off; the tap length is fixed at init */
+static void channel_set_early_mode(reverb_channel_t *ch, int mode, int taps) {
+    if (mode != EARLY_OFF && ch->early_mode == EARLY_OFF)
+        multitap_clear(&ch->multitap);
+    ch->early_mode = mode;
+
+    if (taps != ch->multitap.count) {
+        multitap_set_tap_count(&ch->multitap, taps);
+        ch->velvet.stale = 1;
+    }
+    channel_sync_velvet(ch);
+}
+
+static void channel_set_mod_update_rate(reverb_channel_t *ch, int rate) {
+    mod_delay_set_update_rate(&ch->predelay, rate);
+    diffuser_set_mod_update_rate(&ch->diffuser, rate);
+    for (int i = 0; i < MAX_LINE_COUNT; i++)
+        delay_line_set_mod_update_rate(&ch->lines[i], rate);
+}
+
+/*
+ * Read heads sit up to ~1.5 s behind their write heads, one stream per
+ * stage; more than the hardware prefetchers track. Issue every stage's
+ * read window up front so the fetches overlap the earlier stages' work.
+ */
+static void channel_prefetch(reverb_channel_t *ch, int count) {
+#ifndef CLOUDSEED_NO_PREFETCH   /* Baseline for scripts/bench_prefetch.sh */
+    mod_delay_prefetch(&ch->predelay, count);
+    if (ch->diffuser_enabled)
+        diffuser_prefetch(&ch->diffuser, count);
+    for (int i = 0; i < ch->line_count; i++)
+        delay_line_prefetch(&ch->lines[i], count);
+#else
+    (void)ch;
+    (void)count;
+#endif
+}
+
+/* Sample-major processing covers plain lines: delay plus damping, tapped pre-diffuser */
+static int channel_lines_interleavable(reverb_channel_t *ch) {
+    const line_filters_t *f = &ch->line_filters;
+    if (f->low_shelf_enabled || f->high_shelf_enabled || !f->cutoff_enabled)
+        return 0;
+    for (int l = 0; l < ch->line_count; l++) {
+        delay_line_t *dl = &ch->lines[l];
+        if (dl->diffuser_enabled || dl->tap_post_diffuser)
+            return 0;
+    }
+    return 1;
+}
+
+/*
+ * Sample-major line engine: every line advances one sample before the
+ * next sample starts, with per-line state held in small local arrays the
+ * compiler keeps in registers. Produces the same result as calling
+ * delay_line_process per line, minus the idle-stage gating.
+ */
+static void channel_process_lines_interleaved(reverb_channel_t *ch, float *input,
+                                              float *line_sum, int count) {
+    float delays[MAX_LINE_COUNT][BUFFER_SIZE];
+    float feedback[MAX_LINE_COUNT][BUFFER_SIZE];
+    float *bufs[MAX_LINE_COUNT];
+    int sizes[MAX_LINE_COUNT];
+    int write_index[MAX_LINE_COUNT];
+    int last_active[MAX_LINE_COUNT];
+    float gain[MAX_LINE_COUNT];
+    float lp_out[MAX_LINE_COUNT];
+    float b0 = ch->line_filters.low_pass.b0;
+    float a1 = ch->line_filters.low_pass.a1;
+    int lines = ch->line_count;
+
+    for (int l = 0; l < lines; l++) {
+        delay_line_t *dl = &ch->lines[l];
+        circular_pop(&dl->feedback_buffer, feedback[l], count);
+        mod_delay_render_delays(&dl->delay, delays[l], count);
+        bufs[l] = dl->delay.buffer;
+        sizes[l] = dl->delay.size;
+        write_index[l] = dl->delay.write_index;
+        last_active[l] = -1;
+        gain[l] = dl->feedback;
+        lp_out[l] = dl->low_pass_out;
+    }
+
+    for (int i = 0; i < count; i++) {
+        float x = input[i];
+        float sum = 0.0f;
+
+        for (int l = 0; l < lines; l++) {
+            float v = x + feedback[l][i] * gain[l];
+            float *buf = bufs[l];
+            int w = write_index[l];
+            buf[w] = v;
+
+            int whole = (int)delays[l][i];
+            float frac = delays[l][i] - (float)whole;
+            int read_a = w - whole;
+            int read_b = read_a - 1;
+            if (read_a < 0) read_a += sizes[l];
+            if (read_b < 0) read_b += sizes[l];
+
+            float y = buf[read_a] * (1.0f - frac) + buf[read_b] * frac;
+            sum += y;
+
+            /* Damping, matching lp1_step */
+            float lp = lp_out[l];
+            lp = (y == 0.0f && lp < 0.0000001f) ? 0.0f : b0 * y + a1 * lp;
+            lp_out[l] = lp;
+            feedback[l][i] = lp;
+
+            w++;
+            write_index[l] = w >= sizes[l] ? 0 : w;
+            last_active[l] = fabsf(v) >= STAGE_SILENCE_THRESHOLD ? i : last_active[l];
+        }
+
+        line_sum[i] = sum;
+    }
+
+    for (int l = 0; l < lines; l++) {
+        delay_line_t *dl = &ch->lines[l];
+        dl->delay.write_index = write_index[l];
+        dl->delay.silent_run = silent_run_extend(dl->delay.silent_run, last_active[l], count);
+        dl->low_pass_out = lp_out[l];
+        circular_push(&dl->feedback_buffer, feedback[l], count);
+    }
+}
+
+static void channel_process(reverb_channel_t *ch, float *input, float *output, int count) {
+    float temp[BUFFER_SIZE];
+    float line_out_buf[BUFFER_SIZE];
+    float line_sum[BUFFER_SIZE];
+
+    channel_prefetch(ch, count);
+
+    for (int i = 0; i < count; i++)
+        temp[i] = input[i] * ch->input_mix;
+
+    /* Silent input into settled filters: skip them and flush their state */
+    int input_idle = block_last_active(temp, count) < 0 &&
+                     (!ch->low_cut_enabled || hp1_is_settled(&ch->high_pass)) &&
+                     (!ch->high_cut_enabled || lp1_is_settled(&ch->low_pass));
+
+    if (input_idle) {
+        memset(temp, 0, count * sizeof(float));
+        hp1_clear(&ch->high_pass);
+        lp1_clear(&ch->low_pass);
+    } else {
+        if (ch->low_cut_enabled)
+            hp1_process(&ch->high_pass, temp, temp, count);
+        if (ch->high_cut_enabled)
+            lp1_process(&ch->low_pass, temp, temp, count);
+    }
+
+    /* Denormal prevention */
+    for (int i = 0; i < count; i++) {
+        if (temp[i] * temp[i] < 0.000000001f)
+            temp[i] = 0.0f;
+    }
+
+    mod_delay_process(&ch->predelay, temp, temp, count);
+
+    if (ch->early_mode == EARLY_MULTITAP && ch->tap_conv && ch->multitap.count >= CONV_MIN_TAPS)
+        tap_conv_process(ch->tap_conv, &ch->multitap, temp, temp, count);
+    else if (ch->early_mode == EARLY_MULTITAP)
+        multitap_process(&ch->multitap, temp, temp, count);
+    else if (ch->early_mode == EARLY_VELVET)
+        velvet_process(&ch->velvet, &ch->multitap, temp, temp, count);
+
+    if (ch->diffuser_enabled)
+        diffuser_process(&ch->diffuser, temp, temp, count);
+
+    /* temp now holds the early signal; the lines only read it */
+    if (ch->line_layout == LINE_LAYOUT_SAMPLE && channel_lines_interleavable(ch)) {
+        channel_process_lines_interleaved(ch, temp, line_sum, count);
+    } else {
+        memset(line_sum, 0, count * sizeof(float));
+        for (int i = 0; i < ch->line_count; i++) {
+            delay_line_process(&ch->lines[i], &ch->line_filters, temp, line_out_buf, count);
+            for (int j = 0; j < count; j++)
+                line_sum[j] += line_out_buf[j];
+        }
+    }
+
+    /* Output mixer: only the terms that are switched on */
+    float line_gain = ch->line_out * channel_get_per_line_gain(ch);
+
+    if (ch->dry_out != 0.0f) {
+        for (int i = 0; i < count; i++) {
+            output[i] = ch->dry_out * input[i]
+                      + ch->early_out * temp[i]
+                      + line_gain * line_sum[i];
+        }
+    } else if (ch->early_out != 0.0f) {
+        for (int i = 0; i < count; i++)
+            output[i] = ch->early_out * temp[i] + line_gain * line_sum[i];
+    } else {
+        for (int i = 0; i < count; i++)
+            output[i] = line_gain * line_sum[i];
+    }
+}
+
+static void channel_clear(reverb_channel_t *ch) {
+    lp1_clear(&ch->low_pass);
+    hp1_clear(&ch->high_pass);
+    mod_delay_clear(&ch->predelay);
+    multitap_clear(&ch->multitap);
+    diffuser_clear(&ch->diffuser);
+    for (int i = 0; i < MAX_LINE_COUNT; i++)
+        delay_line_clear(&ch->lines[i]);
+}
+
+/* Longest single pass from input to output: predelay, early diffuser, slowest line */
+static int channel_settle_samples(reverb_channel_t *ch) {
+    int samples = ch->predelay.sample_delay_target;
+
+    if (ch->early_mode != EARLY_OFF)
+        samples += (int)ch->multitap.length_samples;
+
+    if (ch->diffuser_enabled) {
+        for (int i = 0; i < ch->diffuser.stages; i++)
+            samples += ch->diffuser.filters[i].sample_delay_target;
+    }
+
+    int longest_line = 0;
+    for (int i = 0; i < ch->line_count; i++) {
+        if (ch->lines[i].delay.sample_delay_target > longest_line)
+            longest_line = ch->lines[i].delay.sample_delay_target;
+    }
+    return samples + longest_line;
+}
+
+/*
+ * Every sample buffer owned by a channel, in a fixed order, with its ring
+ * write position; enumerated for incremental clearing and tail copies.
+ */
+#define CHANNEL_REGIONS (2 + MAX_DIFFUSER_STAGES + MAX_LINE_COUNT * (1 + MAX_DIFFUSER_STAGES))
+
+static float *channel_region(reverb_channel_t *ch, int region, int *len, int **index) {
+    if (region == 0) {
+        *len = ch->predelay.size;
+        *index = &ch->predelay.write_index;
+        return ch->predelay.buffer;
+    }
+    if (region == 1) {
+        *len = ch->multitap.size;
+        *index = &ch->multitap.write_idx;
+        return ch->multitap.buffer;
+    }
+    region -= 2;
+    if (region < MAX_DIFFUSER_STAGES) {
+        *len = ch->diffuser.filters[region].size;
+        *index = &ch->diffuser.filters[region].index;
+        return ch->diffuser.filters[region].buffer;
+    }
+    region -= MAX_DIFFUSER_STAGES;
+
+    delay_line_t *dl = &ch->lines[region / (1 + MAX_DIFFUSER_STAGES)];
+    int stage = region % (1 + MAX_DIFFUSER_STAGES);
+    if (stage == 0) {
+        *len = dl->delay.size;
+        *index = &dl->delay.write_index;
+        return dl->delay.buffer;
+    }
+    *len = dl->diffuser.filters[stage - 1].size;
+    *index = &dl->diffuser.filters[stage - 1].index;
+    return dl->diffuser.filters[stage - 1].buffer;
+}
+
+/* Newest samples of a region that later reads can reach; 0 once it has gone quiet */
+static int channel_region_live(reverb_channel_t *ch, int region) {
+    int len;
+    int *index;
+    if (!channel_region(ch, region, &len, &index))
+        return 0;
+
+    int reach, silent_run;
+    if (region == 0) {
+        reach = mod_delay_reach(&ch->predelay);
+        silent_run = ch->predelay.silent_run;
+    } else if (region == 1) {
+        reach = (int)ch->multitap.length_samples + 2;
+        silent_run = ch->multitap.silent_run;
+    } else if (region - 2 < MAX_DIFFUSER_STAGES) {
+        mod_allpass_t *ap = &ch->diffuser.filters[region - 2];
+        reach = mod_allpass_reach(ap);
+        silent_run = ap->silent_run;
+    } else {
+        region -= 2 + MAX_DIFFUSER_STAGES;
+        delay_line_t *dl = &ch->lines[region / (1 + MAX_DIFFUSER_STAGES)];
+        int stage = region % (1 + MAX_DIFFUSER_STAGES);
+        if (stage == 0) {
+            reach = mod_delay_reach(&dl->delay);
+            silent_run = dl->delay.silent_run;
+        } else {
+            reach = mod_allpass_reach(&dl->diffuser.filters[stage - 1]);
+            silent_run = dl->diffuser.filters[stage - 1].silent_run;
+        }
+    }
+
+    if (silent_run >= reach)
+        return 0;
+    return reach < len ? reach : len;
+}
+
+/*
+ * Zeroes at most *budget samples, resuming from *region / *offset.
+ * Decrements *budget by the work done; returns 1 once every buffer is clear.
+ */
+static int channel_clear_step(reverb_channel_t *ch, int *region, int *offset, int *budget) {
+    while (*region < CHANNEL_REGIONS && *budget > 0) {
+        int len;
+        int *index;
+        float *buf = channel_region(ch, *region, &len, &index);
+
+        int n = len - *offset;
+        if (n > *budget) n = *budget;
+        if (buf)
+            memset(buf + *offset, 0, n * sizeof(float));
+
+        *offset += n;
+        *budget -= n;
+        if (*offset >= len) {
+            (*region)++;
+            *offset = 0;
+        }
+    }
+    return *region >= CHANNEL_REGIONS;
+}
+
+/* Freshly built channel: every delay starts at its target */
+static void channel_snap_delays(reverb_channel_t *ch) {
+    mod_delay_snap(&ch->predelay);
+    diffuser_snap(&ch->diffuser);
+    for (int i = 0; i < MAX_LINE_COUNT; i++) {
+        mod_delay_snap(&ch->lines[i].delay);
+        diffuser_snap(&ch->lines[i].diffuser);
+    }
+}
+
+/* Filter and feedback state only; used when a lazy clear completes */
+static void channel_reset_state(reverb_channel_t *ch) {
+    lp1_clear(&ch->low_pass);
+    hp1_clear(&ch->high_pass);
+    ch->predelay.silent_run = SILENT_RUN_MAX;
+    ch->multitap.silent_run = SILENT_RUN_MAX;
+    diffuser_mark_silent(&ch->diffuser);
+    for (int i = 0; i < MAX_LINE_COUNT; i++)
+        delay_line_reset_state(&ch->lines[i]);
+}
+
+/*
+ * Tail priming, one ring of both channels' region r, on the audio thread.
+ * Not yet copied (*pos < 0) or wrapped since the last call (elapsed frames
+ * ago): dst takes src's newest samples whole. Otherwise it takes what src
+ * wrote since *pos, so it stays level. Returns the samples copied.
+ */
+static int channel_prime_region(reverb_channel_t *dst, reverb_channel_t *src, int r,
+                                int *pos, uint32_t elapsed) {
+    int dst_len, src_len;
+    int *dst_index, *src_index;
+    float *dst_buf = channel_region(dst, r, &dst_len, &dst_index);
+    const float *src_buf = channel_region(src, r, &src_len, &src_index);
+
+    if (!dst_buf || !src_buf)
+        return 0;
+
+    int count;
+    if (*pos < 0 || (uint32_t)src_len <= elapsed) {
+        count = dst_len < src_len ? dst_len : src_len;
+        int from = *src_index - count;
+        if (from < 0) from += src_len;
+        ring_copy(dst_buf, dst_len, 0, src_buf, src_len, from, count);
+        *dst_index = count == dst_len ? 0 : count;
+    } else {
+        count = *src_index - *pos;
+        if (count < 0) count += src_len;
+        ring_copy(dst_buf, dst_len, *dst_index, src_buf, src_len, *pos, count);
+        *dst_index = (*dst_index + count) % dst_len;
+    }
+    *pos = *src_index;
+    return count;
+}
+
+/*
+ * Adopt: dst takes over src's whole state and coefficients, keeping its
+ * own ring. Coefficients are copied rather than derived again because the
+ * reference update order makes them depend on earlier updates.
+ */
+static void mod_delay_adopt(mod_delay_t *dst, const mod_delay_t *src) {
+    float *buffer = dst->buffer;
+    int size = dst->size;
+    int write_index = dst->write_index;
+    *dst = *src;
+    dst->buffer = buffer;
+    dst->size = size;
+    dst->write_index = write_index;
+}
+
+static void mod_allpass_adopt(mod_allpass_t *dst, const mod_allpass_t *src) {
+    float *buffer = dst->buffer;
+    int size = dst->size;
+    int index = dst->index;
+    *dst = *src;
+    dst->buffer = buffer;
+    dst->size = size;
+    dst->index = index;
+}
+
+static void multitap_adopt(multitap_delay_t *dst, const multitap_delay_t *src) {
+    float *buffer = dst->buffer;
+    int size = dst->size;
+    int write_idx = dst->write_idx;
+    *dst = *src;
+    dst->buffer = buffer;
+    dst->size = size;
+    dst->write_idx = write_idx;
+}
+
+static void diffuser_adopt(allpass_diffuser_t *dst, const allpass_diffuser_t *src) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        if (dst->filters[i].buffer && src->filters[i].buffer)
+            mod_allpass_adopt(&dst->filters[i], &src->filters[i]);
+    }
+    dst->feedback = src->feedback;
+    dst->delay = src->delay;
+    dst->mod_rate = src->mod_rate;
+    memcpy(dst->seed_values, src->seed_values, sizeof(dst->seed_values));
+    dst->cross_seed = src->cross_seed;
+    dst->stages = src->stages;
+}
+
+static void delay_line_adopt(delay_line_t *dst, const delay_line_t *src) {
+    mod_delay_adopt(&dst->delay, &src->delay);
+    diffuser_adopt(&dst->diffuser, &src->diffuser);
+    dst->low_shelf = src->low_shelf;
+    dst->high_shelf = src->high_shelf;
+    dst->low_pass_out = src->low_pass_out;
+    dst->feedback_buffer = src->feedback_buffer;
+    dst->feedback = src->feedback;
+}
+
+/*
+ * A delay adopted from a larger ring may reach past this one: jump it to
+ * its target. Same bound as memory_tier_capacity; the margin covers the
+ * two samples of interpolation slack in reach.
+ */
+static void mod_delay_fit(mod_delay_t *d) {
+    if (d->buffer && mod_delay_reach(d) - 2 + RING_MARGIN > d->size)
+        mod_delay_snap(d);
+}
+
+static void diffuser_fit(allpass_diffuser_t *d) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        mod_allpass_t *ap = &d->filters[i];
+        if (ap->buffer && mod_allpass_reach(ap) - 2 + RING_MARGIN > ap->size)
+            mod_allpass_snap(ap);
+    }
+}
+
+static void channel_fit_delays(reverb_channel_t *ch) {
+    mod_delay_fit(&ch->predelay);
+    diffuser_fit(&ch->diffuser);
+    for (int i = 0; i < MAX_LINE_COUNT; i++) {
+        mod_delay_fit(&ch->lines[i].delay);
+        diffuser_fit(&ch->lines[i].diffuser);
+    }
+}
+
+/* Everything but the rings; buffers src never had (NULL) are left alone */
+static void channel_adopt(reverb_channel_t *dst, const reverb_channel_t *src) {
+    mod_delay_adopt(&dst->predelay, &src->predelay);
+    multitap_adopt(&dst->multitap, &src->multitap);
+    dst->early_mode = src->early_mode;
+    dst->velvet.stale = 1;
+    channel_sync_velvet(dst);
+    diffuser_adopt(&dst->diffuser, &src->diffuser);
+    for (int i = 0; i < MAX_LINE_COUNT; i++) {
+        if (dst->lines[i].delay.buffer && src->lines[i].delay.buffer)
+            delay_line_adopt(&dst->lines[i], &src->lines[i]);
+    }
+    dst->line_filters = src->line_filters;
+    dst->high_pass = src->high_pass;
+    dst->low_pass = src->low_pass;
+    memcpy(dst->delay_line_seeds, src->delay_line_seeds, sizeof(dst->delay_line_seeds));
+    dst->cross_seed = src->cross_seed;
+    dst->early_out = src->early_out;
+    dst->line_out = src->line_out;
+}
+
+/* ============================================================================
+ * COEFFICIENT SETS - Everything a parameter update writes into a channel
+ * ============================================================================ */
+
+typedef struct {
+    int delay;                  /* sample_delay_target */
+    float mod_amount;
+    float mod_rate;             /* Cycles per sample */
+} delay_coefs_t;
+
+typedef struct {
+    int delay;
+    float mod_amount;
+    float mod_rate;
+    int modulation_enabled;
+} allpass_coefs_t;
+
+typedef struct {
+    allpass_coefs_t stages[MAX_DIFFUSER_STAGES];
+    float seed_values[MAX_DIFFUSER_STAGES * 3];
+    float cross_seed;
+    float feedback;
+    float mod_rate;             /* Hz, before per-stage scaling */
+    int delay;
+    int stage_count;
+} diffuser_coefs_t;
+
+typedef struct {
+    float cutoff_hz;
+    float b0, a1;
+} onepole_coefs_t;
+
+typedef struct {
+    delay_coefs_t delay;
+    diffuser_coefs_t diffuser;
+    float feedback;
+} line_coefs_t;
+
+/*
+ * A channel's derived values, seeds included, so installing a set leaves
+ * the channel exactly as the update that produced it did. Filter, LFO and
+ * ring state are not part of it.
+ */
+typedef struct {
+    delay_coefs_t predelay;
+    diffuser_coefs_t diffuser;
+    line_coefs_t lines[MAX_LINE_COUNT];
+    onepole_coefs_t damping;    /* Shared by the lines */
+    float delay_line_seeds[MAX_LINE_COUNT * 3];
+    float cross_seed;
+    float tap_seed_values[MAX_TAPS * 3];
+    float tap_gains[MAX_TAPS];
+    float tap_position[MAX_TAPS];
+    float tap_cross_seed;
+    onepole_coefs_t high_pass;
+    onepole_coefs_t low_pass;
+    float early_out;
+    float line_out;
+} channel_coefs_t;
+
+static void delay_coefs_capture(const mod_delay_t *d, delay_coefs_t *c) {
+    c->delay = d->sample_delay_target;
+    c->mod_amount = d->mod_amount;
+    c->mod_rate = d->mod_rate;
+}
+
+static void delay_coefs_install(mod_delay_t *d, const delay_coefs_t *c) {
+    d->sample_delay_target = c->delay;
+    d->mod_amount = c->mod_amount;
+    d->mod_rate = c->mod_rate;
+}
+
+static void diffuser_coefs_capture(const allpass_diffuser_t *d, diffuser_coefs_t *c) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        const mod_allpass_t *ap = &d->filters[i];
+        c->stages[i].delay = ap->sample_delay_target;
+        c->stages[i].mod_amount = ap->mod_amount;
+        c->stages[i].mod_rate = ap->mod_rate;
+        c->stages[i].modulation_enabled = ap->modulation_enabled;
+    }
+    memcpy(c->seed_values, d->seed_values, sizeof(c->seed_values));
+    c->cross_seed = d->cross_seed;
+    c->feedback = d->feedback;
+    c->mod_rate = d->mod_rate;
+    c->delay = d->delay;
+    c->stage_count = d->stages;
+}
+
+static void diffuser_coefs_install(allpass_diffuser_t *d, const diffuser_coefs_t *c) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        mod_allpass_t *ap = &d->filters[i];
+        ap->sample_delay_target = c->stages[i].delay;
+        ap->mod_amount = c->stages[i].mod_amount;
+        ap->mod_rate = c->stages[i].mod_rate;
+        ap->modulation_enabled = c->stages[i].modulation_enabled;
+    }
+    memcpy(d->seed_values, c->seed_values, sizeof(d->seed_values));
+    d->cross_seed = c->cross_seed;
+    d->feedback = c->feedback;
+    d->mod_rate = c->mod_rate;
+    d->delay = c->delay;
+    d->stages = c->stage_count;
+}
+
+static void channel_coefs_capture(const reverb_channel_t *ch, channel_coefs_t *c) {
+    delay_coefs_capture(&ch->predelay, &c->predelay);
+    diffuser_coefs_capture(&ch->diffuser, &c->diffuser);
+    for (int i = 0; i < MAX_LINE_COUNT; i++) {
+        const delay_line_t *dl = &ch->lines[i];
+        line_coefs_t *lc = &c->lines[i];
+        delay_coefs_capture(&dl->delay, &lc->delay);
+        diffuser_coefs_capture(&dl->diffuser, &lc->diffuser);
+        lc->feedback = dl->feedback;
+    }
+    const lp1_t *damping = &ch->line_filters.low_pass;
+    c->damping = (onepole_coefs_t){ damping->cutoff_hz, damping->b0, damping->a1 };
+    memcpy(c->delay_line_seeds, ch->delay_line_seeds, sizeof(c->delay_line_seeds));
+    c->cross_seed = ch->cross_seed;
+    memcpy(c->tap_seed_values, ch->multitap.seed_values, sizeof(c->tap_seed_values));
+    memcpy(c->tap_gains, ch->multitap.tap_gains, sizeof(c->tap_gains));
+    memcpy(c->tap_position, ch->multitap.tap_position, sizeof(c->tap_position));
+    c->tap_cross_seed = ch->multitap.cross_seed;
+    c->high_pass = (onepole_coefs_t){ ch->high_pass.cutoff_hz, ch->high_pass.b0, ch->high_pass.a1 };
+    c->low_pass = (onepole_coefs_t){ ch->low_pass.cutoff_hz, ch->low_pass.b0, ch->low_pass.a1 };
+    c->early_out = ch->early_out;
+    c->line_out = ch->line_out;
+}
+
+/* A copy per field; no seeds are drawn and nothing transcendental runs */
+static void channel_coefs_install(reverb_channel_t *ch, const channel_coefs_t *c) {
+    delay_coefs_install(&ch->predelay, &c->predelay);
+    diffuser_coefs_install(&ch->diffuser, &c->diffuser);
+    for (int i = 0; i < MAX_LINE_COUNT; i++) {
+        delay_line_t *dl = &ch->lines[i];
+        const line_coefs_t *lc = &c->lines[i];
+        delay_coefs_install(&dl->delay, &lc->delay);
+        diffuser_coefs_install(&dl->diffuser, &lc->diffuser);
+        dl->feedback = lc->feedback;
+    }
+    lp1_t *damping = &ch->line_filters.low_pass;
+    damping->cutoff_hz = c->damping.cutoff_hz;
+    damping->b0 = c->damping.b0;
+    damping->a1 = c->damping.a1;
+    ch->line_filters.cutoff_enabled = 1;
+    memcpy(ch->delay_line_seeds, c->delay_line_seeds, sizeof(ch->delay_line_seeds));
+    ch->cross_seed = c->cross_seed;
+    memcpy(ch->multitap.seed_values, c->tap_seed_values, sizeof(ch->multitap.seed_values));
+    memcpy(ch->multitap.tap_gains, c->tap_gains, sizeof(ch->multitap.tap_gains));
+    memcpy(ch->multitap.tap_position, c->tap_position, sizeof(ch->multitap.tap_position));
+    ch->multitap.cross_seed = c->tap_cross_seed;
+    ch->multitap.pattern_gen++;
+    ch->velvet.stale = 1;
+    channel_sync_velvet(ch);
+    ch->high_pass.cutoff_hz = c->high_pass.cutoff_hz;
+    ch->high_pass.b0 = c->high_pass.b0;
+    ch->high_pass.a1 = c->high_pass.a1;
+    ch->low_pass.cutoff_hz = c->low_pass.cutoff_hz;
+    ch->low_pass.b0 = c->low_pass.b0;
+    ch->low_pass.a1 = c->low_pass.a1;
+    ch->dry_out = 0.0f;
+    ch->early_out = c->early_out;
+    ch->line_out = c->line_out;
+}
+
+/*
+ * Morphing: writes a blend of two sets, t = 0 giving a and 1 giving b.
+ * Delays and counts are rounded, feedback gains blend in the log domain,
+ * filters through their alphas. Seeds and tap tables are left as they
+ * are, so a channel already holding a's set only needs this.
+ */
+static inline float coef_lerp(float a, float b, float t) {
+    return a * (1.0f - t) + b * t;
+}
+
+static inline int coef_lerp_int(int a, int b, float t) {
+    return (int)(coef_lerp((float)a, (float)b, t) + 0.5f);
+}
+
+static onepole_coefs_t onepole_coefs_morph(const onepole_coefs_t *a, const onepole_coefs_t *b, float t) {
+    float a1 = coef_lerp(a->a1, b->a1, t);
+    return (onepole_coefs_t){ coef_lerp(a->cutoff_hz, b->cutoff_hz, t), 1.0f - a1, a1 };
+}
+
+static void delay_coefs_morph(mod_delay_t *d, const delay_coefs_t *a, const delay_coefs_t *b, float t) {
+    d->sample_delay_target = coef_lerp_int(a->delay, b->delay, t);
+    d->mod_amount = coef_lerp(a->mod_amount, b->mod_amount, t);
+    d->mod_rate = coef_lerp(a->mod_rate, b->mod_rate, t);
+}
+
+static void diffuser_coefs_morph(allpass_diffuser_t *d, const diffuser_coefs_t *a,
+                                 const diffuser_coefs_t *b, float t) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        mod_allpass_t *ap = &d->filters[i];
+        const allpass_coefs_t *sa = &a->stages[i];
+        const allpass_coefs_t *sb = &b->stages[i];
+        ap->sample_delay_target = coef_lerp_int(sa->delay, sb->delay, t);
+        ap->mod_amount = coef_lerp(sa->mod_amount, sb->mod_amount, t);
+        ap->mod_rate = coef_lerp(sa->mod_rate, sb->mod_rate, t);
+        ap->modulation_enabled = sa->modulation_enabled || sb->modulation_enabled;
+    }
+    d->feedback = coef_lerp(a->feedback, b->feedback, t);
+    d->mod_rate = coef_lerp(a->mod_rate, b->mod_rate, t);
+    d->delay = coef_lerp_int(a->delay, b->delay, t);
+    d->stages = coef_lerp_int(a->stage_count, b->stage_count, t);
+}
+
+static void channel_coefs_morph(reverb_channel_t *ch, const channel_coefs_t *a,
+                                const channel_coefs_t *b, float t) {
+    delay_coefs_morph(&ch->predelay, &a->predelay, &b->predelay, t);
+    diffuser_coefs_morph(&ch->diffuser, &a->diffuser, &b->diffuser, t);
+    for (int i = 0; i < MAX_LINE_COUNT; i++) {
+        delay_line_t *dl = &ch->lines[i];
+        const line_coefs_t *la = &a->lines[i];
+        const line_coefs_t *lb = &b->lines[i];
+        delay_coefs_morph(&dl->delay, &la->delay, &lb->delay, t);
+        diffuser_coefs_morph(&dl->diffuser, &la->diffuser, &lb->diffuser, t);
+        dl->feedback = fast_exp2f(coef_lerp(fast_log2f(la->feedback), fast_log2f(lb->feedback), t));
+    }
+    onepole_coefs_t damping = onepole_coefs_morph(&a->damping, &b->damping, t);
+    ch->line_filters.low_pass.cutoff_hz = damping.cutoff_hz;
+    ch->line_filters.low_pass.b0 = damping.b0;
+    ch->line_filters.low_pass.a1 = damping.a1;
+    onepole_coefs_t hp = onepole_coefs_morph(&a->high_pass, &b->high_pass, t);
+    onepole_coefs_t lp = onepole_coefs_morph(&a->low_pass, &b->low_pass, t);
+    ch->high_pass.cutoff_hz = hp.cutoff_hz;
+    ch->high_pass.b0 = hp.b0;
+    ch->high_pass.a1 = hp.a1;
+    ch->low_pass.cutoff_hz = lp.cutoff_hz;
+    ch->low_pass.b0 = lp.b0;
+    ch->low_pass.a1 = lp.a1;
+    ch->early_out = coef_lerp(a->early_out, b->early_out, t);
+    ch->line_out = coef_lerp(a->line_out, b->line_out, t);
+}
+
+/* ============================================================================
+ * KNOB TABLES - Knob-to-coefficient curves, built once and shared by instances
+ * ============================================================================ */
+
+#define KNOB_TABLE_SIZE 101           /* One entry per module.json step (0.01) */
+
+typedef struct {
+    float predelay_samples[KNOB_TABLE_SIZE];
+    float line_delay_samples[KNOB_TABLE_SIZE];
+    float line_decay_samples[KNOB_TABLE_SIZE];
+    float mod_rate_hz[KNOB_TABLE_SIZE];
+    float low_cut_hz[KNOB_TABLE_SIZE];
+    float low_cut_alpha[KNOB_TABLE_SIZE];
+    float high_cut_hz[KNOB_TABLE_SIZE];
+    float high_cut_alpha[KNOB_TABLE_SIZE];
+    float damping_hz[KNOB_TABLE_SIZE];
+    float damping_alpha[KNOB_TABLE_SIZE];
+} knob_tables_t;
+
+static knob_tables_t g_knob_tables;
+
+static void knob_tables_init(knob_tables_t *t, int samplerate) {
+    for (int i = 0; i < KNOB_TABLE_SIZE; i++) {
+        float x = (float)i / (float)(KNOB_TABLE_SIZE - 1);
+
+        /* Pre-delay: 0-500ms using Resp2dec curve */
+        t->predelay_samples[i] = resp2dec(x) * 500.0f / 1000.0f * samplerate;
+
+        /* Room size: 20-1000ms using Resp2dec curve */
+        t->line_delay_samples[i] = (20.0f + resp2dec(x) * 980.0f) / 1000.0f * samplerate;
+
+        /* Decay: 0.05-60 seconds using Resp3dec curve */
+        t->line_decay_samples[i] = (0.05f + resp3dec(x) * 59.95f) * samplerate;
+
+        t->mod_rate_hz[i] = resp2dec(x) * 5.0f;
+
+        /* Input filters */
+        t->low_cut_hz[i] = 20.0f + resp4oct(x) * 980.0f;
+        t->low_cut_alpha[i] = onepole_alpha(t->low_cut_hz[i], (float)samplerate);
+        t->high_cut_hz[i] = 400.0f + resp4oct(x) * 19600.0f;
+        t->high_cut_alpha[i] = onepole_alpha(t->high_cut_hz[i], (float)samplerate);
+
+        /* Delay line damping tracks high cut at 0.8x on the same curve */
+        t->damping_hz[i] = 400.0f + resp4oct(x * 0.8f) * 19600.0f;
+        t->damping_alpha[i] = onepole_alpha(t->damping_hz[i], (float)samplerate);
+    }
+}
+
+/* Linear interpolation between table entries; exact on the 0.01 knob grid */
+static float knob_lookup(const float *table, float knob) {
+    float pos = knob * (float)(KNOB_TABLE_SIZE - 1);
+    if (pos <= 0.0f) return table[0];
+    if (pos >= (float)(KNOB_TABLE_SIZE - 1)) return table[KNOB_TABLE_SIZE - 1];
+
+    int i = (int)pos;
+    float frac = pos - (float)i;
+    return table[i] + (table[i + 1] - table[i]) * frac;
+}
+
+/* ============================================================================
+ * ENGINE - Public context, parameter mapping and block processing
+ * ============================================================================ */
+
+/* Per block-size timing of the two line layouts (LINE_LAYOUT_AUTO) */
+typedef struct {
+    uint64_t ns[2];
+    int blocks[2];
+    int choice;                 /* -1 until both layouts have been timed */
+} layout_calibration_t;
+
+/*
+ * Memory tiers, largest first. Huge keeps the reference buffer sizes; the
+ * others size every ring for their ranges, so standard sounds identical
+ * in a fraction of the memory and the smaller tiers trade maximum times
+ * for footprint. A memory profile picks the tier to start from.
+ */
+typedef struct {
+    const char *name;
+    int max_predelay_ms;
+    int max_size_ms;
+    int max_diffuser_ms;        /* Early diffuser delay, 10-100 ms with size */
+    int max_lines;              /* Caps the requested line count */
+} memory_tier_t;
+
+static const memory_tier_t g_memory_tiers[CLOUDSEED_MEM_TIERS] = {
+    { "huge",     500, 1000, 100, MAX_LINE_COUNT },
+    { "standard", 500, 1000, 100, MAX_LINE_COUNT },
+    { "reduced",  250,  500, 100, MAX_LINE_COUNT },
+    { "compact",  100,  300, 100, MAX_LINE_COUNT },
+    { "minimal",  100,  300,  50, 4 },
+};
+
+/* Rebuild handshake between the worker and the audio thread (rebuild_state) */
+#define REBUILD_IDLE 0
+#define REBUILD_READY 1               /* Worker built the pending pair */
+#define REBUILD_RETIRED 2             /* Audio thread swapped; retired pair awaits freeing */
+#define REBUILD_CAPTURE 3             /* Worker built the pending pair; wants the live params captured */
+#define REBUILD_CAPTURED 4            /* Audio thread captured them */
+
+/* Snapshot copy handshake between the saving thread, the worker and the audio thread (snapshot_state) */
+#define SNAPSHOT_IDLE 0
+#define SNAPSHOT_REQUESTED 1          /* Saving thread wants a copy; worker builds it */
+#define SNAPSHOT_PRIMING 2            /* Audio thread fills the copy */
+#define SNAPSHOT_READY 3              /* Copy captured; the saving thread reads it */
+#define SNAPSHOT_FAILED 4             /* No memory for the copy */
+
+#define TAP_CONV_NONE 0
+#define TAP_CONV_WANTED 1             /* Multitap at CONV_MIN_TAPS or more; worker allocates it */
+#define TAP_CONV_DONE 2               /* Worker allocated it, or gave up */
+
+#define SNAPSHOT_MAGIC "CSSN"
+#define SNAPSHOT_VERSION 5
+#define SNAPSHOT_MAX_RING (1 << 24)   /* Sanity bound on one ring's saved samples */
+
+static int ms_to_samples(int ms) {
+    return (int)((int64_t)ms * SAMPLE_RATE / 1000);
+}
+
+/*
+ * Longest predelay, room size and early diffuser delay a tier allows, in
+ * samples. A limit past the end of a knob curve becomes the curve's own
+ * maximum, so it never clamps and the buffers are sized to what is reached.
+ */
+static void memory_tier_limits(int tier, int *predelay, int *line, int *diffuser) {
+    const memory_tier_t *t = &g_memory_tiers[tier];
+    const knob_tables_t *k = &g_knob_tables;
+    int predelay_max = (int)k->predelay_samples[KNOB_TABLE_SIZE - 1];
+    int line_max = (int)k->line_delay_samples[KNOB_TABLE_SIZE - 1];
+
+    *predelay = ms_to_samples(t->max_predelay_ms);
+    if (*predelay > predelay_max) *predelay = predelay_max;
+    *line = ms_to_samples(t->max_size_ms);
+    if (*line > line_max) *line = line_max;
+    *diffuser = ms_to_samples(t->max_diffuser_ms);
+}
+
+/* Ring sizes for a tier; only huge gives buffers to lines past line_count */
+static void memory_tier_capacity(int tier, int line_count, channel_capacity_t *cap) {
+    const memory_tier_t *t = &g_memory_tiers[tier];
+    cap->active_lines = line_count < t->max_lines ? line_count : t->max_lines;
+    cap->lines = tier == CLOUDSEED_MEM_TIER_HUGE ? MAX_LINE_COUNT : cap->active_lines;
+
+    if (tier == CLOUDSEED_MEM_TIER_HUGE) {
+        cap->predelay = DELAY_BUFFER_SIZE;
+        cap->multitap = DELAY_BUFFER_SIZE;
+        cap->line = DELAY_BUFFER_SIZE;
+        cap->allpass = ALLPASS_BUFFER_SIZE;
+        return;
+    }
+
+    /* Diffuser stages scale modulation by up to 1.15; line seeds span 0.5-1.5x size */
+    int predelay, line, diffuser;
+    memory_tier_limits(tier, &predelay, &line, &diffuser);
+    int mod = (int)(MOD_DEPTH_MS * 1.15f * SAMPLE_RATE / 1000.0f) + 1;
+    cap->predelay = predelay + RING_MARGIN;
+    cap->multitap = cap->predelay;
+    cap->line = line * 3 / 2 + mod + RING_MARGIN;
+    cap->allpass = diffuser + mod + RING_MARGIN;
+}
+
+/* Everything channel coefficients are derived from */
+typedef struct {
+    /* Knobs (0-1 normalized) */
+    float input_mix;
+    float predelay;
+    float decay;
+    float size;
+    float diffusion;
+    float mix;
+    float early_late;
+    float low_cut;
+    float high_cut;
+    float cross_seed;
+    float mod_rate;
+    float mod_amount;
+
+    /* Modulation control period in samples (1 = per-sample LFO) */
+    int mod_update_rate;
+
+    /* Early reflections: EARLY_OFF, EARLY_MULTITAP or EARLY_VELVET, over early_taps taps */
+    int early_mode;
+    int early_taps;
+} engine_params_t;
+
+/* Buffer layout a channel pair is built for; changing it takes a rebuild */
+typedef struct {
+    int profile;                /* Memory tier asked for */
+    int line_count;             /* Delay lines asked for */
+} channel_topology_t;
+
+/*
+ * Left and right channels built for one topology, with what was allocated
+ * and reserved for them. A rebuild makes a new pair off the audio thread
+ * and swaps it in whole.
+ */
+typedef struct {
+    reverb_channel_t *l;
+    reverb_channel_t *r;
+    channel_topology_t topology;
+    int tier;                   /* Tier built; below profile when the budget forced it */
+    int max_predelay_samples;   /* Range limits of the tier */
+    int max_line_delay_samples;
+    int max_diffuser_delay_samples;
+    size_t budget_bytes;        /* Reserved from the module budget */
+    engine_allocator_t alloc;   /* Channel allocations only */
+
+    /* Coefficients were derived from params; tail figures follow from them */
+    engine_params_t params;
+    int tail_samples;
+    int tail_settle_samples;
+
+    /*
+     * Tail priming, advanced by the audio thread while the pair is READY:
+     * regions below prime_next are copied and kept level, prime_pos holding
+     * the live write position each was copied up to as of prime_clock.
+     */
+    int prime;
+    int prime_next;
+    uint32_t prime_clock;
+    int prime_pos[2][CHANNEL_REGIONS];
+} channel_pair_t;
+
+/* One bank entry: the knobs and the coefficient sets they derive to */
+typedef struct {
+    engine_params_t params;
+    channel_coefs_t coefs[2];
+    int tail_samples;
+    int tail_settle_samples;
+} preset_t;
+
+#define TRACE_RECORD_WORDS ((int)(sizeof(cloudseed_trace_record_t) / sizeof(uint32_t)))
+
+/* Trace ring slot access, word by word so a concurrent reader sees no torn word */
+static void trace_slot_store(uint32_t *slot, const cloudseed_trace_record_t *rec) {
+    uint32_t words[TRACE_RECORD_WORDS];
+    memcpy(words, rec, sizeof(words));
+    for (int i = 0; i < TRACE_RECORD_WORDS; i++)
+        __atomic_store_n(&slot[i], words[i], __ATOMIC_RELAXED);
+}
+
+static void trace_slot_load(const uint32_t *slot, cloudseed_trace_record_t *rec) {
+    uint32_t words[TRACE_RECORD_WORDS];
+    for (int i = 0; i < TRACE_RECORD_WORDS; i++)
+        words[i] = __atomic_load_n(&slot[i], __ATOMIC_RELAXED);
+    memcpy(rec, words, sizeof(words));
+}
+
+/*
+ * Snapshot layout: this header, the left and right channel structs as
+ * images (their buffer pointers only say which rings existed), then the
+ * live part of each ring, newest ring_samples[c][r] samples oldest first.
+ * Native byte order and struct layout: a snapshot is tied to the engine
+ * build that wrote it, which state_size and version check. Nothing in it
+ * is trusted: restore derives coefficients from the clamped params and
+ * takes only signal state from the images, checked against the rings.
+ */
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t state_size;        /* sizeof(engine_snapshot_t) + both channel images */
+    uint32_t sample_rate;
+    uint64_t total_size;
+
+    engine_params_t params;
+    channel_topology_t topology;
+    int tier;                   /* Tier the channels were built at */
+    int prime_tail;
+    int line_layout;
+    layout_calibration_t layout_cal[LAYOUT_BUCKETS];
+    int cleared;                /* Saved mid-clear: rings were dropped */
+    float mix_current;
+    int silent_input_samples;
+    int is_silent;
+    int ring_samples[2][CHANNEL_REGIONS];
+} engine_snapshot_t;
+
+struct cloudseed_engine {
+    engine_allocator_t alloc;   /* The engine struct itself; channels are in live.alloc */
+    int registered;             /* Counted in the module totals */
+
+    engine_params_t params;
+
+    /* Mix actually applied at the end of the last block; ramps toward params.mix */
+    float mix_current;
+
+    /* Reverb channels */
+    channel_pair_t live;
+
+    /*
+     * The multitap's FFT path, left and right. The first request for it
+     * (tap_conv_state) wakes the worker, which allocates it through
+     * conv_alloc and publishes tap_conv; the audio thread attaches it at
+     * the next block. The worker builds its spectra too.
+     */
+    tap_conv_t *tap_conv;
+    int tap_conv_state;
+    engine_allocator_t conv_alloc;  /* Read only once tap_conv is published */
+
+    /*
+     * Background rebuild. A setter stores the topology it wants and wakes
+     * the worker, which builds pending and moves rebuild_state to CAPTURE.
+     * At the next block boundary the audio thread copies its params and
+     * prime_tail into capture_* and moves it to CAPTURED; the worker
+     * derives pending's coefficients from that copy and moves it to READY.
+     * The worker never reads the live rings: with prime_tail the audio
+     * thread copies them into pending itself, a budget per block, and swaps
+     * once they are level; otherwise it swaps at once when silent, else
+     * behind a one-block wet fade-out and a fade-in. The old pair moves to
+     * retired (RETIRED) for the worker to free. sample_clock counts
+     * processed frames so priming can tell which rings may have wrapped.
+     */
+    channel_topology_t topology;
+    int prime_tail;
+    uint32_t sample_clock;
+    int rebuild_state;
+    engine_params_t capture_params;
+    int capture_prime;
+    int swap_fading;
+    channel_pair_t pending;
+    channel_pair_t retired;
+    pthread_t worker;
+    sem_t worker_wake;
+    int worker_running;
+    int worker_quit;
+
+    /*
+     * Snapshot copy. snapshot_begin asks the worker to build snapshot, a
+     * pair laid out like live; the audio thread primes it as it would a
+     * rebuild and, the block its rings are level, adopts the live state
+     * into it and fills snapshot_header (READY). The saving thread then
+     * serializes the copy, never the live pair. Rebuilds wait meanwhile.
+     */
+    int snapshot_state;
+    channel_pair_t snapshot;
+    engine_snapshot_t snapshot_header;
+
+    /*
+     * Lazy tail clear. clear_tail bumps clear_requested; the audio thread
+     * picks up the new epoch, fades the wet signal out over one block,
+     * then zeroes buffers in bounded slices while the wet output is muted.
+     */
+    int clear_requested;
+    int clear_epoch;
+    int clear_fading;
+    int clearing;
+    int clear_channel;
+    int clear_region;
+    int clear_offset;
+
+    /*
+     * Tail tracking. tail_samples is the analytic ring-out after the input
+     * goes quiet; is_silent also requires the live wet output to be below
+     * one LSB once every path through the network has been flushed.
+     */
+    int tail_samples;
+    int tail_settle_samples;
+    int silent_input_samples;
+    int is_silent;
+
+    /* Line processing layout; AUTO times both per block size and keeps the faster */
+    int line_layout;
+    layout_calibration_t layout_cal[LAYOUT_BUCKETS];
+
+    /* Set by the setters, reported and cleared by the next block's trace record */
+    int param_changed;
+
+    /*
+     * Preset bank. set_presets derives every preset's coefficient sets on
+     * the calling thread; recall stores index + 1 in preset_pending and the
+     * next block copies that set into the live channels.
+     */
+    engine_allocator_t preset_alloc;
+    preset_t *presets;
+    int preset_count;
+    int preset_limits[4];       /* Live pair limits the bank was derived at */
+    int preset_pending;
+
+    /*
+     * Morph between two bank presets. set_morph marks it dirty and the next
+     * block blends the two coefficient sets into the live channels. While
+     * morph_seeded, the live seeds and tap tables are morph_from's, so a
+     * move between the ends writes only the blended fields.
+     */
+    int morph_from;
+    int morph_to;
+    float morph_amount;
+    int morph_dirty;
+    int morph_seeded;
+
+    /*
+     * Block trace ring. Only the audio thread writes: it fills the slot for
+     * trace_count, then publishes trace_count + 1 with release ordering.
+     * trace_snapshot copies without locking and drops any record the writer
+     * may have reached while it was copying. Slots are moved as relaxed
+     * atomic words so that torn copies are dropped rather than racing.
+     */
+    uint32_t trace[CLOUDSEED_TRACE_RECORDS][TRACE_RECORD_WORDS];
+    uint32_t trace_count;
+};
+
+static void engine_log(const cloudseed_engine_t *e, const char *msg) {
+    if (e->alloc.hooks.log)
+        e->alloc.hooks.log(e->alloc.hooks.user, msg);
+}
+
+/* Derives every coefficient of a pair from p; safe off the audio thread for a pair not yet live */
+static void pair_apply_parameters(channel_pair_t *pair, const engine_params_t *p) {
+    int samplerate = SAMPLE_RATE;
+    const knob_tables_t *t = &g_knob_tables;
+
+    /* Pre-delay: 0-500ms using Resp2dec curve */
+    int predelay_samples = (int)knob_lookup(t->predelay_samples, p->predelay);
+    if (predelay_samples > pair->max_predelay_samples) predelay_samples = pair->max_predelay_samples;
+    if (predelay_samples < 1) predelay_samples = 1;
+    pair->l->predelay.sample_delay_target = predelay_samples;
+    pair->r->predelay.sample_delay_target = predelay_samples;
+
+    /* Room size: 20-1000ms using Resp2dec curve */
+    int line_delay_samples = (int)knob_lookup(t->line_delay_samples, p->size);
+    if (line_delay_samples > pair->max_line_delay_samples) line_delay_samples = pair->max_line_delay_samples;
+
+    /* Decay: 0.05-60 seconds using Resp3dec curve */
+    float line_decay_samples = knob_lookup(t->line_decay_samples, p->decay);
+
+    /* Modulation amounts */
+    float mod_rate_hz = knob_lookup(t->mod_rate_hz, p->mod_rate);
+    float line_mod_amount = p->mod_amount * 2.5f * samplerate / 1000.0f;
+    float line_mod_rate = mod_rate_hz;
+
+    float late_diff_mod_amount = p->mod_amount * 2.5f * samplerate / 1000.0f;
+    float late_diff_mod_rate = mod_rate_hz;
+
+    /* Update delay lines */
+    channel_update_lines(pair->l, line_delay_samples, line_decay_samples,
+                          line_mod_amount, line_mod_rate,
+                          late_diff_mod_amount, late_diff_mod_rate);
+    channel_update_lines(pair->r, line_delay_samples, line_decay_samples,
+                          line_mod_amount, line_mod_rate,
+                          late_diff_mod_amount, late_diff_mod_rate);
+
+    /* Early diffuser settings */
+    int diff_stages = 4 + (int)(p->diffusion * 7.999f);
+    pair->l->diffuser.stages = diff_stages;
+    pair->r->diffuser.stages = diff_stages;
+
+    float diff_delay_ms = 10.0f + p->size * 90.0f;
+    int diff_delay = (int)(diff_delay_ms / 1000.0f * samplerate);
+    if (diff_delay > pair->max_diffuser_delay_samples) diff_delay = pair->max_diffuser_delay_samples;
+    diffuser_set_delay(&pair->l->diffuser, diff_delay);
+    diffuser_set_delay(&pair->r->diffuser, diff_delay);
+
+    diffuser_set_feedback(&pair->l->diffuser, p->diffusion);
+    diffuser_set_feedback(&pair->r->diffuser, p->diffusion);
+
+    float diff_mod_amount = p->mod_amount * 2.5f * samplerate / 1000.0f;
+    diffuser_set_mod_amount(&pair->l->diffuser, diff_mod_amount);
+    diffuser_set_mod_amount(&pair->r->diffuser, diff_mod_amount);
+
+    float diff_mod_rate = mod_rate_hz;
+    diffuser_set_mod_rate(&pair->l->diffuser, diff_mod_rate);
+    diffuser_set_mod_rate(&pair->r->diffuser, diff_mod_rate);
+
+    /* Input filters */
+    float low_cut_hz = knob_lookup(t->low_cut_hz, p->low_cut);
+    float low_cut_alpha = knob_lookup(t->low_cut_alpha, p->low_cut);
+    float high_cut_hz = knob_lookup(t->high_cut_hz, p->high_cut);
+    float high_cut_alpha = knob_lookup(t->high_cut_alpha, p->high_cut);
+    hp1_set_cutoff_alpha(&pair->l->high_pass, low_cut_hz, low_cut_alpha);
+    hp1_set_cutoff_alpha(&pair->r->high_pass, low_cut_hz, low_cut_alpha);
+    lp1_set_cutoff_alpha(&pair->l->low_pass, high_cut_hz, high_cut_alpha);
+    lp1_set_cutoff_alpha(&pair->r->low_pass, high_cut_hz, high_cut_alpha);
+
+    /* Cross seed for stereo */
+    channel_set_cross_seed(pair->l, p->cross_seed);
+    channel_set_cross_seed(pair->r, p->cross_seed);
+    channel_update_post_diffusion(pair->l);
+    channel_update_post_diffusion(pair->r);
+
+    /* Early reflections on the seeded tap pattern */
+    channel_set_early_mode(pair->l, p->early_mode, p->early_taps);
+    channel_set_early_mode(pair->r, p->early_mode, p->early_taps);
+
+    /* EQ cutoff in delay lines (damping), one coefficient block per channel */
+    float eq_cutoff = knob_lookup(t->damping_hz, p->high_cut);
+    float eq_alpha = knob_lookup(t->damping_alpha, p->high_cut);
+    line_filters_set_cutoff_alpha(&pair->l->line_filters, eq_cutoff, eq_alpha);
+    line_filters_set_cutoff_alpha(&pair->r->line_filters, eq_cutoff, eq_alpha);
+    pair->l->line_filters.cutoff_enabled = 1;
+    pair->r->line_filters.cutoff_enabled = 1;
+
+    /* Output mix: early/late balance, 0 = late only, 0.5 = both full, 1 = early only */
+    float early_out = p->early_late * 2.0f;
+    float line_out = (1.0f - p->early_late) * 2.0f;
+    if (early_out > 1.0f) early_out = 1.0f;
+    if (line_out > 1.0f) line_out = 1.0f;
+
+    pair->l->dry_out = 0.0f;
+    pair->r->dry_out = 0.0f;
+    pair->l->early_out = early_out;
+    pair->r->early_out = early_out;
+    pair->l->line_out = line_out;
+    pair->r->line_out = line_out;
+
+    /* Tail estimate: one pass through the network, then decay to the floor */
+    int settle_l = channel_settle_samples(pair->l);
+    int settle_r = channel_settle_samples(pair->r);
+    pair->tail_settle_samples = settle_l > settle_r ? settle_l : settle_r;
+    pair->tail_samples = pair->tail_settle_samples
+                       + (int)(line_decay_samples * (TAIL_FLOOR_DB / 60.0f));
+    pair->params = *p;
+}
+
+static void engine_apply_parameters(cloudseed_engine_t *e) {
+    e->morph_seeded = 0;
+    pair_apply_parameters(&e->live, &e->params);
+    e->tail_samples = e->live.tail_samples;
+    e->tail_settle_samples = e->live.tail_settle_samples;
+}
+
+/* True when every int16 sample is 0, i.e. the input peak is below SILENCE_THRESHOLD */
+static int input_is_silent(const int16_t *audio, int frames) {
+    int16_t bits = 0;
+    for (int i = 0; i < frames * 2; i++)
+        bits |= audio[i];
+    return bits == 0;
+}
+
+/* Updates is_silent from this block's input and wet peaks */
+static void engine_track_silence(cloudseed_engine_t *e, float in_peak, float wet_peak, int frames) {
+    if (in_peak >= SILENCE_THRESHOLD) {
+        e->silent_input_samples = 0;
+        e->is_silent = 0;
+        return;
+    }
+
+    if (e->silent_input_samples < e->tail_samples)
+        e->silent_input_samples += frames;
+
+    e->is_silent = e->silent_input_samples >= e->tail_samples ||
+                   (e->silent_input_samples >= e->tail_settle_samples &&
+                    wet_peak < SILENCE_THRESHOLD);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int layout_bucket(int frames) {
+    if (frames <= 32) return 0;
+    if (frames <= 64) return 1;
+    return 2;
+}
+
+/*
+ * Picks the line layout for a chunk. While calibrating, alternates the two
+ * layouts and returns the calibration slot to time (NULL if not timing).
+ */
+static int engine_pick_layout(cloudseed_engine_t *e, int frames, layout_calibration_t **timing) {
+    *timing = NULL;
+    if (e->line_layout != LINE_LAYOUT_AUTO)
+        return e->line_layout;
+
+    layout_calibration_t *cal = &e->layout_cal[layout_bucket(frames)];
+    if (cal->choice >= 0)
+        return cal->choice;
+
+    /* Silent tails skip most work and would skew the comparison */
+    if (!e->is_silent)
+        *timing = cal;
+    return cal->blocks[LINE_LAYOUT_BLOCK] <= cal->blocks[LINE_LAYOUT_SAMPLE]
+         ? LINE_LAYOUT_BLOCK : LINE_LAYOUT_SAMPLE;
+}
+
+static void engine_record_layout(layout_calibration_t *cal, int layout, uint64_t ns) {
+    cal->ns[layout] += ns;
+    cal->blocks[layout]++;
+
+    if (cal->blocks[LINE_LAYOUT_BLOCK] >= LAYOUT_CALIBRATION_BLOCKS &&
+        cal->blocks[LINE_LAYOUT_SAMPLE] >= LAYOUT_CALIBRATION_BLOCKS) {
+        cal->choice = cal->ns[LINE_LAYOUT_SAMPLE] < cal->ns[LINE_LAYOUT_BLOCK]
+                    ? LINE_LAYOUT_SAMPLE : LINE_LAYOUT_BLOCK;
+    }
+}
+
+/* Advances an in-progress lazy clear by one block's budget */
+static void engine_clear_step(cloudseed_engine_t *e, int frames) {
+    int budget = CLEAR_SAMPLES_PER_FRAME * frames;
+
+    while (budget > 0 && e->clearing) {
+        reverb_channel_t *ch = e->clear_channel == 0 ? e->live.l : e->live.r;
+        if (!channel_clear_step(ch, &e->clear_region, &e->clear_offset, &budget))
+            break;
+
+        e->clear_region = 0;
+        e->clear_offset = 0;
+        if (++e->clear_channel > 1) {
+            channel_reset_state(e->live.l);
+            channel_reset_state(e->live.r);
+            e->clearing = 0;
+        }
+    }
+}
+
+static float *param_slot(engine_params_t *params, cloudseed_param_t param) {
+    switch (param) {
+        case CLOUDSEED_PARAM_PREDELAY:   return &params->predelay;
+        case CLOUDSEED_PARAM_DECAY:      return &params->decay;
+        case CLOUDSEED_PARAM_SIZE:       return &params->size;
+        case CLOUDSEED_PARAM_DIFFUSION:  return &params->diffusion;
+        case CLOUDSEED_PARAM_MIX:        return &params->mix;
+        case CLOUDSEED_PARAM_EARLY_LATE: return &params->early_late;
+        case CLOUDSEED_PARAM_LOW_CUT:    return &params->low_cut;
+        case CLOUDSEED_PARAM_HIGH_CUT:   return &params->high_cut;
+        case CLOUDSEED_PARAM_CROSS_SEED: return &params->cross_seed;
+        case CLOUDSEED_PARAM_MOD_RATE:   return &params->mod_rate;
+        case CLOUDSEED_PARAM_MOD_AMOUNT: return &params->mod_amount;
+        default:                         return NULL;
+    }
+}
+
+/* Bytes a channel pair at this tier allocates */
+static size_t memory_tier_bytes(int tier, int line_count) {
+    channel_capacity_t cap;
+    memory_tier_capacity(tier, line_count, &cap);
+    return 2 * (sizeof(reverb_channel_t) + channel_buffer_bytes(&cap));
+}
+
+static void channel_pair_release(channel_pair_t *pair) {
+    if (pair->l) {
+        channel_free(pair->l, &pair->alloc);
+        engine_free(&pair->alloc, pair->l);
+        pair->l = NULL;
+    }
+    if (pair->r) {
+        channel_free(pair->r, &pair->alloc);
+        engine_free(&pair->alloc, pair->r);
+        pair->r = NULL;
+    }
+}
+
+/*
+ * Allocates both channels at a tier; returns 0 on success, -1 with nothing
+ * left allocated. engine_alloc zeroes every buffer, so the pages are
+ * faulted in here rather than on the audio thread's first pass.
+ */
+static int channel_pair_build(channel_pair_t *pair, int tier, int line_count,
+                              const cloudseed_hooks_t *hooks) {
+    channel_capacity_t cap;
+    memory_tier_capacity(tier, line_count, &cap);
+
+    memset(pair, 0, sizeof(*pair));
+    pair->alloc.hooks = *hooks;
+    pair->l = (reverb_channel_t*)engine_alloc(&pair->alloc, CLOUDSEED_MEM_STATE, sizeof(reverb_channel_t));
+    pair->r = (reverb_channel_t*)engine_alloc(&pair->alloc, CLOUDSEED_MEM_STATE, sizeof(reverb_channel_t));
+
+    int failed = !pair->l || !pair->r;
+    if (!failed) {
+        channel_account_memory(&pair->alloc);
+        channel_account_memory(&pair->alloc);
+        failed |= channel_init(pair->l, SAMPLE_RATE, 0, &cap, &pair->alloc) != 0;
+        failed |= channel_init(pair->r, SAMPLE_RATE, 1, &cap, &pair->alloc) != 0;
+    }
+    if (failed) {
+        channel_pair_release(pair);
+        return -1;
+    }
+
+    pair->tier = tier;
+    memory_tier_limits(tier, &pair->max_predelay_samples, &pair->max_line_delay_samples,
+                       &pair->max_diffuser_delay_samples);
+    return 0;
+}
+
+/*
+ * Memory governor: builds the pair at the largest tier from the profile
+ * down whose footprint fits the engine's own limit and what is left of the
+ * module budget, dropping a tier on allocation failure too. The minimal
+ * tier is built even over budget rather than failing.
+ */
+static int engine_build_pair(cloudseed_engine_t *e, channel_pair_t *pair,
+                             const channel_topology_t *topology) {
+    size_t limit = e->alloc.hooks.memory_limit;
+    for (int tier = topology->profile; tier < CLOUDSEED_MEM_TIERS; tier++) {
+        size_t bytes = memory_tier_bytes(tier, topology->line_count);
+        int last = tier == CLOUDSEED_MEM_TIERS - 1;
+        if (limit && bytes > limit && !last)
+            continue;
+        if (!budget_reserve(bytes, last))
+            continue;
+        if (channel_pair_build(pair, tier, topology->line_count, &e->alloc.hooks) != 0) {
+            budget_release(bytes);
+            continue;
+        }
+
+        pair->topology = *topology;
+        pair->budget_bytes = bytes;
+        if (tier != topology->profile) {
+            const memory_tier_t *t = &g_memory_tiers[tier];
+            char msg[128];
+            snprintf(msg, sizeof(msg), "Memory budget: built at %s tier (predelay <= %d ms, size <= %d ms, %d lines)",
+                     t->name, t->max_predelay_ms, t->max_size_ms, pair->l->line_count);
+            engine_log(e, msg);
+        }
+        return 0;
+    }
+    return -1;
+}
+
+/* Frees a pair that has left the audio thread and returns its memory */
+static void engine_drop_pair(channel_pair_t *pair) {
+    engine_mem_register(&pair->alloc, -1);
+    budget_release(pair->budget_bytes);
+    channel_pair_release(pair);
+}
+
+/* Audio thread: hands the worker the live params to prepare pending from */
+static void engine_capture_rebuild(cloudseed_engine_t *e) {
+    e->capture_params = e->params;
+    e->capture_prime = __atomic_load_n(&e->prime_tail, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->rebuild_state, REBUILD_CAPTURED, __ATOMIC_RELEASE);
+    sem_post(&e->worker_wake);
+}
+
+/* Nothing copied into pair yet */
+static void pair_prime_reset(channel_pair_t *pair) {
+    pair->prime_next = 0;
+    for (int r = 0; r < CHANNEL_REGIONS; r++) {
+        pair->prime_pos[0][r] = -1;
+        pair->prime_pos[1][r] = -1;
+    }
+}
+
+/*
+ * Worker: readies a freshly built pair for the swap from the captured
+ * params; the swap recomputes if the live params have moved on since.
+ */
+static void engine_prepare_pair(cloudseed_engine_t *e, channel_pair_t *pair) {
+    const engine_params_t *params = &e->capture_params;
+    channel_set_mod_update_rate(pair->l, params->mod_update_rate);
+    channel_set_mod_update_rate(pair->r, params->mod_update_rate);
+    pair_apply_parameters(pair, params);
+    channel_snap_delays(pair->l);
+    channel_snap_delays(pair->r);
+
+    pair->prime = e->capture_prime;
+    pair_prime_reset(pair);
+}
+
+/*
+ * Audio thread: advances tail priming of p (pending or the snapshot copy)
+ * by one block's budget, before the block is processed. Rings already
+ * copied are brought level with what the live pair wrote since, then
+ * further rings are copied whole. Returns 1 once every ring is level, so
+ * p matches the live rings as of now.
+ */
+static int engine_prime_step(cloudseed_engine_t *e, channel_pair_t *p, int frames) {
+    uint32_t elapsed = e->sample_clock - p->prime_clock;
+    int budget = PRIME_SAMPLES_PER_FRAME * frames;
+
+    p->prime_clock = e->sample_clock;
+    for (int r = 0; r < p->prime_next; r++) {
+        budget -= channel_prime_region(p->l, e->live.l, r, &p->prime_pos[0][r], elapsed);
+        budget -= channel_prime_region(p->r, e->live.r, r, &p->prime_pos[1][r], elapsed);
+    }
+    while (p->prime_next < CHANNEL_REGIONS && budget > 0) {
+        int r = p->prime_next++;
+        budget -= channel_prime_region(p->l, e->live.l, r, &p->prime_pos[0][r], 0);
+        budget -= channel_prime_region(p->r, e->live.r, r, &p->prime_pos[1][r], 0);
+    }
+    return p->prime_next == CHANNEL_REGIONS;
+}
+
+/* Worker: builds the snapshot copy at the live tier and line count; live only changes in a swap */
+static void engine_build_snapshot(cloudseed_engine_t *e) {
+    channel_pair_t *pair = &e->snapshot;
+    int lines = e->live.topology.line_count;
+    size_t bytes = memory_tier_bytes(e->live.tier, lines);
+    int state = SNAPSHOT_FAILED;
+
+    if (budget_reserve(bytes, 0)) {
+        if (channel_pair_build(pair, e->live.tier, lines, &e->alloc.hooks) == 0) {
+            pair->topology = e->live.topology;
+            pair->budget_bytes = bytes;
+            pair_prime_reset(pair);
+            engine_mem_register(&pair->alloc, 1);
+            state = SNAPSHOT_PRIMING;
+        } else {
+            budget_release(bytes);
+        }
+    }
+    if (state == SNAPSHOT_FAILED)
+        engine_log(e, "Snapshot failed: out of memory");
+    __atomic_store_n(&e->snapshot_state, state, __ATOMIC_RELEASE);
+}
+
+/* Live channels run the engine's FFT path; its input history restarts with them */
+static void engine_attach_tap_conv(cloudseed_engine_t *e) {
+    tap_conv_t *conv = __atomic_load_n(&e->tap_conv, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < 2; i++) {
+        reverb_channel_t *ch = i ? e->live.r : e->live.l;
+        ch->tap_conv = conv ? &conv[i] : NULL;
+        if (ch->tap_conv)
+            tap_conv_reset(ch->tap_conv);
+    }
+}
+
+/* Asks the worker for the FFT path once multitap early reflections reach CONV_MIN_TAPS taps */
+static void engine_want_tap_conv(cloudseed_engine_t *e) {
+    if (!e->worker_running || e->params.early_mode != EARLY_MULTITAP ||
+        e->params.early_taps < CONV_MIN_TAPS)
+        return;
+    int expected = TAP_CONV_NONE;
+    if (__atomic_compare_exchange_n(&e->tap_conv_state, &expected, TAP_CONV_WANTED, 0,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        sem_post(&e->worker_wake);
+}
+
+/* Worker: allocates the FFT path from the module budget; without it the plain sum runs */
+static void engine_build_tap_conv(cloudseed_engine_t *e) {
+    size_t bytes = 2 * sizeof(tap_conv_t);
+    tap_conv_t *conv = NULL;
+    e->conv_alloc.hooks = e->alloc.hooks;
+    if (budget_reserve(bytes, 0)) {
+        conv = (tap_conv_t*)engine_alloc(&e->conv_alloc, CLOUDSEED_MEM_EARLY_FFT, bytes);
+        if (!conv)
+            budget_release(bytes);
+    }
+    if (conv) {
+        tap_conv_init(&conv[0], &e->worker_wake);
+        tap_conv_init(&conv[1], &e->worker_wake);
+        engine_mem_register(&e->conv_alloc, 1);
+        __atomic_store_n(&e->tap_conv, conv, __ATOMIC_RELEASE);
+    } else {
+        engine_log(e, "No FFT path: high early tap counts run as plain multitaps");
+    }
+    __atomic_store_n(&e->tap_conv_state, TAP_CONV_DONE, __ATOMIC_RELAXED);
+}
+
+/* Worker: builds wanted tap spectra, frees the retired pair, then builds one if the requested topology changed */
+static void engine_worker_step(cloudseed_engine_t *e) {
+    if (__atomic_load_n(&e->tap_conv_state, __ATOMIC_RELAXED) == TAP_CONV_WANTED)
+        engine_build_tap_conv(e);
+    if (e->tap_conv) {
+        tap_conv_build(&e->tap_conv[0]);
+        tap_conv_build(&e->tap_conv[1]);
+    }
+
+    int state = __atomic_load_n(&e->rebuild_state, __ATOMIC_ACQUIRE);
+    if (state == REBUILD_RETIRED) {
+        engine_drop_pair(&e->retired);
+        state = REBUILD_IDLE;
+        __atomic_store_n(&e->rebuild_state, state, __ATOMIC_RELEASE);
+    } else if (state == REBUILD_CAPTURED) {
+        engine_prepare_pair(e, &e->pending);
+        __atomic_store_n(&e->rebuild_state, REBUILD_READY, __ATOMIC_RELEASE);
+        return;
+    }
+
+    /* A snapshot copy is built only between rebuilds, and holds the next one back */
+    int snapshot = __atomic_load_n(&e->snapshot_state, __ATOMIC_ACQUIRE);
+    if (snapshot == SNAPSHOT_REQUESTED && state == REBUILD_IDLE) {
+        engine_build_snapshot(e);
+        return;
+    }
+    if (snapshot == SNAPSHOT_PRIMING)
+        return;
+
+    channel_topology_t want;
+    want.profile = __atomic_load_n(&e->topology.profile, __ATOMIC_RELAXED);
+    want.line_count = __atomic_load_n(&e->topology.line_count, __ATOMIC_RELAXED);
+    if (state != REBUILD_IDLE || memcmp(&want, &e->live.topology, sizeof(want)) == 0)
+        return;
+
+    if (engine_build_pair(e, &e->pending, &want) != 0) {
+        engine_log(e, "Rebuild failed: out of memory");
+        return;
+    }
+    engine_mem_register(&e->pending.alloc, 1);
+    __atomic_store_n(&e->rebuild_state, REBUILD_CAPTURE, __ATOMIC_RELEASE);
+}
+
+static void *engine_worker(void *arg) {
+    cloudseed_engine_t *e = (cloudseed_engine_t*)arg;
+    for (;;) {
+        while (sem_wait(&e->worker_wake) != 0 && errno == EINTR) {}
+        if (__atomic_load_n(&e->worker_quit, __ATOMIC_ACQUIRE))
+            break;
+        engine_worker_step(e);
+    }
+    return NULL;
+}
+
+/*
+ * Audio thread: makes the pending pair live and hands the old one to the
+ * worker. primed carries the old tail over (engine_prime_step has brought
+ * the rings level); otherwise the new pair starts empty at its target
+ * delays.
+ */
+static void engine_swap_channels(cloudseed_engine_t *e, int primed) {
+    e->retired = e->live;
+    e->live = e->pending;
+    memset(&e->pending, 0, sizeof(e->pending));
+
+    /* Primed pairs took over the old coefficients; redo them only if the tier limits moved */
+    int limits_changed = e->live.max_predelay_samples != e->retired.max_predelay_samples ||
+                         e->live.max_line_delay_samples != e->retired.max_line_delay_samples ||
+                         e->live.max_diffuser_delay_samples != e->retired.max_diffuser_delay_samples;
+    if (primed) {
+        channel_adopt(e->live.l, e->retired.l);
+        channel_adopt(e->live.r, e->retired.r);
+    }
+
+    if (memcmp(&e->live.params, &e->params, sizeof(e->params)) != 0 || (primed && limits_changed)) {
+        channel_set_mod_update_rate(e->live.l, e->params.mod_update_rate);
+        channel_set_mod_update_rate(e->live.r, e->params.mod_update_rate);
+        engine_apply_parameters(e);
+    } else if (!primed) {
+        e->tail_samples = e->live.tail_samples;
+        e->tail_settle_samples = e->live.tail_settle_samples;
+    }
+    if (primed) {
+        channel_fit_delays(e->live.l);
+        channel_fit_delays(e->live.r);
+    }
+    if (primed && e->clearing) {
+        /* A clear began while priming: it restarts on the rings just copied */
+        e->clear_channel = 0;
+        e->clear_region = 0;
+        e->clear_offset = 0;
+    } else {
+        e->clearing = 0;
+    }
+    e->morph_seeded = 0;
+    engine_attach_tap_conv(e);
+
+    __atomic_store_n(&e->rebuild_state, REBUILD_RETIRED, __ATOMIC_RELEASE);
+    sem_post(&e->worker_wake);
+}
+
+/* ============================================================================
+ * PRESET BANK - Coefficient sets derived once, installed at a block boundary
+ * ============================================================================ */
+
+/* What a pair's coefficients are clamped to and its tail figures counted over */
+static void pair_preset_limits(const channel_pair_t *pair, int limits[4]) {
+    limits[0] = pair->max_predelay_samples;
+    limits[1] = pair->max_line_delay_samples;
+    limits[2] = pair->max_diffuser_delay_samples;
+    limits[3] = pair->l->line_count;
+}
+
+static void engine_free_presets(cloudseed_engine_t *e) {
+    if (!e->presets) return;
+
+    engine_mem_register(&e->preset_alloc, -1);
+    budget_release((size_t)e->preset_count * sizeof(preset_t));
+    engine_free(&e->preset_alloc, e->presets);
+    memset(e->preset_alloc.bytes, 0, sizeof(e->preset_alloc.bytes));
+    e->preset_alloc.allocations = 0;
+    e->presets = NULL;
+    e->preset_count = 0;
+    __atomic_store_n(&e->preset_pending, 0, __ATOMIC_RELAXED);
+    e->morph_dirty = 0;
+    e->morph_seeded = 0;
+}
+
+/*
+ * Derives a preset on scratch copies of the live channels, so the sets
+ * carry the live limits. Applied twice: the first pass still draws the
+ * line seeds from the scratch's previous cross seed.
+ */
+static void pair_derive_preset(channel_pair_t *scratch, preset_t *preset) {
+    pair_apply_parameters(scratch, &preset->params);
+    pair_apply_parameters(scratch, &preset->params);
+    channel_coefs_capture(scratch->l, &preset->coefs[0]);
+    channel_coefs_capture(scratch->r, &preset->coefs[1]);
+    preset->tail_samples = scratch->tail_samples;
+    preset->tail_settle_samples = scratch->tail_settle_samples;
+}
+
+/* Whether the bank's sets still fit the live pair */
+static int engine_presets_fit(const cloudseed_engine_t *e) {
+    int limits[4];
+    pair_preset_limits(&e->live, limits);
+    return memcmp(limits, e->preset_limits, sizeof(limits)) == 0;
+}
+
+/*
+ * Makes knobs the live params. Input mix, the mod update rate and the
+ * early reflections are settings, not part of a preset, and stay as they are.
+ */
+static void engine_set_preset_params(cloudseed_engine_t *e, const engine_params_t *knobs) {
+    engine_params_t params = *knobs;
+    params.input_mix = e->params.input_mix;
+    params.mod_update_rate = e->params.mod_update_rate;
+    params.early_mode = e->params.early_mode;
+    params.early_taps = e->params.early_taps;
+    e->params = params;
+    e->live.params = params;
+    e->param_changed = 1;
+}
+
+/* Bank tails leave the early reflections out; the live early mode adds its pattern length */
+static void engine_set_preset_tail(cloudseed_engine_t *e, int tail_samples, int tail_settle_samples) {
+    if (e->params.early_mode != EARLY_OFF) {
+        int early = (int)e->live.l->multitap.length_samples;
+        tail_samples += early;
+        tail_settle_samples += early;
+    }
+    e->live.tail_samples = tail_samples;
+    e->live.tail_settle_samples = tail_settle_samples;
+    e->tail_samples = tail_samples;
+    e->tail_settle_samples = tail_settle_samples;
+}
+
+static void engine_install_preset(cloudseed_engine_t *e, const preset_t *preset) {
+    channel_coefs_install(e->live.l, &preset->coefs[0]);
+    channel_coefs_install(e->live.r, &preset->coefs[1]);
+    engine_set_preset_tail(e, preset->tail_samples, preset->tail_settle_samples);
+}
+
+/*
+ * After a rebuild moved the limits the sets may not fit, so the knobs are
+ * applied the slow way instead, twice like the derivation so the result
+ * does not depend on what was playing before.
+ */
+static void engine_apply_preset_params(cloudseed_engine_t *e) {
+    engine_apply_parameters(e);
+    engine_apply_parameters(e);
+}
+
+/* Audio thread: installs a recalled preset */
+static void engine_take_preset(cloudseed_engine_t *e) {
+    int pending = __atomic_exchange_n(&e->preset_pending, 0, __ATOMIC_ACQUIRE);
+    if (pending <= 0 || pending > e->preset_count) return;
+
+    const preset_t *preset = &e->presets[pending - 1];
+    engine_set_preset_params(e, &preset->params);
+    if (!engine_presets_fit(e)) {
+        engine_apply_preset_params(e);
+        return;
+    }
+    engine_install_preset(e, preset);
+    e->morph_seeded = 0;
+}
+
+/*
+ * Audio thread: blends the two morph presets. The ends install their
+ * sets whole; in between only the blended fields are written, over
+ * morph_from's seeds, with the longer of the two tail estimates.
+ */
+static void engine_take_morph(cloudseed_engine_t *e) {
+    if (!e->morph_dirty) return;
+    e->morph_dirty = 0;
+
+    const preset_t *a = &e->presets[e->morph_from];
+    const preset_t *b = &e->presets[e->morph_to];
+    float t = e->morph_amount;
+
+    engine_params_t knobs = a->params;
+    for (int p = 0; p < CLOUDSEED_PARAM_COUNT; p++) {
+        float *slot = param_slot(&knobs, (cloudseed_param_t)p);
+        *slot = coef_lerp(*slot, *param_slot((engine_params_t*)&b->params, (cloudseed_param_t)p), t);
+    }
+    engine_set_preset_params(e, &knobs);
+    if (!engine_presets_fit(e)) {
+        engine_apply_preset_params(e);
+        return;
+    }
+
+    if (t <= 0.0f || t >= 1.0f) {
+        engine_install_preset(e, t <= 0.0f ? a : b);
+        e->morph_seeded = t <= 0.0f;
+        return;
+    }
+    if (!e->morph_seeded) {
+        engine_install_preset(e, a);
+        e->morph_seeded = 1;
+    }
+    channel_coefs_morph(e->live.l, &a->coefs[0], &b->coefs[0], t);
+    channel_coefs_morph(e->live.r, &a->coefs[1], &b->coefs[1], t);
+    engine_set_preset_tail(e,
+                           a->tail_samples > b->tail_samples ? a->tail_samples : b->tail_samples,
+                           a->tail_settle_samples > b->tail_settle_samples ?
+                               a->tail_settle_samples : b->tail_settle_samples);
+}
+
+/* ============================================================================
+ * SNAPSHOT - Full DSP state, copied at a block boundary, restored at create
+ * ============================================================================ */
+
+/* Audio thread: completes the snapshot copy, its rings level with live, at a block boundary */
+static void engine_capture_snapshot(cloudseed_engine_t *e) {
+    engine_snapshot_t *snap = &e->snapshot_header;
+    channel_adopt(e->snapshot.l, e->live.l);
+    channel_adopt(e->snapshot.r, e->live.r);
+
+    memset(snap, 0, sizeof(*snap));
+    snap->params = e->params;
+    snap->topology = e->topology;
+    snap->tier = e->live.tier;
+    snap->prime_tail = e->prime_tail;
+    snap->line_layout = e->line_layout;
+    memcpy(snap->layout_cal, e->layout_cal, sizeof(snap->layout_cal));
+    snap->cleared = e->clearing || e->clear_fading;
+    snap->mix_current = e->mix_current;
+    snap->silent_input_samples = e->silent_input_samples;
+    snap->is_silent = e->is_silent;
+
+    __atomic_store_n(&e->snapshot_state, SNAPSHOT_READY, __ATOMIC_RELEASE);
+    sem_post(&e->worker_wake);
+}
+
+/* The captured header with the copy's ring extents; returns the snapshot's size in bytes */
+static size_t engine_snapshot_header(const cloudseed_engine_t *e, engine_snapshot_t *snap) {
+    *snap = e->snapshot_header;
+    memcpy(snap->magic, SNAPSHOT_MAGIC, 4);
+    snap->version = SNAPSHOT_VERSION;
+    snap->state_size = (uint32_t)(sizeof(engine_snapshot_t) + 2 * sizeof(reverb_channel_t));
+    snap->sample_rate = SAMPLE_RATE;
+
+    size_t samples = 0;
+    for (int c = 0; c < 2; c++) {
+        reverb_channel_t *ch = c ? e->snapshot.r : e->snapshot.l;
+        for (int r = 0; r < CHANNEL_REGIONS; r++) {
+            snap->ring_samples[c][r] = snap->cleared ? 0 : channel_region_live(ch, r);
+            samples += snap->ring_samples[c][r];
+        }
+    }
+    snap->total_size = snap->state_size + samples * sizeof(float);
+    return (size_t)snap->total_size;
+}
+
+/* Checks a snapshot's header against its size and this build; returns 0 if usable */
+static int engine_snapshot_check(const void *data, size_t size) {
+    const engine_snapshot_t *snap = (const engine_snapshot_t*)data;
+    if (!data || size < sizeof(*snap) || ((uintptr_t)data % _Alignof(reverb_channel_t)) != 0)
+        return -1;
+    if (memcmp(snap->magic, SNAPSHOT_MAGIC, 4) != 0 || snap->version != SNAPSHOT_VERSION ||
+        snap->state_size != sizeof(engine_snapshot_t) + 2 * sizeof(reverb_channel_t) ||
+        snap->sample_rate != SAMPLE_RATE || snap->total_size != size)
+        return -1;
+    if (snap->topology.profile < 0 || snap->topology.profile >= CLOUDSEED_MEM_TIERS ||
+        snap->tier < 0 || snap->tier >= CLOUDSEED_MEM_TIERS ||
+        snap->topology.line_count < 1 || snap->topology.line_count > MAX_LINE_COUNT)
+        return -1;
+
+    uint64_t samples = 0;
+    for (int c = 0; c < 2; c++) {
+        for (int r = 0; r < CHANNEL_REGIONS; r++) {
+            if (snap->ring_samples[c][r] < 0 || snap->ring_samples[c][r] > SNAPSHOT_MAX_RING)
+                return -1;
+            samples += (uint64_t)snap->ring_samples[c][r];
+        }
+    }
+    return snap->state_size + samples * sizeof(float) == snap->total_size ? 0 : -1;
+}
+
+/* A snapshot's params, held to what the setters accept; NaN becomes the low end */
+static void snapshot_clamp_params(engine_params_t *p) {
+    for (int i = 0; i < CLOUDSEED_PARAM_COUNT; i++) {
+        float *v = param_slot(p, (cloudseed_param_t)i);
+        *v = *v >= 0.0f ? (*v <= 1.0f ? *v : 1.0f) : 0.0f;
+    }
+    p->input_mix = p->input_mix >= 0.0f ? (p->input_mix <= 1.0f ? p->input_mix : 1.0f) : 0.0f;
+    if (p->mod_update_rate < 1) p->mod_update_rate = 1;
+    if (p->mod_update_rate > MAX_MODULATION_UPDATE_RATE) p->mod_update_rate = MAX_MODULATION_UPDATE_RATE;
+    if (p->early_mode != EARLY_OFF && p->early_mode != EARLY_MULTITAP && p->early_mode != EARLY_VELVET)
+        p->early_mode = EARLY_OFF;
+    if (p->early_taps < MIN_EARLY_TAPS) p->early_taps = MIN_EARLY_TAPS;
+    if (p->early_taps > MAX_TAPS) p->early_taps = MAX_TAPS;
+}
+
+/* Saved signal state: anything not finite restarts at zero */
+static float restore_float(float v) {
+    return isfinite(v) ? v : 0.0f;
+}
+
+static float restore_phase(float phase) {
+    return phase >= 0.0f && phase <= 1.0f ? phase : 0.0f;
+}
+
+static int restore_run(int run) {
+    return run < 0 ? 0 : (run > SILENT_RUN_MAX ? SILENT_RUN_MAX : run);
+}
+
+/*
+ * A saved delay glide is kept only if every read it leads to stays within
+ * the ring: the smoothed delay, the ramp's value and the segment's end.
+ */
+static int restore_glide_ok(float current, float value, float step, int segment_left,
+                            int update_rate, int size) {
+    float limit = (float)(size - RING_MARGIN);
+    float end = value + step * (float)segment_left;
+    return segment_left >= 0 && segment_left <= update_rate &&
+           current >= 1.0f && current <= limit &&
+           value >= 0.0f && value <= limit && end >= 0.0f && end <= limit;
+}
+
+/*
+ * Restore: dst, built and given its coefficients from the params, takes
+ * the LFO phase, delay glide and silence run of img. The ring and its
+ * index were restored already.
+ */
+static void mod_delay_restore(mod_delay_t *dst, const mod_delay_t *img) {
+    dst->mod_phase = restore_phase(img->mod_phase);
+    dst->silent_run = restore_run(img->silent_run);
+    if (!restore_glide_ok(img->sample_delay_current, img->delay_value, img->delay_step,
+                          img->segment_left, dst->update_rate, dst->size)) {
+        mod_delay_snap(dst);
+        return;
+    }
+    dst->sample_delay_current = img->sample_delay_current;
+    dst->sample_delay = (int)img->sample_delay_current;
+    dst->delay_value = img->delay_value;
+    dst->delay_step = img->delay_step;
+    dst->segment_left = img->segment_left;
+}
+
+static void mod_allpass_restore(mod_allpass_t *dst, const mod_allpass_t *img) {
+    dst->mod_phase = restore_phase(img->mod_phase);
+    dst->silent_run = restore_run(img->silent_run);
+    if (!restore_glide_ok(img->sample_delay_current, img->delay_value, img->delay_step,
+                          img->segment_left, dst->update_rate, dst->size)) {
+        mod_allpass_snap(dst);
+        return;
+    }
+    dst->sample_delay_current = img->sample_delay_current;
+    dst->sample_delay = (int)img->sample_delay_current;
+    dst->delay_value = img->delay_value;
+    dst->delay_step = img->delay_step;
+    dst->segment_left = img->segment_left;
+}
+
+static void diffuser_restore(allpass_diffuser_t *dst, const allpass_diffuser_t *img) {
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        if (dst->filters[i].buffer && img->filters[i].buffer)
+            mod_allpass_restore(&dst->filters[i], &img->filters[i]);
+    }
+}
+
+static void biquad_state_restore(biquad_state_t *dst, const biquad_state_t *img) {
+    dst->x1 = restore_float(img->x1);
+    dst->x2 = restore_float(img->x2);
+    dst->y = restore_float(img->y);
+    dst->y1 = restore_float(img->y1);
+    dst->y2 = restore_float(img->y2);
+}
+
+static void circular_restore(circular_buffer_t *dst, const circular_buffer_t *img) {
+    int len = BUFFER_SIZE * 2;
+    if (img->idx_read < 0 || img->idx_read >= len || img->idx_write < 0 || img->idx_write >= len ||
+        img->count < 0 || img->count > len) {
+        circular_init(dst);
+        return;
+    }
+    for (int i = 0; i < len; i++)
+        dst->buffer[i] = restore_float(img->buffer[i]);
+    dst->idx_read = img->idx_read;
+    dst->idx_write = img->idx_write;
+    dst->count = img->count;
+}
+
+static void delay_line_restore(delay_line_t *dst, const delay_line_t *img) {
+    mod_delay_restore(&dst->delay, &img->delay);
+    diffuser_restore(&dst->diffuser, &img->diffuser);
+    biquad_state_restore(&dst->low_shelf, &img->low_shelf);
+    biquad_state_restore(&dst->high_shelf, &img->high_shelf);
+    dst->low_pass_out = restore_float(img->low_pass_out);
+    circular_restore(&dst->feedback_buffer, &img->feedback_buffer);
+}
+
+/* Signal state only, for buffers both have; counts, stages and gains stay derived */
+static void channel_restore(reverb_channel_t *dst, const reverb_channel_t *img) {
+    if (dst->predelay.buffer && img->predelay.buffer)
+        mod_delay_restore(&dst->predelay, &img->predelay);
+    if (dst->multitap.buffer && img->multitap.buffer)
+        dst->multitap.silent_run = restore_run(img->multitap.silent_run);
+    diffuser_restore(&dst->diffuser, &img->diffuser);
+    for (int i = 0; i < MAX_LINE_COUNT; i++) {
+        if (dst->lines[i].delay.buffer && img->lines[i].delay.buffer)
+            delay_line_restore(&dst->lines[i], &img->lines[i]);
+    }
+    dst->high_pass.lp_out = restore_float(img->high_pass.lp_out);
+    dst->high_pass.output = restore_float(img->high_pass.output);
+    dst->low_pass.output = restore_float(img->low_pass.output);
+}
+
+/*
+ * Restores a checked snapshot into a freshly built engine whose clamped
+ * params and topology match it, coefficients already derived. Rings are
+ * truncated to the tier built, as in a primed rebuild, and restart their
+ * indices; the channels then take the saved signal state.
+ */
+static void engine_restore_snapshot(cloudseed_engine_t *e, const engine_snapshot_t *snap) {
+    const reverb_channel_t *image = (const reverb_channel_t*)(snap + 1);
+    const float *samples = (const float*)(image + 2);
+
+    for (int c = 0; c < 2; c++) {
+        reverb_channel_t *ch = c ? e->live.r : e->live.l;
+        channel_set_mod_update_rate(ch, e->params.mod_update_rate);
+        for (int r = 0; r < CHANNEL_REGIONS; r++) {
+            int n = snap->ring_samples[c][r];
+            int len;
+            int *index;
+            float *buf = channel_region(ch, r, &len, &index);
+            if (buf && n > 0) {
+                int keep = n < len ? n : len;
+                ring_copy(buf, len, 0, samples, n, n - keep, keep);
+                *index = keep % len;
+            }
+            samples += n;
+        }
+        if (!snap->cleared)
+            channel_restore(ch, &image[c]);
+    }
+    channel_fit_delays(e->live.l);
+    channel_fit_delays(e->live.r);
+
+    /* AUTO layout keeps its timings rather than calibrating again */
+    for (int i = 0; i < LAYOUT_BUCKETS && e->line_layout == LINE_LAYOUT_AUTO; i++) {
+        const layout_calibration_t *cal = &snap->layout_cal[i];
+        if ((cal->choice == -1 || cal->choice == LINE_LAYOUT_BLOCK || cal->choice == LINE_LAYOUT_SAMPLE) &&
+            cal->blocks[0] >= 0 && cal->blocks[1] >= 0)
+            e->layout_cal[i] = *cal;
+    }
+    float mix = snap->mix_current;
+    e->mix_current = mix >= 0.0f ? (mix <= 1.0f ? mix : 1.0f) : 0.0f;
+    e->silent_input_samples = snap->silent_input_samples > 0 ? snap->silent_input_samples : 0;
+    e->is_silent = snap->is_silent != 0 || snap->cleared;
+}
+
+void cloudseed_engine_global_init(void) {
+    static int initialized = 0;
+    if (initialized) return;
+
+    knob_tables_init(&g_knob_tables, SAMPLE_RATE);
+    fft_tables_init(&g_fft_tables);
+    g_kernels = dsp_kernels_select();
+    initialized = 1;
+}
+
+const char *cloudseed_engine_cpu_variant(void) {
+    return g_kernels->name;
+}
+
+/* Engine allocations outside the channel pairs, reserved from the module budget */
+static size_t engine_own_bytes(void) {
+    return sizeof(cloudseed_engine_t);
+}
+
+/* Builds an engine with default settings, or with those of a checked snapshot, which it resumes */
+static cloudseed_engine_t *engine_create(const cloudseed_hooks_t *hooks, const engine_snapshot_t *snap) {
+    static const cloudseed_hooks_t no_hooks = { NULL, NULL, NULL, NULL, 0 };
+    if (!hooks) hooks = &no_hooks;
+
+    cloudseed_engine_global_init();
+
+    engine_allocator_t alloc;
+    memset(&alloc, 0, sizeof(alloc));
+    alloc.hooks = *hooks;
+
+    cloudseed_engine_t *e = (cloudseed_engine_t*)engine_alloc(&alloc, CLOUDSEED_MEM_ENGINE,
+                                                              sizeof(cloudseed_engine_t));
+    if (!e) {
+        if (hooks->log) hooks->log(hooks->user, "Failed to allocate engine");
+        return NULL;
+    }
+    e->alloc = alloc;
+
+    /* Set default parameters */
+    e->params.input_mix = 1.0f;
+    e->params.predelay = 0.0f;
+    e->params.decay = 0.5f;
+    e->params.size = 0.5f;
+    e->params.diffusion = 0.7f;
+    e->params.mix = 0.3f;
+    e->params.early_late = 0.0f;
+    e->params.low_cut = 0.0f;
+    e->params.high_cut = 1.0f;
+    e->params.cross_seed = 0.5f;
+    e->params.mod_rate = 0.3f;
+    e->params.mod_amount = 0.3f;
+    e->params.mod_update_rate = MODULATION_UPDATE_RATE;
+    e->params.early_mode = EARLY_OFF;
+    e->params.early_taps = EARLY_TAP_COUNT;
+    if (snap) {
+        e->params = snap->params;
+        snapshot_clamp_params(&e->params);
+    }
+    e->mix_current = e->params.mix;
+    cloudseed_engine_set_line_layout(e, snap ? snap->line_layout : LINE_LAYOUT_BLOCK);
+
+    budget_reserve(engine_own_bytes(), 1);
+    engine_mem_register(&e->alloc, 1);
+    __atomic_add_fetch(&g_module_engines, 1, __ATOMIC_RELAXED);
+    e->registered = 1;
+
+    e->topology.profile = CLOUDSEED_MEM_TIER_STANDARD;
+    e->topology.line_count = CLOUDSEED_DEFAULT_LINES;
+    e->prime_tail = 1;
+    if (snap) {
+        e->topology = snap->topology;
+        e->prime_tail = snap->prime_tail;
+    }
+    if (engine_build_pair(e, &e->live, &e->topology) != 0) {
+        engine_log(e, "Failed to allocate reverb channels");
+        cloudseed_engine_destroy(e);
+        return NULL;
+    }
+    engine_mem_register(&e->live.alloc, 1);
+    engine_attach_tap_conv(e);
+
+    /* Topology changes and tap spectra are built off the audio thread */
+    if (sem_init(&e->worker_wake, 0, 0) == 0) {
+        if (pthread_create(&e->worker, NULL, engine_worker, e) == 0)
+            e->worker_running = 1;
+        else
+            sem_destroy(&e->worker_wake);
+    }
+    if (!e->worker_running)
+        engine_log(e, "No rebuild worker: memory profile and line count changes disabled");
+
+    engine_apply_parameters(e);
+
+    /* A fresh engine holds no signal */
+    e->silent_input_samples = e->tail_samples;
+    e->is_silent = 1;
+
+    if (snap)
+        engine_restore_snapshot(e, snap);
+    engine_want_tap_conv(e);
+    return e;
+}
+
+cloudseed_engine_t *cloudseed_engine_create(const cloudseed_hooks_t *hooks) {
+    return engine_create(hooks, NULL);
+}
+
+cloudseed_engine_t *cloudseed_engine_create_from_snapshot(const cloudseed_hooks_t *hooks,
+                                                          const void *data, size_t size) {
+    if (engine_snapshot_check(data, size) != 0) {
+        if (hooks && hooks->log) hooks->log(hooks->user, "Snapshot rejected: truncated or from another engine build");
+        return NULL;
+    }
+    return engine_create(hooks, (const engine_snapshot_t*)data);
+}
+
+void cloudseed_engine_destroy(cloudseed_engine_t *e) {
+    if (!e) return;
+
+    if (e->worker_running) {
+        __atomic_store_n(&e->worker_quit, 1, __ATOMIC_RELEASE);
+        sem_post(&e->worker_wake);
+        pthread_join(e->worker, NULL);
+        sem_destroy(&e->worker_wake);
+    }
+
+    int state = __atomic_load_n(&e->rebuild_state, __ATOMIC_ACQUIRE);
+    if (state == REBUILD_READY || state == REBUILD_CAPTURE || state == REBUILD_CAPTURED)
+        engine_drop_pair(&e->pending);
+    else if (state == REBUILD_RETIRED)
+        engine_drop_pair(&e->retired);
+    if (e->live.l || e->live.r)
+        engine_drop_pair(&e->live);
+    int snapshot = __atomic_load_n(&e->snapshot_state, __ATOMIC_ACQUIRE);
+    if (snapshot == SNAPSHOT_PRIMING || snapshot == SNAPSHOT_READY)
+        engine_drop_pair(&e->snapshot);
+    engine_free_presets(e);
+
+    if (e->registered) {
+        engine_mem_register(&e->alloc, -1);
+        __atomic_sub_fetch(&g_module_engines, 1, __ATOMIC_RELAXED);
+        budget_release(engine_own_bytes());
+    }
+    if (e->tap_conv) {
+        engine_mem_register(&e->conv_alloc, -1);
+        budget_release(2 * sizeof(tap_conv_t));
+        engine_free(&e->conv_alloc, e->tap_conv);
+    }
+
+    engine_allocator_t alloc = e->alloc;
+    engine_free(&alloc, e);
+}
+
+/* Runs one host block; adds CLOUDSEED_TRACE_* flags describing what it did */
+static void engine_process_block(cloudseed_engine_t *e, int16_t *audio_inout, int frames,
+                                 uint8_t *flags) {
+
+    /* Mix ramps linearly across the block, so moves into or out of 0/1 are smooth */
+    float mix_start = e->mix_current;
+    float mix_end = e->params.mix;
+    float mix_step = (mix_end - mix_start) / (float)frames;
+    e->mix_current = mix_end;
+
+    /* A new clear request fades the wet signal out over this block */
+    int clear_requested = __atomic_load_n(&e->clear_requested, __ATOMIC_ACQUIRE);
+    if (clear_requested != e->clear_epoch) {
+        e->clear_epoch = clear_requested;
+        if (!e->clearing)
+            e->clear_fading = 1;
+    }
+
+    /*
+     * A rebuilt channel pair: swap in once primed with the live tail or at
+     * once when silent, else fade the wet out over one block, swap, and
+     * fade back in over the next. Priming, once begun, runs to the swap.
+     */
+    int wet_fade = 0;           /* -1 fades the wet signal out across the block, 1 fades it in */
+    if (!e->live.l->tap_conv && __atomic_load_n(&e->tap_conv, __ATOMIC_ACQUIRE))
+        engine_attach_tap_conv(e);
+    if (__atomic_load_n(&e->rebuild_state, __ATOMIC_ACQUIRE) == REBUILD_CAPTURE)
+        engine_capture_rebuild(e);
+    if (e->swap_fading) {
+        engine_swap_channels(e, 0);
+        e->swap_fading = 0;
+        wet_fade = 1;
+        *flags |= CLOUDSEED_TRACE_SWAP;
+    } else if (__atomic_load_n(&e->rebuild_state, __ATOMIC_ACQUIRE) == REBUILD_READY) {
+        int prime = e->pending.prime &&
+                    (e->pending.prime_next > 0 || (!e->is_silent && !e->clearing && !e->clear_fading));
+        if (prime) {
+            if (engine_prime_step(e, &e->pending, frames)) {
+                engine_swap_channels(e, 1);
+                *flags |= CLOUDSEED_TRACE_SWAP;
+            }
+        } else if (e->is_silent) {
+            engine_swap_channels(e, 0);
+            *flags |= CLOUDSEED_TRACE_SWAP;
+        } else {
+            e->swap_fading = 1;
+            wet_fade = -1;
+        }
+    }
+    if (e->clear_fading)
+        wet_fade = -1;
+
+    /* A snapshot copy: captured the block its rings are level, or at once mid-clear (rings dropped) */
+    if (__atomic_load_n(&e->snapshot_state, __ATOMIC_ACQUIRE) == SNAPSHOT_PRIMING &&
+        (e->clearing || e->clear_fading || engine_prime_step(e, &e->snapshot, frames)))
+        engine_capture_snapshot(e);
+
+    if (e->clearing) {
+        engine_clear_step(e, frames);
+        *flags |= CLOUDSEED_TRACE_CLEARING;
+    }
+
+    /*
+     * Fully dry with nothing ringing and no input: the engine has nothing to
+     * add, leave audio untouched. Input at mix 0 still runs the engine, so
+     * raising mix later reveals its tail.
+     */
+    if (mix_start == 0.0f && mix_end == 0.0f && e->is_silent &&
+        !e->clear_fading && !e->clearing && input_is_silent(audio_inout, frames)) {
+        *flags |= CLOUDSEED_TRACE_BYPASS;
+        return;
+    }
+
+    /* Process in chunks of BUFFER_SIZE */
+    float in_peak = 0.0f;
+    float wet_peak = 0.0f;
+    int offset = 0;
+    while (offset < frames) {
+        int chunk = frames - offset;
+        if (chunk > BUFFER_SIZE) chunk = BUFFER_SIZE;
+
+        float in_l[BUFFER_SIZE];
+        float in_r[BUFFER_SIZE];
+        float out_l[BUFFER_SIZE];
+        float out_r[BUFFER_SIZE];
+
+        /* Convert to float */
+        g_kernels->convert_in(audio_inout + offset * 2, in_l, in_r, chunk);
+
+        /* Process through reverb channels (wet is muted while clearing) */
+        if (e->clearing) {
+            memset(out_l, 0, chunk * sizeof(float));
+            memset(out_r, 0, chunk * sizeof(float));
+        } else {
+            layout_calibration_t *timing;
+            int layout = engine_pick_layout(e, chunk, &timing);
+            e->live.l->line_layout = layout;
+            e->live.r->line_layout = layout;
+
+            uint64_t start = timing ? now_ns() : 0;
+            channel_process(e->live.l, in_l, out_l, chunk);
+            channel_process(e->live.r, in_r, out_r, chunk);
+            if (timing) {
+                engine_record_layout(timing, layout, now_ns() - start);
+                *flags |= CLOUDSEED_TRACE_CALIBRATING;
+            }
+        }
+
+        if (wet_fade) {
+            float step = 1.0f / (float)frames;
+            for (int i = 0; i < chunk; i++) {
+                float ramp = (float)(offset + i + 1) * step;
+                float fade = wet_fade < 0 ? 1.0f - ramp : ramp;
+                out_l[i] *= fade;
+                out_r[i] *= fade;
+            }
+        }
+
+        for (int i = 0; i < chunk; i++) {
+            in_peak = fmaxf(in_peak, fmaxf(fabsf(in_l[i]), fabsf(in_r[i])));
+            wet_peak = fmaxf(wet_peak, fmaxf(fabsf(out_l[i]), fabsf(out_r[i])));
+        }
+
+        /* Mix dry and wet, convert back to int16 */
+        if (mix_start == 1.0f && mix_end == 1.0f) {
+            /* Fully wet (send/return use): no dry term */
+            g_kernels->output_wet(audio_inout + offset * 2, out_l, out_r, chunk);
+        } else {
+            g_kernels->output_mix(audio_inout + offset * 2, in_l, in_r, out_l, out_r,
+                                  mix_start + mix_step * (float)offset, mix_step, chunk);
+        }
+
+        offset += chunk;
+    }
+
+    engine_track_silence(e, in_peak, wet_peak, frames);
+
+    if (e->clear_fading) {
+        e->clear_fading = 0;
+        e->clearing = 1;
+        if (e->live.l->tap_conv) {
+            tap_conv_reset(e->live.l->tap_conv);
+            tap_conv_reset(e->live.r->tap_conv);
+        }
+        e->clear_channel = 0;
+        e->clear_region = 0;
+        e->clear_offset = 0;
+    }
+}
+
+void cloudseed_engine_process(cloudseed_engine_t *e, int16_t *audio_inout, int frames) {
+    if (!e || frames <= 0) return;
+
+    uint64_t start = now_ns();
+    uint8_t flags = 0;
+    engine_take_preset(e);
+    engine_take_morph(e);
+    if (e->param_changed) {
+        flags |= CLOUDSEED_TRACE_PARAM_CHANGE;
+        e->param_changed = 0;
+    }
+
+    engine_process_block(e, audio_inout, frames, &flags);
+    e->sample_clock += (uint32_t)frames;
+
+    if (e->is_silent)
+        flags |= CLOUDSEED_TRACE_SILENT;
+
+    uint32_t seq = e->trace_count;
+    cloudseed_trace_record_t rec;
+    uint64_t duration = now_ns() - start;
+    memset(&rec, 0, sizeof(rec));
+    rec.timestamp_ns = start;
+    rec.duration_ns = duration > UINT32_MAX ? UINT32_MAX : (uint32_t)duration;
+    rec.sequence = seq;
+    rec.frames = frames > UINT16_MAX ? UINT16_MAX : (uint16_t)frames;
+    rec.flags = flags;
+    rec.mod_update_rate = (uint8_t)e->params.mod_update_rate;
+    rec.line_layout = (uint8_t)e->live.l->line_layout;
+    trace_slot_store(e->trace[seq % CLOUDSEED_TRACE_RECORDS], &rec);
+    __atomic_store_n(&e->trace_count, seq + 1, __ATOMIC_RELEASE);
+}
+
+void cloudseed_engine_set_params(cloudseed_engine_t *e, const float *values, uint32_t mask) {
+    if (!e) return;
+
+    int need_update = 0;
+    for (int p = 0; p < CLOUDSEED_PARAM_COUNT; p++) {
+        if (!(mask & (1u << p))) continue;
+
+        float v = values[p];
+        if (v < 0.0f) v = 0.0f;
+        if (v > 1.0f) v = 1.0f;
+        *param_slot(&e->params, (cloudseed_param_t)p) = v;
+
+        /* Mix is applied per block and needs no coefficient update */
+        if (p != CLOUDSEED_PARAM_MIX)
+            need_update = 1;
+    }
+
+    if (mask)
+        e->param_changed = 1;
+
+    if (need_update)
+        engine_apply_parameters(e);
+}
+
+void cloudseed_engine_set_param(cloudseed_engine_t *e, cloudseed_param_t param, float value) {
+    if ((unsigned)param >= CLOUDSEED_PARAM_COUNT) return;
+
+    float values[CLOUDSEED_PARAM_COUNT];
+    values[param] = value;
+    cloudseed_engine_set_params(e, values, 1u << param);
+}
+
+float cloudseed_engine_get_param(const cloudseed_engine_t *e, cloudseed_param_t param) {
+    if (!e || (unsigned)param >= CLOUDSEED_PARAM_COUNT) return 0.0f;
+    return *param_slot((engine_params_t*)&e->params, param);
+}
+
+int cloudseed_engine_set_presets(cloudseed_engine_t *e, const float *values, int count) {
+    if (!e || count < 0 || count > CLOUDSEED_MAX_PRESETS) return -1;
+
+    engine_free_presets(e);
+    if (count == 0) return 0;
+
+    size_t bytes = (size_t)count * sizeof(preset_t);
+    if (!budget_reserve(bytes, 0)) {
+        engine_log(e, "Preset bank does not fit the memory budget");
+        return -1;
+    }
+
+    engine_allocator_t scratch_alloc;
+    memset(&scratch_alloc, 0, sizeof(scratch_alloc));
+    scratch_alloc.hooks = e->alloc.hooks;
+    e->preset_alloc.hooks = e->alloc.hooks;
+    preset_t *presets = (preset_t*)engine_alloc(&e->preset_alloc, CLOUDSEED_MEM_PRESETS, bytes);
+    reverb_channel_t *scratch = (reverb_channel_t*)engine_alloc(&scratch_alloc, CLOUDSEED_MEM_STATE,
+                                                                2 * sizeof(reverb_channel_t));
+    if (!presets || !scratch) {
+        engine_free(&e->preset_alloc, presets);
+        engine_free(&scratch_alloc, scratch);
+        memset(e->preset_alloc.bytes, 0, sizeof(e->preset_alloc.bytes));
+        e->preset_alloc.allocations = 0;
+        budget_release(bytes);
+        engine_log(e, "Failed to allocate preset bank");
+        return -1;
+    }
+
+    channel_pair_t pair = e->live;
+    pair.l = &scratch[0];
+    pair.r = &scratch[1];
+    memcpy(pair.l, e->live.l, sizeof(reverb_channel_t));
+    memcpy(pair.r, e->live.r, sizeof(reverb_channel_t));
+
+    for (int i = 0; i < count; i++) {
+        presets[i].params = e->params;
+        presets[i].params.early_mode = EARLY_OFF;
+        for (int p = 0; p < CLOUDSEED_PARAM_COUNT; p++) {
+            float v = values[i * CLOUDSEED_PARAM_COUNT + p];
+            if (v < 0.0f) v = 0.0f;
+            if (v > 1.0f) v = 1.0f;
+            *param_slot(&presets[i].params, (cloudseed_param_t)p) = v;
+        }
+        pair_derive_preset(&pair, &presets[i]);
+    }
+    engine_free(&scratch_alloc, scratch);
+
+    pair_preset_limits(&e->live, e->preset_limits);
+    e->presets = presets;
+    e->preset_count = count;
+    engine_mem_register(&e->preset_alloc, 1);
+    return count;
+}
+
+void cloudseed_engine_recall_preset(cloudseed_engine_t *e, int index) {
+    if (!e || index < 0 || index >= e->preset_count) return;
+    __atomic_store_n(&e->preset_pending, index + 1, __ATOMIC_RELEASE);
+}
+
+int cloudseed_engine_preset_count(const cloudseed_engine_t *e) {
+    return e ? e->preset_count : 0;
+}
+
+void cloudseed_engine_set_morph(cloudseed_engine_t *e, int from, int to, float amount) {
+    if (!e || from < 0 || to < 0 || from >= e->preset_count || to >= e->preset_count) return;
+    if (amount < 0.0f) amount = 0.0f;
+    if (amount > 1.0f) amount = 1.0f;
+
+    if (from != e->morph_from)
+        e->morph_seeded = 0;
+    e->morph_from = from;
+    e->morph_to = to;
+    e->morph_amount = amount;
+    e->morph_dirty = 1;
+}
+
+float cloudseed_engine_get_morph(const cloudseed_engine_t *e) {
+    return e ? e->morph_amount : 0.0f;
+}
+
+void cloudseed_engine_set_mod_update_rate(cloudseed_engine_t *e, int rate) {
+    if (!e) return;
+    if (rate < 1) rate = 1;
+    if (rate > MAX_MODULATION_UPDATE_RATE) rate = MAX_MODULATION_UPDATE_RATE;
+    if (rate == e->params.mod_update_rate) return;
+
+    e->params.mod_update_rate = rate;
+    e->param_changed = 1;
+    channel_set_mod_update_rate(e->live.l, rate);
+    channel_set_mod_update_rate(e->live.r, rate);
+}
+
+int cloudseed_engine_get_mod_update_rate(const cloudseed_engine_t *e) {
+    return e ? e->params.mod_update_rate : MODULATION_UPDATE_RATE;
+}
+
+void cloudseed_engine_set_early_mode(cloudseed_engine_t *e, int mode) {
+    if (!e) return;
+    if (mode != EARLY_OFF && mode != EARLY_MULTITAP && mode != EARLY_VELVET)
+        return;
+    if (mode == e->params.early_mode) return;
+
+    e->params.early_mode = mode;
+    e->param_changed = 1;
+    engine_apply_parameters(e);
+    engine_attach_tap_conv(e);
+    engine_want_tap_conv(e);
+}
+
+int cloudseed_engine_get_early_mode(const cloudseed_engine_t *e) {
+    return e ? e->params.early_mode : EARLY_OFF;
+}
+
+void cloudseed_engine_set_early_taps(cloudseed_engine_t *e, int taps) {
+    if (!e) return;
+    if (taps < MIN_EARLY_TAPS) taps = MIN_EARLY_TAPS;
+    if (taps > MAX_TAPS) taps = MAX_TAPS;
+    if (taps == e->params.early_taps) return;
+
+    e->params.early_taps = taps;
+    e->param_changed = 1;
+    engine_apply_parameters(e);
+    engine_attach_tap_conv(e);
+    engine_want_tap_conv(e);
+}
+
+int cloudseed_engine_get_early_taps(const cloudseed_engine_t *e) {
+    return e ? e->params.early_taps : EARLY_TAP_COUNT;
+}
+
+void cloudseed_engine_set_line_layout(cloudseed_engine_t *e, int layout) {
+    if (!e) return;
+    if (layout != LINE_LAYOUT_BLOCK && layout != LINE_LAYOUT_SAMPLE && layout != LINE_LAYOUT_AUTO)
+        return;
+
+    e->line_layout = layout;
+    e->param_changed = 1;
+    memset(e->layout_cal, 0, sizeof(e->layout_cal));
+    for (int i = 0; i < LAYOUT_BUCKETS; i++)
+        e->layout_cal[i].choice = -1;
+}
+
+int cloudseed_engine_get_line_layout(const cloudseed_engine_t *e) {
+    return e ? e->line_layout : LINE_LAYOUT_BLOCK;
+}
+
+int cloudseed_engine_layout_choice(const cloudseed_engine_t *e, int bucket) {
+    if (!e || bucket < 0 || bucket >= LAYOUT_BUCKETS) return -1;
+    return e->line_layout == LINE_LAYOUT_AUTO ? e->layout_cal[bucket].choice : e->line_layout;
+}
+
+void cloudseed_engine_clear_tail(cloudseed_engine_t *e) {
+    if (e) __atomic_add_fetch(&e->clear_requested, 1, __ATOMIC_RELEASE);
+}
+
+int cloudseed_engine_clear_busy(const cloudseed_engine_t *e) {
+    if (!e) return 0;
+    return e->clearing || e->clear_fading ||
+           __atomic_load_n(&e->clear_requested, __ATOMIC_ACQUIRE) != e->clear_epoch;
+}
+
+int cloudseed_engine_tail_samples(const cloudseed_engine_t *e) {
+    return e ? e->tail_samples : 0;
+}
+
+int cloudseed_engine_is_silent(const cloudseed_engine_t *e) {
+    return e ? e->is_silent : 1;
+}
+
+int cloudseed_engine_snapshot_begin(cloudseed_engine_t *e) {
+    if (!e || !e->worker_running) return -1;
+    int idle = SNAPSHOT_IDLE;
+    if (!__atomic_compare_exchange_n(&e->snapshot_state, &idle, SNAPSHOT_REQUESTED, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        return -1;
+    sem_post(&e->worker_wake);
+    return 0;
+}
+
+int cloudseed_engine_snapshot_ready(const cloudseed_engine_t *e) {
+    if (!e) return -1;
+    int state = __atomic_load_n(&e->snapshot_state, __ATOMIC_ACQUIRE);
+    if (state == SNAPSHOT_READY) return 1;
+    return state == SNAPSHOT_FAILED || state == SNAPSHOT_IDLE ? -1 : 0;
+}
+
+void cloudseed_engine_snapshot_end(cloudseed_engine_t *e) {
+    if (!e) return;
+    int state = __atomic_load_n(&e->snapshot_state, __ATOMIC_ACQUIRE);
+    if (state != SNAPSHOT_READY && state != SNAPSHOT_FAILED)
+        return;
+    if (state == SNAPSHOT_READY)
+        engine_drop_pair(&e->snapshot);
+    __atomic_store_n(&e->snapshot_state, SNAPSHOT_IDLE, __ATOMIC_RELEASE);
+}
+
+size_t cloudseed_engine_snapshot_size(const cloudseed_engine_t *e) {
+    if (cloudseed_engine_snapshot_ready(e) != 1) return 0;
+    engine_snapshot_t snap;
+    return engine_snapshot_header(e, &snap);
+}
+
+size_t cloudseed_engine_save_snapshot(const cloudseed_engine_t *e, void *out, size_t size) {
+    if (!out || cloudseed_engine_snapshot_ready(e) != 1) return 0;
+    engine_snapshot_t snap;
+    size_t total = engine_snapshot_header(e, &snap);
+    if (size < total) return 0;
+
+    uint8_t *p = (uint8_t*)out;
+    memcpy(p, &snap, sizeof(snap));
+    p += sizeof(snap);
+    memcpy(p, e->snapshot.l, sizeof(reverb_channel_t));
+    p += sizeof(reverb_channel_t);
+    memcpy(p, e->snapshot.r, sizeof(reverb_channel_t));
+    p += sizeof(reverb_channel_t);
+
+    /* Each ring's live part, oldest first, ending at its write position */
+    for (int c = 0; c < 2; c++) {
+        reverb_channel_t *ch = c ? e->snapshot.r : e->snapshot.l;
+        for (int r = 0; r < CHANNEL_REGIONS; r++) {
+            int n = snap.ring_samples[c][r];
+            if (n == 0) continue;
+
+            int len;
+            int *index;
+            const float *buf = channel_region(ch, r, &len, &index);
+            int from = *index - n;
+            if (from < 0) from += len;
+            ring_copy((float*)p, n, 0, buf, len, from, n);
+            p += n * sizeof(float);
+        }
+    }
+    return total;
+}
+
+uint32_t cloudseed_engine_trace_position(const cloudseed_engine_t *e) {
+    return e ? __atomic_load_n(&e->trace_count, __ATOMIC_ACQUIRE) : 0;
+}
+
+int cloudseed_engine_trace_snapshot(const cloudseed_engine_t *e,
+                                    cloudseed_trace_record_t *out, int max) {
+    return cloudseed_engine_trace_snapshot_until(e, cloudseed_engine_trace_position(e), out, max);
+}
+
+int cloudseed_engine_trace_snapshot_until(const cloudseed_engine_t *e, uint32_t end,
+                                          cloudseed_trace_record_t *out, int max) {
+    if (!e || !out || max <= 0) return 0;
+
+    uint32_t avail = end < CLOUDSEED_TRACE_RECORDS ? end : CLOUDSEED_TRACE_RECORDS;
+    if ((uint32_t)max < avail) avail = (uint32_t)max;
+
+    uint32_t first = end - avail;
+    for (uint32_t i = 0; i < avail; i++)
+        trace_slot_load(e->trace[(first + i) % CLOUDSEED_TRACE_RECORDS], &out[i]);
+
+    /* Slots the writer reached meanwhile (including one in progress) are suspect */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint32_t now = __atomic_load_n(&e->trace_count, __ATOMIC_RELAXED);
+    uint32_t overwritten = now - first;
+    uint32_t drop = overwritten + 1 > CLOUDSEED_TRACE_RECORDS
+                  ? overwritten + 1 - CLOUDSEED_TRACE_RECORDS : 0;
+    if (drop >= avail)
+        return 0;
+
+    if (drop > 0)
+        memmove(out, out + drop, (avail - drop) * sizeof(*out));
+    return (int)(avail - drop);
+}
+
+const char *cloudseed_mem_category_name(cloudseed_mem_category_t category) {
+    switch (category) {
+        case CLOUDSEED_MEM_ENGINE:   return "engine";
+        case CLOUDSEED_MEM_DELAY:    return "delay";
+        case CLOUDSEED_MEM_MULTITAP: return "multitap";
+        case CLOUDSEED_MEM_ALLPASS:  return "allpass";
+        case CLOUDSEED_MEM_SEEDS:    return "seeds";
+        case CLOUDSEED_MEM_STATE:    return "state";
+        case CLOUDSEED_MEM_PRESETS:  return "presets";
+        case CLOUDSEED_MEM_EARLY_FFT: return "early_fft";
+        default:                     return "unknown";
+    }
+}
+
+void cloudseed_engine_memory_stats(const cloudseed_engine_t *e, cloudseed_mem_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (!e) return;
+
+    const engine_allocator_t *conv = __atomic_load_n(&e->tap_conv, __ATOMIC_ACQUIRE) ? &e->conv_alloc : NULL;
+    for (int c = 0; c < CLOUDSEED_MEM_CATEGORIES; c++) {
+        out->bytes[c] = e->alloc.bytes[c] + e->live.alloc.bytes[c] + e->preset_alloc.bytes[c] +
+                        (conv ? conv->bytes[c] : 0);
+        out->total += out->bytes[c];
+    }
+    out->allocations = e->alloc.allocations + e->live.alloc.allocations + e->preset_alloc.allocations +
+                       (conv ? conv->allocations : 0);
+}
+
+int cloudseed_engine_module_memory_stats(cloudseed_mem_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    for (int c = 0; c < CLOUDSEED_MEM_CATEGORIES; c++) {
+        out->bytes[c] = __atomic_load_n(&g_module_bytes[c], __ATOMIC_RELAXED);
+        out->total += out->bytes[c];
+    }
+    out->allocations = __atomic_load_n(&g_module_allocations, __ATOMIC_RELAXED);
+    out->shared = sizeof(g_knob_tables) + sizeof(g_fft_tables);
+    return __atomic_load_n(&g_module_engines, __ATOMIC_RELAXED);
+}
+
+void cloudseed_engine_set_memory_budget(size_t bytes) {
+    __atomic_store_n(&g_memory_budget, bytes, __ATOMIC_RELAXED);
+}
+
+size_t cloudseed_engine_memory_budget(size_t *used) {
+    if (used)
+        *used = __atomic_load_n(&g_budget_used, __ATOMIC_RELAXED);
+    return __atomic_load_n(&g_memory_budget, __ATOMIC_RELAXED);
+}
+
+int cloudseed_engine_memory_tier(const cloudseed_engine_t *e) {
+    return e ? e->live.tier : CLOUDSEED_MEM_TIER_STANDARD;
+}
+
+/* Stores a topology field and wakes the worker to rebuild for it */
+static void engine_request_rebuild(cloudseed_engine_t *e, int *field, int value) {
+    __atomic_store_n(field, value, __ATOMIC_RELAXED);
+    e->param_changed = 1;
+    if (e->worker_running)
+        sem_post(&e->worker_wake);
+}
+
+void cloudseed_engine_set_memory_profile(cloudseed_engine_t *e, int tier) {
+    if (!e || tier < 0 || tier >= CLOUDSEED_MEM_TIERS) return;
+    engine_request_rebuild(e, &e->topology.profile, tier);
+}
+
+int cloudseed_engine_get_memory_profile(const cloudseed_engine_t *e) {
+    return e ? __atomic_load_n(&e->topology.profile, __ATOMIC_RELAXED) : CLOUDSEED_MEM_TIER_STANDARD;
+}
+
+void cloudseed_engine_set_line_count(cloudseed_engine_t *e, int count) {
+    if (!e) return;
+    if (count < 1) count = 1;
+    if (count > CLOUDSEED_MAX_LINES) count = CLOUDSEED_MAX_LINES;
+    engine_request_rebuild(e, &e->topology.line_count, count);
+}
+
+int cloudseed_engine_get_line_count(const cloudseed_engine_t *e) {
+    return e ? __atomic_load_n(&e->topology.line_count, __ATOMIC_RELAXED) : CLOUDSEED_DEFAULT_LINES;
+}
+
+int cloudseed_engine_active_lines(const cloudseed_engine_t *e) {
+    return e ? e->live.l->line_count : 0;
+}
+
+void cloudseed_engine_set_tail_priming(cloudseed_engine_t *e, int enabled) {
+    if (!e) return;
+    __atomic_store_n(&e->prime_tail, enabled ? 1 : 0, __ATOMIC_RELAXED);
+}
+
+int cloudseed_engine_get_tail_priming(const cloudseed_engine_t *e) {
+    return e ? __atomic_load_n(&e->prime_tail, __ATOMIC_RELAXED) : 0;
+}
+
+void cloudseed_engine_memory_tier_info(int tier, cloudseed_mem_tier_t *out) {
+    if (tier < 0) tier = 0;
+    if (tier >= CLOUDSEED_MEM_TIERS) tier = CLOUDSEED_MEM_TIERS - 1;
+
+    const memory_tier_t *t = &g_memory_tiers[tier];
+    out->name = t->name;
+    out->max_predelay_ms = t->max_predelay_ms;
+    out->max_size_ms = t->max_size_ms;
+    out->lines = CLOUDSEED_DEFAULT_LINES < t->max_lines ? CLOUDSEED_DEFAULT_LINES : t->max_lines;
+    out->bytes = sizeof(cloudseed_engine_t) + memory_tier_bytes(tier, CLOUDSEED_DEFAULT_LINES);
+}
@@ -0,0 +1,332 @@
+/*
+ * CloudSeed reverb engine
+ *
+ * Host-independent core of the CloudSeed port. Built as a static library
+ * (libcloudseed_engine.a); the Schwung plugin in cloudseed.c is a thin
+ * adapter over this API, and other hosts, tools and benchmarks link the
+ * same engine.
+ *
+ * Threading: process, set_param and the other setters must not run
+ * concurrently on one engine, except cloudseed_engine_clear_tail,
+ * cloudseed_engine_recall_preset and the cloudseed_engine_trace_* calls,
+ * which may be called from any thread.
+ * Each engine owns a worker thread that rebuilds its buffers when the
+ * memory profile or line count changes; the audio thread only swaps
+ * pointers and, with tail priming, copies the last few blocks of tail.
+ */
+
+#ifndef CLOUDSEED_ENGINE_H
+#define CLOUDSEED_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CLOUDSEED_SAMPLE_RATE 48000
+
+#define CLOUDSEED_MAX_LINES 12
+#define CLOUDSEED_DEFAULT_LINES 8     /* Reference line count */
+
+/* Line processing layouts */
+#define CLOUDSEED_LAYOUT_BLOCK 0      /* Each line processes the whole block in turn (default) */
+#define CLOUDSEED_LAYOUT_SAMPLE 1     /* All lines advance one sample at a time */
+#define CLOUDSEED_LAYOUT_AUTO 2       /* Opt-in: time both per block size, keep the faster */
+#define CLOUDSEED_LAYOUT_BUCKETS 3    /* Block sizes <= 32, <= 64, <= 128 frames */
+
+/* Early reflection generators, fed from the pre-delay */
+#define CLOUDSEED_EARLY_OFF 0         /* None (reference default) */
+#define CLOUDSEED_EARLY_MULTITAP 1    /* Dense taps with random per-tap gains */
+#define CLOUDSEED_EARLY_VELVET 2      /* Same seeded pattern as +-1 velvet noise, far cheaper */
+
+/* Normalized (0-1) knobs */
+typedef enum {
+    CLOUDSEED_PARAM_PREDELAY,
+    CLOUDSEED_PARAM_DECAY,
+    CLOUDSEED_PARAM_SIZE,
+    CLOUDSEED_PARAM_DIFFUSION,
+    CLOUDSEED_PARAM_MIX,
+    CLOUDSEED_PARAM_EARLY_LATE,
+    CLOUDSEED_PARAM_LOW_CUT,
+    CLOUDSEED_PARAM_HIGH_CUT,
+    CLOUDSEED_PARAM_CROSS_SEED,
+    CLOUDSEED_PARAM_MOD_RATE,
+    CLOUDSEED_PARAM_MOD_AMOUNT,
+    CLOUDSEED_PARAM_COUNT
+} cloudseed_param_t;
+
+/*
+ * Host hooks. Any member may be NULL: alloc/free fall back to libc, log is
+ * dropped. alloc need not return zeroed memory. The audio thread never
+ * calls a hook. Besides create and destroy, the engine's worker thread
+ * allocates, frees and logs while building rebuilt channel pairs and
+ * snapshot copies, concurrently with the host's control thread, so all
+ * three hooks must be thread-safe.
+ *
+ * memory_limit caps this engine's delay buffers in bytes on top of the
+ * module budget: builds drop to the largest tier under it (the minimal
+ * tier regardless). 0 leaves only the module budget.
+ */
+typedef struct {
+    void *(*alloc)(void *user, size_t size);
+    void (*free)(void *user, void *ptr);
+    void (*log)(void *user, const char *msg);
+    void *user;
+    size_t memory_limit;
+} cloudseed_hooks_t;
+
+typedef struct cloudseed_engine cloudseed_engine_t;
+
+/* Allocation categories for memory accounting */
+typedef enum {
+    CLOUDSEED_MEM_ENGINE,       /* Context struct, including the trace ring */
+    CLOUDSEED_MEM_DELAY,        /* Predelay and delay line buffers */
+    CLOUDSEED_MEM_MULTITAP,     /* Early reflection tap buffers */
+    CLOUDSEED_MEM_ALLPASS,      /* Diffuser allpass arrays */
+    CLOUDSEED_MEM_SEEDS,        /* Seed and tap tables */
+    CLOUDSEED_MEM_STATE,        /* Filters, feedback rings and other channel state */
+    CLOUDSEED_MEM_PRESETS,      /* Preset bank coefficient sets */
+    CLOUDSEED_MEM_EARLY_FFT,    /* Multitap FFT path, allocated on first use */
+    CLOUDSEED_MEM_CATEGORIES
+} cloudseed_mem_category_t;
+
+typedef struct {
+    size_t bytes[CLOUDSEED_MEM_CATEGORIES];
+    size_t total;               /* Sum of bytes[] */
+    size_t shared;              /* Module-wide only: static tables shared by all engines */
+    int allocations;            /* Allocator calls */
+} cloudseed_mem_stats_t;
+
+/*
+ * Memory tiers, largest first. The memory profile picks the tier to build
+ * at; the module budget may push an engine further down the list.
+ */
+#define CLOUDSEED_MEM_TIER_HUGE 0       /* Reference buffer sizes */
+#define CLOUDSEED_MEM_TIER_STANDARD 1   /* Full ranges, buffers sized to them (default) */
+#define CLOUDSEED_MEM_TIER_REDUCED 2    /* Predelay <= 250 ms, size <= 500 ms */
+#define CLOUDSEED_MEM_TIER_COMPACT 3    /* Predelay <= 100 ms, size <= 300 ms */
+#define CLOUDSEED_MEM_TIER_MINIMAL 4    /* As compact, with 4 lines and a shorter diffuser */
+#define CLOUDSEED_MEM_TIERS 5
+
+typedef struct {
+    const char *name;           /* "huge", "standard", "reduced", "compact" or "minimal" */
+    int max_predelay_ms;
+    int max_size_ms;
+    int lines;                  /* Active delay lines per channel at the default line count */
+    size_t bytes;               /* Allocated by one engine at this tier */
+} cloudseed_mem_tier_t;
+
+/* Per-process-call trace record, written by the audio thread into a ring */
+#define CLOUDSEED_TRACE_RECORDS 1024
+
+#define CLOUDSEED_TRACE_PARAM_CHANGE 0x01   /* Params or settings changed since the last block */
+#define CLOUDSEED_TRACE_SILENT 0x02         /* Engine was silent at the end of the block */
+#define CLOUDSEED_TRACE_BYPASS 0x04         /* Dry, no input, nothing ringing; DSP skipped */
+#define CLOUDSEED_TRACE_CLEARING 0x08       /* Tail clear in progress, wet muted */
+#define CLOUDSEED_TRACE_CALIBRATING 0x10    /* Block was timed for line layout selection */
+#define CLOUDSEED_TRACE_SWAP 0x20           /* Rebuilt channels (topology change) swapped in */
+
+typedef struct {
+    uint64_t timestamp_ns;      /* CLOCK_MONOTONIC at block start */
+    uint32_t duration_ns;
+    uint32_t sequence;          /* Running block count */
+    uint16_t frames;
+    uint8_t flags;              /* CLOUDSEED_TRACE_* */
+    uint8_t mod_update_rate;    /* Quality tier: modulation control period */
+    uint8_t line_layout;        /* Layout used for the block */
+    uint8_t reserved[3];
+} cloudseed_trace_record_t;
+
+/* Trace dump file: this header, then count records, little-endian as written */
+#define CLOUDSEED_TRACE_MAGIC "CSTR"
+#define CLOUDSEED_TRACE_VERSION 1
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t record_size;       /* sizeof(cloudseed_trace_record_t) */
+    uint32_t count;
+    uint32_t sample_rate;
+    uint32_t reserved;
+} cloudseed_trace_file_header_t;
+
+/* Builds shared tables and picks the DSP kernel variant; safe to call repeatedly */
+void cloudseed_engine_global_init(void);
+
+/* Kernel variant picked by global_init: "generic" or "avx2" */
+const char *cloudseed_engine_cpu_variant(void);
+
+/* Returns NULL on allocation failure; hooks are copied */
+cloudseed_engine_t *cloudseed_engine_create(const cloudseed_hooks_t *hooks);
+void cloudseed_engine_destroy(cloudseed_engine_t *engine);
+
+/* Processes interleaved stereo int16 in place, any frame count */
+void cloudseed_engine_process(cloudseed_engine_t *engine, int16_t *audio_inout, int frames);
+
+/* Values are clamped to 0-1 */
+void cloudseed_engine_set_param(cloudseed_engine_t *engine, cloudseed_param_t param, float value);
+float cloudseed_engine_get_param(const cloudseed_engine_t *engine, cloudseed_param_t param);
+
+/* Sets every param whose bit (1u << param) is in mask, then recomputes once */
+void cloudseed_engine_set_params(cloudseed_engine_t *engine, const float *values, uint32_t mask);
+
+/*
+ * Preset bank: count presets (up to CLOUDSEED_MAX_PRESETS), each
+ * CLOUDSEED_PARAM_COUNT knob values in cloudseed_param_t order, replacing
+ * any previous bank. Every preset's coefficients are derived here, so a
+ * recall costs a copy at the next block boundary instead of a parameter
+ * update. Allocates; call like a setter. Returns count, or -1 on
+ * allocation failure or if the bank does not fit the memory budget.
+ */
+#define CLOUDSEED_MAX_PRESETS 32
+int cloudseed_engine_set_presets(cloudseed_engine_t *engine, const float *values, int count);
+
+/* Switches to a preset at the next block; safe from any thread. Out-of-range indexes are ignored */
+void cloudseed_engine_recall_preset(cloudseed_engine_t *engine, int index);
+int cloudseed_engine_preset_count(const cloudseed_engine_t *engine);
+
+/*
+ * Morphs between bank presets from and to, amount 0 (from) to 1 (to). The
+ * next block blends the two precomputed coefficient sets: delays linearly,
+ * feedback gains in dB, filters through their alphas; knobs read back as
+ * the blend. Seeds and early tap tables stay from's until amount reaches
+ * 1, so a sweep never re-seeds. Out-of-range indexes are ignored.
+ */
+void cloudseed_engine_set_morph(cloudseed_engine_t *engine, int from, int to, float amount);
+float cloudseed_engine_get_morph(const cloudseed_engine_t *engine);
+
+/* Modulation control period in samples, clamped to 1-64 */
+void cloudseed_engine_set_mod_update_rate(cloudseed_engine_t *engine, int rate);
+int cloudseed_engine_get_mod_update_rate(const cloudseed_engine_t *engine);
+
+/* CLOUDSEED_EARLY_OFF, _MULTITAP or _VELVET; other values are ignored */
+void cloudseed_engine_set_early_mode(cloudseed_engine_t *engine, int mode);
+int cloudseed_engine_get_early_mode(const cloudseed_engine_t *engine);
+
+/* Taps in the early pattern, clamped to 16-256 (default 128); from 64 the multitap runs as an FFT convolution */
+void cloudseed_engine_set_early_taps(cloudseed_engine_t *engine, int taps);
+int cloudseed_engine_get_early_taps(const cloudseed_engine_t *engine);
+
+/*
+ * CLOUDSEED_LAYOUT_BLOCK (default), _SAMPLE or _AUTO; other values are
+ * ignored. AUTO's choice depends on the load while it times, so the output
+ * is not reproducible across runs; scripts/bench_layout.c measures offline.
+ */
+void cloudseed_engine_set_line_layout(cloudseed_engine_t *engine, int layout);
+int cloudseed_engine_get_line_layout(const cloudseed_engine_t *engine);
+
+/* Layout in use for a block-size bucket, -1 while AUTO is still calibrating */
+int cloudseed_engine_layout_choice(const cloudseed_engine_t *engine, int bucket);
+
+/* Requests a click-free tail clear; the audio thread does the work */
+void cloudseed_engine_clear_tail(cloudseed_engine_t *engine);
+int cloudseed_engine_clear_busy(const cloudseed_engine_t *engine);
+
+/* Analytic ring-out length after the input goes quiet */
+int cloudseed_engine_tail_samples(const cloudseed_engine_t *engine);
+
+/* 1 once input and wet output are silent and the tail has flushed */
+int cloudseed_engine_is_silent(const cloudseed_engine_t *engine);
+
+/* Bytes this engine allocated through its hooks, by category */
+void cloudseed_engine_memory_stats(const cloudseed_engine_t *engine, cloudseed_mem_stats_t *out);
+
+/* Totals over all live engines in the process; returns the live engine count */
+int cloudseed_engine_module_memory_stats(cloudseed_mem_stats_t *out);
+
+/*
+ * Module-wide memory budget in bytes; 0 (the default) is unlimited. Each
+ * build reserves its footprint and takes the largest tier, from the memory
+ * profile down, that fits what is left, dropping a tier on allocation
+ * failure as well; once the budget is exhausted engines are built at the
+ * minimal tier rather than failing. Knobs beyond a tier's ranges clamp to
+ * its maximum. Affects later creates and profile changes.
+ */
+void cloudseed_engine_set_memory_budget(size_t bytes);
+
+/* Returns the budget; *used (if not NULL) receives the bytes reserved by live engines */
+size_t cloudseed_engine_memory_budget(size_t *used);
+
+/* CLOUDSEED_MEM_TIER_* the engine's live buffers were built at */
+int cloudseed_engine_memory_tier(const cloudseed_engine_t *engine);
+
+/*
+ * Topology changes: the memory profile (the tier to build at,
+ * CLOUDSEED_MEM_TIER_STANDARD on create) and the delay line count (1 to
+ * CLOUDSEED_MAX_LINES, CLOUDSEED_DEFAULT_LINES on create; the minimal tier
+ * caps it at 4). The engine's worker thread allocates the new buffers and
+ * computes their coefficients; the audio thread swaps them in at a block
+ * boundary. Getters return what was asked for. Safe to call from the
+ * audio thread.
+ */
+void cloudseed_engine_set_memory_profile(cloudseed_engine_t *engine, int tier);
+int cloudseed_engine_get_memory_profile(const cloudseed_engine_t *engine);
+void cloudseed_engine_set_line_count(cloudseed_engine_t *engine, int count);
+int cloudseed_engine_get_line_count(const cloudseed_engine_t *engine);
+
+/* Delay lines per channel in the live buffers */
+int cloudseed_engine_active_lines(const cloudseed_engine_t *engine);
+
+/*
+ * Tail priming (on by default): a rebuild copies the live tail into the
+ * new buffers and the swap continues it seamlessly, truncated to the new
+ * ranges. Off, or when the copy falls too far behind, the swap drops the
+ * tail behind a short wet fade.
+ */
+void cloudseed_engine_set_tail_priming(cloudseed_engine_t *engine, int enabled);
+int cloudseed_engine_get_tail_priming(const cloudseed_engine_t *engine);
+void cloudseed_engine_memory_tier_info(int tier, cloudseed_mem_tier_t *out);
+
+/*
+ * DSP state snapshot: params, settings and the complete channel state,
+ * with each ring trimmed to the part later reads can still reach (quiet
+ * rings are dropped); the bytes are tied to the engine build that wrote
+ * them. Saving never blocks the audio thread: snapshot_begin (wait-free,
+ * any thread) has the worker build a copy of the channels, which the
+ * audio thread fills over the next blocks and completes at a block
+ * boundary. Once snapshot_ready returns 1, snapshot_size and
+ * save_snapshot serialize that copy from any one thread; snapshot_end
+ * frees it. begin returns -1 if a snapshot is already under way or there
+ * is no worker; ready returns -1 if the copy could not be built (call
+ * end), 0 while it is being filled. A copy still open is freed with the
+ * engine.
+ */
+int cloudseed_engine_snapshot_begin(cloudseed_engine_t *engine);
+int cloudseed_engine_snapshot_ready(const cloudseed_engine_t *engine);
+void cloudseed_engine_snapshot_end(cloudseed_engine_t *engine);
+size_t cloudseed_engine_snapshot_size(const cloudseed_engine_t *engine);
+
+/* Writes the ready snapshot; returns its size, or 0 if size is too small or none is ready */
+size_t cloudseed_engine_save_snapshot(const cloudseed_engine_t *engine, void *out, size_t size);
+
+/*
+ * Creates an engine that resumes a snapshot where it left off, tail
+ * included (truncated if the budget forces a smaller tier). data must be
+ * 8-byte aligned (malloc or mmap) and is only read during the call. Costs
+ * about as much as cloudseed_engine_create: the full tier is allocated
+ * and zeroed as usual, then the saved rings are copied in. Returns NULL if data is not a snapshot from this build, or on
+ * allocation failure.
+ */
+cloudseed_engine_t *cloudseed_engine_create_from_snapshot(const cloudseed_hooks_t *hooks,
+                                                          const void *data, size_t size);
+
+/* Short lowercase name for a category, e.g. "delay" */
+const char *cloudseed_mem_category_name(cloudseed_mem_category_t category);
+
+/*
+ * Copies up to max of the most recent trace records, oldest first, and
+ * returns the count. Lock-free against the audio thread: safe to call from
+ * any thread while process runs; records overwritten mid-copy are dropped.
+ */
+int cloudseed_engine_trace_snapshot(const cloudseed_engine_t *engine,
+                                    cloudseed_trace_record_t *out, int max);
+
+/* Records written so far; wait-free, so the audio thread can mark a dump point */
+uint32_t cloudseed_engine_trace_position(const cloudseed_engine_t *engine);
+
+/*
+ * trace_snapshot of the records before position end, as returned earlier
+ * by trace_position. Records the writer has overwritten since are dropped.
+ */
+int cloudseed_engine_trace_snapshot_until(const cloudseed_engine_t *engine, uint32_t end,
+                                          cloudseed_trace_record_t *out, int max);
+
+#endif /* CLOUDSEED_ENGINE_H */
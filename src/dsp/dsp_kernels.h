@@ -0,0 +1,113 @@
+/*
+ * CloudSeed hot DSP kernels
+ *
+ * Included by cloudseed_engine.c once per CPU variant (no include guard on
+ * purpose). Before each inclusion define:
+ *
+ *   KERNEL_SUFFIX   name suffix for this variant, e.g. generic, avx2
+ *   KERNEL_TARGET   function attribute selecting the ISA, or empty
+ *
+ * Every variant compiles the same C; the target attribute lets the
+ * compiler use the wider or newer instructions when the variant is
+ * picked at init time by dsp_kernels_select().
+ */
+
+#define KERNEL_CONCAT_(name, suffix) name##_##suffix
+#define KERNEL_CONCAT(name, suffix) KERNEL_CONCAT_(name, suffix)
+#define KERNEL_FN(name) KERNEL_CONCAT(name, KERNEL_SUFFIX)
+
+/* Interleaved int16 stereo to two float channels */
+KERNEL_TARGET
+static void KERNEL_FN(kernel_convert_in)(const int16_t *src, float *left, float *right, int frames) {
+    for (int i = 0; i < frames; i++) {
+        left[i] = src[i * 2] / 32768.0f;
+        right[i] = src[i * 2 + 1] / 32768.0f;
+    }
+}
+
+/* Wet-only output with hard clip to int16 */
+KERNEL_TARGET
+static void KERNEL_FN(kernel_output_wet)(int16_t *dst, const float *wet_l, const float *wet_r, int frames) {
+    for (int i = 0; i < frames; i++) {
+        float l = fminf(fmaxf(wet_l[i], -1.0f), 1.0f);
+        float r = fminf(fmaxf(wet_r[i], -1.0f), 1.0f);
+        dst[i * 2] = (int16_t)(l * 32767.0f);
+        dst[i * 2 + 1] = (int16_t)(r * 32767.0f);
+    }
+}
+
+/* Dry/wet blend with a per-sample mix ramp: mix = mix_start + mix_step * (i + 1) */
+KERNEL_TARGET
+static void KERNEL_FN(kernel_output_mix)(int16_t *dst, const float *dry_l, const float *dry_r,
+                                         const float *wet_l, const float *wet_r,
+                                         float mix_start, float mix_step, int frames) {
+    for (int i = 0; i < frames; i++) {
+        float mix = mix_start + mix_step * (float)(i + 1);
+        float l = dry_l[i] * (1.0f - mix) + wet_l[i] * mix;
+        float r = dry_r[i] * (1.0f - mix) + wet_r[i] * mix;
+        l = fminf(fmaxf(l, -1.0f), 1.0f);
+        r = fminf(fmaxf(r, -1.0f), 1.0f);
+        dst[i * 2] = (int16_t)(l * 32767.0f);
+        dst[i * 2 + 1] = (int16_t)(r * 32767.0f);
+    }
+}
+
+/* Modulated delay: write input, read with linear interpolation; returns new write index */
+KERNEL_TARGET
+static int KERNEL_FN(kernel_delay_process)(float *buf, int size, int write_index,
+                                           const float *delay, const float *input,
+                                           float *output, int count) {
+    for (int i = 0; i < count; i++) {
+        buf[write_index] = input[i];
+
+        int whole = (int)delay[i];
+        float frac = delay[i] - (float)whole;
+        int read_a = write_index - whole;
+        int read_b = read_a - 1;
+        if (read_a < 0) read_a += size;
+        if (read_b < 0) read_b += size;
+
+        output[i] = buf[read_a] * (1.0f - frac) + buf[read_b] * frac;
+
+        write_index++;
+        if (write_index >= size) write_index = 0;
+    }
+    return write_index;
+}
+
+/* Modulated allpass with interpolated read; returns new buffer index */
+KERNEL_TARGET
+static int KERNEL_FN(kernel_allpass_process)(float *buf, int size, int index, float feedback,
+                                             const float *delay, const float *input,
+                                             float *output, int count) {
+    for (int i = 0; i < count; i++) {
+        int whole = (int)delay[i];
+        float frac = delay[i] - (float)whole;
+        int idx_a = index - whole;
+        int idx_b = idx_a - 1;
+        if (idx_a < 0) idx_a += size;
+        if (idx_b < 0) idx_b += size;
+
+        float buf_out = buf[idx_a] * (1.0f - frac) + buf[idx_b] * frac;
+        float in_val = input[i] + buf_out * feedback;
+        buf[index] = in_val;
+        output[i] = buf_out - in_val * feedback;
+
+        index++;
+        if (index >= size) index = 0;
+    }
+    return index;
+}
+
+static const dsp_kernels_t KERNEL_CONCAT(dsp_kernels, KERNEL_SUFFIX) = {
+    KERNEL_NAME,
+    KERNEL_FN(kernel_convert_in),
+    KERNEL_FN(kernel_output_wet),
+    KERNEL_FN(kernel_output_mix),
+    KERNEL_FN(kernel_delay_process),
+    KERNEL_FN(kernel_allpass_process),
+};
+
+#undef KERNEL_FN
+#undef KERNEL_CONCAT
+#undef KERNEL_CONCAT_
@@ -0,0 +1,133 @@
+/*
+ * Fast approximate math for control-rate coefficient computation
+ *
+ * Branch-free polynomial approximations of exp2/log2/sin/cos/tan so that
+ * parameter changes and LFO updates do not go through libm. Worst-case
+ * errors over the ranges used by the reverb (measured against libm):
+ *
+ *   fast_exp2f   relative error < 2e-7   (x in [-126, 127])
+ *   fast_log2f   absolute error < 2e-7   (x in [0.25, 4]; float spacing beyond)
+ *   fast_sin2pi  absolute error < 3e-7   (any phase)
+ *   fast_tanf    relative error < 1e-5   (x in [0, 0.49 * pi])
+ *
+ * Derived helpers scale their argument into exp2 in float, so that
+ * rounding adds a relative error growing with the exponent:
+ *
+ *   fast_expf     relative error < 2e-6  (x in [-16, 16])
+ *   fast_exp10f   relative error < 1e-6  (x in [-1, 3])
+ *   fast_db2gain  relative error < 1e-6  (dB in [-120, 24])
+ *
+ * fast_powf has the exp2/log2 error scaled the same way. The bounds are
+ * checked by scripts/fast_math_check.c. Not meant for audio-rate signal
+ * paths that need bit-exact libm results.
+ */
+
+#ifndef CLOUDSEED_FAST_MATH_H
+#define CLOUDSEED_FAST_MATH_H
+
+#include <stdint.h>
+#include <math.h>
+
+#define FAST_LOG2_E   1.44269504088896341f
+#define FAST_LOG2_10  3.32192809488736235f
+#define FAST_LN_2     0.69314718055994531f
+#define FAST_INV_2PI  0.15915494309189534f
+
+typedef union {
+    float f;
+    int32_t i;
+} fast_float_bits_t;
+
+/* 2^x: round-to-nearest split, degree-7 polynomial on [-0.5, 0.5] */
+static inline float fast_exp2f(float x) {
+    x = fminf(fmaxf(x, -126.0f), 127.0f);
+
+    float xi = rintf(x);
+    float f = (x - xi) * FAST_LN_2;
+
+    float p = 1.0f / 5040.0f;
+    p = p * f + 1.0f / 720.0f;
+    p = p * f + 1.0f / 120.0f;
+    p = p * f + 1.0f / 24.0f;
+    p = p * f + 1.0f / 6.0f;
+    p = p * f + 0.5f;
+    p = p * f + 1.0f;
+    p = p * f + 1.0f;
+
+    fast_float_bits_t scale;
+    scale.i = ((int32_t)xi + 127) << 23;
+    return p * scale.f;
+}
+
+/* log2(x) for normal x > 0: mantissa in [sqrt(0.5), sqrt(2)), atanh series */
+static inline float fast_log2f(float x) {
+    fast_float_bits_t v;
+    v.f = x;
+
+    int32_t e = ((v.i >> 23) & 0xFF) - 127;
+    v.i = (v.i & 0x007FFFFF) | 0x3F800000;    /* mantissa in [1, 2) */
+
+    int32_t hi = v.f > 1.41421356f;
+    v.f *= hi ? 0.5f : 1.0f;
+    e += hi;
+
+    float s = (v.f - 1.0f) / (v.f + 1.0f);
+    float s2 = s * s;
+    float p = 1.0f / 9.0f;
+    p = p * s2 + 1.0f / 7.0f;
+    p = p * s2 + 1.0f / 5.0f;
+    p = p * s2 + 1.0f / 3.0f;
+    p = p * s2 + 1.0f;
+
+    return (float)e + 2.0f * FAST_LOG2_E * s * p;
+}
+
+/* sin(2 * pi * phase): folds to a quarter wave, degree-11 odd polynomial */
+static inline float fast_sin2pi(float phase) {
+    float t = phase - rintf(phase);           /* [-0.5, 0.5] */
+    float a = fabsf(t);
+    a = fminf(a, 0.5f - a);                   /* [0, 0.25] by symmetry */
+
+    float u = a * (2.0f * (float)M_PI);
+    float u2 = u * u;
+    float p = -1.0f / 39916800.0f;
+    p = p * u2 + 1.0f / 362880.0f;
+    p = p * u2 - 1.0f / 5040.0f;
+    p = p * u2 + 1.0f / 120.0f;
+    p = p * u2 - 1.0f / 6.0f;
+    p = p * u2 + 1.0f;
+
+    return copysignf(u * p, t);
+}
+
+static inline float fast_sinf(float x) {
+    return fast_sin2pi(x * FAST_INV_2PI);
+}
+
+static inline float fast_cosf(float x) {
+    return fast_sin2pi(x * FAST_INV_2PI + 0.25f);
+}
+
+/* tan(x) for x in [0, pi/2); only used for bilinear prewarping */
+static inline float fast_tanf(float x) {
+    float phase = x * FAST_INV_2PI;
+    return fast_sin2pi(phase) / fast_sin2pi(phase + 0.25f);
+}
+
+static inline float fast_expf(float x) {
+    return fast_exp2f(x * FAST_LOG2_E);
+}
+
+static inline float fast_exp10f(float x) {
+    return fast_exp2f(x * FAST_LOG2_10);
+}
+
+static inline float fast_powf(float base, float exponent) {
+    return fast_exp2f(exponent * fast_log2f(base));
+}
+
+static inline float fast_db2gain(float db) {
+    return fast_exp2f(db * (FAST_LOG2_10 / 20.0f));
+}
+
+#endif /* CLOUDSEED_FAST_MATH_H */